@@ -0,0 +1,15 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+DB_CONTAINER="edudesk-db"
+DB_USER="edudesk"
+DB_NAME="edudesk"
+
+# Сколько месяцев секций audit_log создавать заранее и сколько месяцев хранить
+MONTHS_AHEAD="${AUDIT_MONTHS_AHEAD:-3}"
+RETENTION_MONTHS="${AUDIT_RETENTION_MONTHS:-12}"
+# true — отсоединённые секции переносятся в схему audit_archive, false — удаляются
+ARCHIVE="${AUDIT_ARCHIVE:-true}"
+
+docker exec -i "$DB_CONTAINER" psql -U "$DB_USER" -d "$DB_NAME" -v ON_ERROR_STOP=1 \
+  -c "SELECT * FROM sp_audit_log_maintain(${MONTHS_AHEAD}, ${RETENTION_MONTHS}, ${ARCHIVE});"
@@ -0,0 +1,20 @@
+#!/usr/bin/env bash
+# Поднимает основной сервер и потоковую реплику (порт 15433).
+# Роль replicator создаётся только при инициализации тома — после обновления
+# с версии без реплики нужен scripts/db_reset.sh.
+set -euo pipefail
+
+docker compose --profile replica up -d db db-replica
+
+for i in {1..60}; do
+  if docker exec edudesk-db-replica pg_isready -U edudesk -d edudesk >/dev/null 2>&1; then
+    docker exec edudesk-db psql -U edudesk -d edudesk \
+      -c "SELECT client_addr, state, sync_state, replay_lag FROM pg_stat_replication;"
+    docker exec edudesk-db-replica psql -U edudesk -d edudesk -c "SELECT sp_replica_lag_ms();"
+    exit 0
+  fi
+  sleep 1
+done
+
+echo "Реплика не готова" >&2
+exit 1
@@ -0,0 +1,10 @@
+#!/usr/bin/env bash
+# Выполняется образом postgres при первой инициализации основного сервера:
+# роль и доступ для потоковой реплики (docker compose --profile replica).
+set -euo pipefail
+
+psql -v ON_ERROR_STOP=1 -U "$POSTGRES_USER" -d "$POSTGRES_DB" <<SQL
+CREATE ROLE replicator WITH REPLICATION LOGIN PASSWORD '${REPLICATOR_PASSWORD:-replicator_pass}';
+SQL
+
+echo "host replication replicator all scram-sha-256" >> "$PGDATA/pg_hba.conf"
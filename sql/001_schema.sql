@@ -31,10 +31,21 @@ CREATE TABLE public.assignments (
     discipline_id integer REFERENCES public.disciplines(id) ON DELETE SET NULL,
     created_by integer REFERENCES public.users(id) ON DELETE SET NULL,
     created_at timestamp without time zone DEFAULT CURRENT_TIMESTAMP,
-    due_date timestamp without time zone
+    due_date timestamp without time zone,
+    -- true: задание видно только студентам из assignment_students (поддерживается триггером)
+    restricted boolean NOT NULL DEFAULT false,
+    -- Полнотекстовый поиск (sp_search_*): заголовок весомее описания
+    search_tsv tsvector GENERATED ALWAYS AS (
+        setweight(to_tsvector('russian', coalesce(title, '')), 'A') ||
+        setweight(to_tsvector('russian', coalesce(description, '')), 'B')
+    ) STORED
 );
 
 CREATE INDEX idx_assignments_created_by ON public.assignments (created_by);
+-- Покрывающие индексы для списка заданий студента (index-only scan по каждой ветке)
+CREATE INDEX idx_assignments_open ON public.assignments (due_date, id) INCLUDE (title) WHERE NOT restricted;
+CREATE INDEX idx_assignments_restricted ON public.assignments (id) INCLUDE (title, due_date) WHERE restricted;
+CREATE INDEX idx_assignments_search ON public.assignments USING gin (search_tsv);
 
 CREATE TABLE public.submissions (
     id integer GENERATED BY DEFAULT AS IDENTITY PRIMARY KEY,
@@ -42,13 +53,29 @@ CREATE TABLE public.submissions (
     student_id integer REFERENCES public.users(id) ON DELETE SET NULL,
     file_path text NOT NULL,
     original_name text NOT NULL,
-    uploaded_at timestamp without time zone DEFAULT CURRENT_TIMESTAMP,
+    uploaded_at timestamp without time zone NOT NULL DEFAULT CURRENT_TIMESTAMP,
     grade text,
-    feedback text
+    feedback text,
+    feedback_tsv tsvector GENERATED ALWAYS AS (to_tsvector('russian', coalesce(feedback, ''))) STORED
 );
 
-CREATE INDEX idx_submissions_assignment ON public.submissions (assignment_id);
-CREATE INDEX idx_submissions_student ON public.submissions (student_id);
+-- Ключи сортировки списков отправлений: keyset-пагинация по (uploaded_at, id);
+-- uploaded_at NOT NULL, чтобы курсор был одним диапазоном индекса
+CREATE INDEX idx_submissions_assignment ON public.submissions (assignment_id, uploaded_at DESC, id DESC);
+CREATE INDEX idx_submissions_student ON public.submissions (student_id, uploaded_at DESC, id DESC);
+-- Пустые комментарии в индекс не попадают: поиск идёт только по оценённым работам
+CREATE INDEX idx_submissions_feedback_search ON public.submissions USING gin (feedback_tsv)
+    WHERE feedback IS NOT NULL;
+
+-- Счётчики отправлений по заданию для списка заданий преподавателя.
+-- Поддерживается триггером submissions_stats; пересчёт — sp_assignment_stats_rebuild.
+CREATE TABLE public.assignment_stats (
+    assignment_id integer PRIMARY KEY REFERENCES public.assignments(id) ON DELETE CASCADE,
+    submitted integer NOT NULL DEFAULT 0,
+    graded integer NOT NULL DEFAULT 0,
+    late integer NOT NULL DEFAULT 0,
+    last_upload_at timestamp without time zone
+);
 
 CREATE TABLE public.assignment_files (
     id integer GENERATED BY DEFAULT AS IDENTITY PRIMARY KEY,
@@ -60,16 +87,62 @@ CREATE TABLE public.assignment_files (
 
 CREATE INDEX idx_assignment_files_assignment ON public.assignment_files (assignment_id);
 
+-- Журнал аудита секционирован по месяцам. Секции создаёт заранее и удаляет
+-- (или переносит в audit_archive) процедура sp_audit_log_maintain.
 CREATE TABLE public.audit_log (
-    id integer GENERATED BY DEFAULT AS IDENTITY PRIMARY KEY,
+    id bigserial,
     user_id integer REFERENCES public.users(id) ON DELETE SET NULL,
     action text,
     details text,
-    ts timestamp without time zone DEFAULT CURRENT_TIMESTAMP
-);
+    ts timestamp without time zone NOT NULL DEFAULT CURRENT_TIMESTAMP,
+    PRIMARY KEY (id, ts)
+) PARTITION BY RANGE (ts);
+
+-- Страховочная секция для строк вне созданных месяцев; при обслуживании пустеет
+CREATE TABLE public.audit_log_default PARTITION OF public.audit_log DEFAULT;
+
+CREATE INDEX idx_audit_log_ts ON public.audit_log USING brin (ts);
+CREATE INDEX idx_audit_log_user_ts ON public.audit_log (user_id, ts);
+
+CREATE SCHEMA IF NOT EXISTS audit_archive;
 
 CREATE TABLE public.assignment_students (
     assignment_id integer NOT NULL REFERENCES public.assignments(id) ON DELETE CASCADE,
     student_id integer NOT NULL REFERENCES public.users(id) ON DELETE CASCADE,
     PRIMARY KEY (assignment_id, student_id)
 );
+
+CREATE INDEX idx_assignment_students_student ON public.assignment_students (student_id, assignment_id);
+
+-- Архив отправлений прошлых семестров (утилита archive_submissions). Строки переносятся
+-- из submissions целиком, зашифрованные файлы и metadata — в сегменты
+-- storage/archive/<segment>; segment_offset — смещение записи в сегменте.
+CREATE SCHEMA IF NOT EXISTS archive;
+
+CREATE TABLE archive.submissions (
+    id integer PRIMARY KEY,
+    assignment_id integer REFERENCES public.assignments(id) ON DELETE CASCADE,
+    student_id integer REFERENCES public.users(id) ON DELETE SET NULL,
+    file_path text NOT NULL,
+    original_name text NOT NULL,
+    uploaded_at timestamp without time zone NOT NULL,
+    grade text,
+    feedback text,
+    archived_at timestamp without time zone NOT NULL DEFAULT CURRENT_TIMESTAMP,
+    segment text NOT NULL,
+    segment_offset bigint NOT NULL
+);
+
+CREATE INDEX idx_archive_submissions_assignment ON archive.submissions (assignment_id, uploaded_at DESC, id DESC);
+CREATE INDEX idx_archive_submissions_student ON archive.submissions (student_id, uploaded_at DESC, id DESC);
+
+-- Горячие и архивные отправления для чтения списков. Ветки читаются по одинаковым
+-- индексам, keyset-страница собирается Merge Append без сортировки.
+CREATE VIEW public.submissions_all AS
+    SELECT s.id, s.assignment_id, s.student_id, s.file_path, s.original_name,
+           s.uploaded_at, s.grade, s.feedback, false AS archived
+    FROM public.submissions s
+    UNION ALL
+    SELECT s.id, s.assignment_id, s.student_id, s.file_path, s.original_name,
+           s.uploaded_at, s.grade, s.feedback, true AS archived
+    FROM archive.submissions s;
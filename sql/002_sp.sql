@@ -1,24 +1,55 @@
+-- Видимость: открытые задания (restricted = false) видны всем, остальные — только
+-- назначенным студентам. Обе ветки читаются по индексам, без обхода всех заданий.
 CREATE OR REPLACE FUNCTION sp_get_assignments_for_student(p_student_id integer)
 RETURNS TABLE(id integer, title text, due_date timestamp)
 LANGUAGE sql
+STABLE
+PARALLEL SAFE
 AS $$
-  SELECT a.id, a.title, a.due_date
-  FROM assignments a
-  WHERE
-    EXISTS (
-      SELECT 1
-      FROM assignment_students s
-      WHERE s.assignment_id = a.id
-        AND s.student_id = p_student_id
-    )
-    OR NOT EXISTS (
-      SELECT 1
-      FROM assignment_students s
-      WHERE s.assignment_id = a.id
-    )
-  ORDER BY a.due_date NULLS LAST, a.id;
+  SELECT v.id, v.title, v.due_date
+  FROM (
+    SELECT a.id, a.title, a.due_date
+    FROM assignments a
+    WHERE NOT a.restricted
+
+    UNION ALL
+
+    SELECT a.id, a.title, a.due_date
+    FROM assignment_students s
+    JOIN assignments a ON a.id = s.assignment_id AND a.restricted
+    WHERE s.student_id = p_student_id
+  ) v
+  ORDER BY v.due_date NULLS LAST, v.id;
 $$;
 
+-- Поддерживает assignments.restricted: задание становится адресным при первом
+-- назначении студента и снова открытым, когда удалён последний.
+CREATE OR REPLACE FUNCTION trg_assignment_students_audience()
+RETURNS trigger
+LANGUAGE plpgsql
+AS $$
+BEGIN
+  IF TG_OP = 'INSERT' THEN
+    UPDATE assignments
+    SET restricted = true
+    WHERE id = NEW.assignment_id AND NOT restricted;
+  ELSE
+    UPDATE assignments a
+    SET restricted = false
+    WHERE a.id = OLD.assignment_id
+      AND a.restricted
+      AND NOT EXISTS (
+        SELECT 1 FROM assignment_students s WHERE s.assignment_id = OLD.assignment_id
+      );
+  END IF;
+  RETURN NULL;
+END;
+$$;
+
+CREATE OR REPLACE TRIGGER assignment_students_audience
+AFTER INSERT OR DELETE ON assignment_students
+FOR EACH ROW EXECUTE FUNCTION trg_assignment_students_audience();
+
 CREATE OR REPLACE FUNCTION sp_get_my_submissions(p_student_id integer)
 RETURNS TABLE(
   id integer,
@@ -31,6 +62,8 @@ RETURNS TABLE(
   file_path text
 )
 LANGUAGE sql
+STABLE
+PARALLEL SAFE
 AS $$
   SELECT
     s.id,
@@ -41,12 +74,144 @@ AS $$
     s.grade,
     s.feedback,
     s.file_path
-  FROM submissions s
+  FROM submissions_all s
   JOIN assignments a ON a.id = s.assignment_id
   WHERE s.student_id = p_student_id
   ORDER BY s.uploaded_at DESC;
 $$;
 
+-- Keyset-страницы sp_get_my_submissions, порядок (uploaded_at DESC, id DESC).
+-- Первая страница и следующие — разные перегрузки: условие следующей страницы —
+-- одно сравнение строк (uploaded_at, id) < курсора без OR, и обобщённый план
+-- кэшированного подготовленного запроса ведёт его как Index Cond.
+-- Курсор — (uploaded_at, id) последней полученной строки, его передаёт клиент:
+-- удаление строки между страницами не обрывает выдачу. cursor_uploaded_at —
+-- uploaded_at текстом с микросекундами (QDateTime их теряет) для следующего вызова.
+CREATE OR REPLACE FUNCTION sp_get_my_submissions_page(
+  p_student_id integer,
+  p_limit integer
+)
+RETURNS TABLE(
+  id integer,
+  assignment_id integer,
+  assignment_title text,
+  original_name text,
+  uploaded_at timestamp,
+  grade text,
+  feedback text,
+  file_path text,
+  cursor_uploaded_at text
+)
+LANGUAGE sql
+STABLE
+PARALLEL SAFE
+AS $$
+  SELECT
+    s.id,
+    s.assignment_id,
+    a.title AS assignment_title,
+    s.original_name,
+    s.uploaded_at,
+    s.grade,
+    s.feedback,
+    s.file_path,
+    s.uploaded_at::text
+  FROM submissions_all s
+  JOIN assignments a ON a.id = s.assignment_id
+  WHERE s.student_id = p_student_id
+  ORDER BY s.uploaded_at DESC, s.id DESC
+  LIMIT p_limit;
+$$;
+
+CREATE OR REPLACE FUNCTION sp_get_my_submissions_page(
+  p_student_id integer,
+  p_after_uploaded_at timestamp,
+  p_after_id integer,
+  p_limit integer
+)
+RETURNS TABLE(
+  id integer,
+  assignment_id integer,
+  assignment_title text,
+  original_name text,
+  uploaded_at timestamp,
+  grade text,
+  feedback text,
+  file_path text,
+  cursor_uploaded_at text
+)
+LANGUAGE sql
+STABLE
+PARALLEL SAFE
+AS $$
+  SELECT
+    s.id,
+    s.assignment_id,
+    a.title AS assignment_title,
+    s.original_name,
+    s.uploaded_at,
+    s.grade,
+    s.feedback,
+    s.file_path,
+    s.uploaded_at::text
+  FROM submissions_all s
+  JOIN assignments a ON a.id = s.assignment_id
+  WHERE s.student_id = p_student_id
+    AND (s.uploaded_at, s.id) < (p_after_uploaded_at, p_after_id)
+  ORDER BY s.uploaded_at DESC, s.id DESC
+  LIMIT p_limit;
+$$;
+
+-- Одна строка sp_get_my_submissions (точечное обновление открытого окна)
+CREATE OR REPLACE FUNCTION sp_get_my_submission(p_student_id integer, p_submission_id integer)
+RETURNS TABLE(
+  id integer,
+  assignment_id integer,
+  assignment_title text,
+  original_name text,
+  uploaded_at timestamp,
+  grade text,
+  feedback text,
+  file_path text
+)
+LANGUAGE sql
+STABLE
+PARALLEL SAFE
+AS $$
+  SELECT
+    s.id,
+    s.assignment_id,
+    a.title AS assignment_title,
+    s.original_name,
+    s.uploaded_at,
+    s.grade,
+    s.feedback,
+    s.file_path
+  FROM submissions s
+  JOIN assignments a ON a.id = s.assignment_id
+  WHERE s.id = p_submission_id
+    AND s.student_id = p_student_id;
+$$;
+
+-- Одна строка sp_get_assignments_for_student, если задание видно студенту
+CREATE OR REPLACE FUNCTION sp_get_assignment_for_student(p_student_id integer, p_assignment_id integer)
+RETURNS TABLE(id integer, title text, due_date timestamp)
+LANGUAGE sql
+STABLE
+PARALLEL SAFE
+AS $$
+  SELECT a.id, a.title, a.due_date
+  FROM assignments a
+  WHERE a.id = p_assignment_id
+    AND (
+      NOT a.restricted
+      OR EXISTS (
+        SELECT 1 FROM assignment_students s
+        WHERE s.assignment_id = a.id AND s.student_id = p_student_id
+      )
+    );
+$$;
+
 CREATE OR REPLACE FUNCTION sp_delete_assignment(p_assignment_id integer, p_teacher_id integer)
 RETURNS void
 LANGUAGE plpgsql
@@ -98,6 +263,8 @@ $$;
 CREATE OR REPLACE FUNCTION sp_get_user_auth_data(p_login text)
 RETURNS TABLE(user_id integer, password_hash text, salt text, role text)
 LANGUAGE sql
+STABLE
+PARALLEL SAFE
 AS $$
   SELECT id, password_hash, salt, role
   FROM users
@@ -114,6 +281,25 @@ BEGIN
 END;
 $$;
 
+-- Пакетная запись аудита (фоновый писатель Logger): один INSERT на пакет.
+-- p_ts — время события на клиенте: пакет сбрасывается с задержкой, и
+-- CURRENT_TIMESTAMP дал бы всем строкам пакета одно сдвинутое время
+CREATE OR REPLACE FUNCTION sp_log_actions(p_user_ids integer[], p_actions text[], p_details text[], p_ts timestamp[])
+RETURNS integer
+LANGUAGE plpgsql
+AS $$
+DECLARE
+  v_count integer;
+BEGIN
+  INSERT INTO audit_log(user_id, action, details, ts)
+  SELECT t.user_id, t.action, t.details, t.ts
+  FROM unnest(p_user_ids, p_actions, p_details, p_ts) AS t(user_id, action, details, ts);
+
+  GET DIAGNOSTICS v_count = ROW_COUNT;
+  RETURN v_count;
+END;
+$$;
+
 CREATE OR REPLACE FUNCTION sp_create_submission(
   p_assignment_id integer,
   p_student_id integer,
@@ -131,14 +317,26 @@ $$;
 
 CREATE OR REPLACE FUNCTION sp_admin_list_users(p_admin_id integer)
 RETURNS TABLE(user_id integer, login text, full_name text, role text)
-LANGUAGE plpgsql
+LANGUAGE sql
+STABLE
+PARALLEL SAFE
 AS $$
-BEGIN
-  RETURN QUERY
-    SELECT u.id, u.login, COALESCE(u.full_name, ''), u.role
-    FROM users u
-    ORDER BY u.id;
-END;
+  SELECT u.id, u.login, COALESCE(u.full_name, ''), u.role
+  FROM users u
+  ORDER BY u.id;
+$$;
+
+CREATE OR REPLACE FUNCTION sp_admin_list_users_page(p_admin_id integer, p_after_id integer, p_limit integer)
+RETURNS TABLE(user_id integer, login text, full_name text, role text)
+LANGUAGE sql
+STABLE
+PARALLEL SAFE
+AS $$
+  SELECT u.id, u.login, COALESCE(u.full_name, ''), u.role
+  FROM users u
+  WHERE u.id > COALESCE(p_after_id, 0)
+  ORDER BY u.id
+  LIMIT p_limit;
 $$;
 
 CREATE OR REPLACE FUNCTION sp_admin_create_user(
@@ -166,60 +364,109 @@ BEGIN
 END;
 $$;
 
+-- Возвращает изменённую строку в формате sp_admin_list_users_page,
+-- чтобы клиент обновил только её
+DROP FUNCTION IF EXISTS sp_admin_toggle_user_active(integer, integer);
 CREATE OR REPLACE FUNCTION sp_admin_toggle_user_active(p_admin_id integer, p_user_id integer)
-RETURNS void
+RETURNS TABLE(user_id integer, login text, full_name text, role text)
 LANGUAGE plpgsql
 AS $$
 BEGIN
-  UPDATE users SET active = NOT active WHERE id = p_user_id;
-
   INSERT INTO audit_log(user_id, action, details, ts)
   VALUES (p_admin_id, 'toggle_active', concat('user_id=', p_user_id), now());
+
+  RETURN QUERY
+    UPDATE users u
+    SET active = NOT u.active
+    WHERE u.id = p_user_id
+    RETURNING u.id, u.login, COALESCE(u.full_name, ''), u.role;
 END;
 $$;
 
 CREATE OR REPLACE FUNCTION sp_admin_get_user(p_admin_id integer, p_user_id integer)
 RETURNS TABLE(login text, full_name text, role text)
-LANGUAGE plpgsql
+LANGUAGE sql
+STABLE
+PARALLEL SAFE
 AS $$
-BEGIN
-  RETURN QUERY
-    SELECT u.login, COALESCE(u.full_name, ''), u.role
-    FROM users u
-    WHERE u.id = p_user_id;
-END;
+  SELECT u.login, COALESCE(u.full_name, ''), u.role
+  FROM users u
+  WHERE u.id = p_user_id;
 $$;
 
+DROP FUNCTION IF EXISTS sp_admin_update_user(integer, integer, text, text);
 CREATE OR REPLACE FUNCTION sp_admin_update_user(
   p_admin_id integer,
   p_user_id integer,
   p_full_name text,
   p_role text
 )
-RETURNS void
+RETURNS TABLE(user_id integer, login text, full_name text, role text)
 LANGUAGE plpgsql
 AS $$
 BEGIN
-  UPDATE users
-  SET full_name = NULLIF(p_full_name, ''),
-      role = p_role
-  WHERE id = p_user_id;
-
   INSERT INTO audit_log(user_id, action, details, ts)
   VALUES (p_admin_id, 'edit_user', concat('user_id=', p_user_id), now());
+
+  RETURN QUERY
+    UPDATE users u
+    SET full_name = NULLIF(p_full_name, ''),
+        role = p_role
+    WHERE u.id = p_user_id
+    RETURNING u.id, u.login, COALESCE(u.full_name, ''), u.role;
 END;
 $$;
 
+-- Статистика берётся из assignment_stats (одно чтение по ключу на задание)
+DROP FUNCTION IF EXISTS sp_get_assignments_for_teacher(integer);
 CREATE OR REPLACE FUNCTION sp_get_assignments_for_teacher(p_teacher_id integer)
-RETURNS TABLE(id integer, title text)
+RETURNS TABLE(
+  id integer,
+  title text,
+  submitted integer,
+  graded integer,
+  late integer,
+  last_upload_at timestamp
+)
 LANGUAGE sql
+STABLE
+PARALLEL SAFE
 AS $$
-  SELECT a.id, a.title
+  SELECT a.id, a.title,
+         COALESCE(st.submitted, 0), COALESCE(st.graded, 0), COALESCE(st.late, 0),
+         st.last_upload_at
   FROM assignments a
+  LEFT JOIN assignment_stats st ON st.assignment_id = a.id
   WHERE a.created_by = p_teacher_id
   ORDER BY a.id DESC;
 $$;
 
+DROP FUNCTION IF EXISTS sp_get_assignment_for_teacher(integer, integer);
+CREATE OR REPLACE FUNCTION sp_get_assignment_for_teacher(p_teacher_id integer, p_assignment_id integer)
+RETURNS TABLE(
+  id integer,
+  title text,
+  submitted integer,
+  graded integer,
+  late integer,
+  last_upload_at timestamp
+)
+LANGUAGE sql
+STABLE
+PARALLEL SAFE
+AS $$
+  SELECT a.id, a.title,
+         COALESCE(st.submitted, 0), COALESCE(st.graded, 0), COALESCE(st.late, 0),
+         st.last_upload_at
+  FROM assignments a
+  LEFT JOIN assignment_stats st ON st.assignment_id = a.id
+  WHERE a.id = p_assignment_id
+    AND a.created_by = p_teacher_id;
+$$;
+
+-- Права — условием соединения: чужое задание даёт пустой результат. Функция на SQL
+-- без plpgsql встраивается в вызывающий запрос, и LIMIT или фильтр снаружи доходят
+-- до индекса idx_submissions_assignment.
 CREATE OR REPLACE FUNCTION sp_get_submissions_for_assignment(p_teacher_id integer, p_assignment_id integer)
 RETURNS TABLE(
   id integer,
@@ -230,39 +477,177 @@ RETURNS TABLE(
   feedback text,
   file_path text
 )
-LANGUAGE plpgsql
+LANGUAGE sql
+STABLE
+PARALLEL SAFE
 AS $$
-BEGIN
-  IF NOT EXISTS (
-    SELECT 1 FROM assignments
-    WHERE id = p_assignment_id AND created_by = p_teacher_id
-  ) THEN
-    RAISE EXCEPTION 'forbidden';
-  END IF;
+  SELECT
+    s.id,
+    COALESCE(u.login, ''),
+    s.original_name,
+    s.uploaded_at,
+    s.grade,
+    s.feedback,
+    s.file_path
+  FROM submissions_all s
+  JOIN assignments a ON a.id = s.assignment_id AND a.created_by = p_teacher_id
+  LEFT JOIN users u ON s.student_id = u.id
+  WHERE s.assignment_id = p_assignment_id
+  ORDER BY s.uploaded_at DESC, s.id DESC;
+$$;
 
-  RETURN QUERY
-    SELECT
-      s.id,
-      COALESCE(u.login, ''),
-      s.original_name,
-      s.uploaded_at,
-      s.grade,
-      s.feedback,
-      s.file_path
-    FROM submissions s
-    LEFT JOIN users u ON s.student_id = u.id
-    WHERE s.assignment_id = p_assignment_id
-    ORDER BY s.uploaded_at DESC, s.id DESC;
-END;
+-- Перегрузки, курсор и cursor_uploaded_at — как в sp_get_my_submissions_page
+CREATE OR REPLACE FUNCTION sp_get_submissions_for_assignment_page(
+  p_teacher_id integer,
+  p_assignment_id integer,
+  p_limit integer
+)
+RETURNS TABLE(
+  id integer,
+  student_login text,
+  original_name text,
+  uploaded_at timestamp,
+  grade text,
+  feedback text,
+  file_path text,
+  cursor_uploaded_at text
+)
+LANGUAGE sql
+STABLE
+PARALLEL SAFE
+AS $$
+  SELECT
+    s.id,
+    COALESCE(u.login, ''),
+    s.original_name,
+    s.uploaded_at,
+    s.grade,
+    s.feedback,
+    s.file_path,
+    s.uploaded_at::text
+  FROM submissions_all s
+  JOIN assignments a ON a.id = s.assignment_id AND a.created_by = p_teacher_id
+  LEFT JOIN users u ON s.student_id = u.id
+  WHERE s.assignment_id = p_assignment_id
+  ORDER BY s.uploaded_at DESC, s.id DESC
+  LIMIT p_limit;
+$$;
+
+CREATE OR REPLACE FUNCTION sp_get_submissions_for_assignment_page(
+  p_teacher_id integer,
+  p_assignment_id integer,
+  p_after_uploaded_at timestamp,
+  p_after_id integer,
+  p_limit integer
+)
+RETURNS TABLE(
+  id integer,
+  student_login text,
+  original_name text,
+  uploaded_at timestamp,
+  grade text,
+  feedback text,
+  file_path text,
+  cursor_uploaded_at text
+)
+LANGUAGE sql
+STABLE
+PARALLEL SAFE
+AS $$
+  SELECT
+    s.id,
+    COALESCE(u.login, ''),
+    s.original_name,
+    s.uploaded_at,
+    s.grade,
+    s.feedback,
+    s.file_path,
+    s.uploaded_at::text
+  FROM submissions_all s
+  JOIN assignments a ON a.id = s.assignment_id AND a.created_by = p_teacher_id
+  LEFT JOIN users u ON s.student_id = u.id
+  WHERE s.assignment_id = p_assignment_id
+    AND (s.uploaded_at, s.id) < (p_after_uploaded_at, p_after_id)
+  ORDER BY s.uploaded_at DESC, s.id DESC
+  LIMIT p_limit;
+$$;
+
+-- Одна строка sp_get_submissions_for_assignment_page; права — условием соединения
+CREATE OR REPLACE FUNCTION sp_get_submission_for_teacher(p_teacher_id integer, p_submission_id integer)
+RETURNS TABLE(
+  id integer,
+  student_login text,
+  original_name text,
+  uploaded_at timestamp,
+  grade text,
+  feedback text,
+  file_path text
+)
+LANGUAGE sql
+STABLE
+PARALLEL SAFE
+AS $$
+  SELECT
+    s.id,
+    COALESCE(u.login, ''),
+    s.original_name,
+    s.uploaded_at,
+    s.grade,
+    s.feedback,
+    s.file_path
+  FROM submissions s
+  JOIN assignments a ON a.id = s.assignment_id AND a.created_by = p_teacher_id
+  LEFT JOIN users u ON s.student_id = u.id
+  WHERE s.id = p_submission_id;
 $$;
 
+-- Несколько строк sp_get_submission_for_teacher одним вызовом: пачка NOTIFY
+-- (например, от пакетной оценки) перечитывается одним запросом
+CREATE OR REPLACE FUNCTION sp_get_submissions_for_teacher(p_teacher_id integer, p_submission_ids integer[])
+RETURNS TABLE(
+  id integer,
+  student_login text,
+  original_name text,
+  uploaded_at timestamp,
+  grade text,
+  feedback text,
+  file_path text
+)
+LANGUAGE sql
+STABLE
+PARALLEL SAFE
+AS $$
+  SELECT
+    s.id,
+    COALESCE(u.login, ''),
+    s.original_name,
+    s.uploaded_at,
+    s.grade,
+    s.feedback,
+    s.file_path
+  FROM submissions s
+  JOIN assignments a ON a.id = s.assignment_id AND a.created_by = p_teacher_id
+  LEFT JOIN users u ON s.student_id = u.id
+  WHERE s.id = ANY(p_submission_ids);
+$$;
+
+-- Возвращает обновлённую строку в формате sp_get_submission_for_teacher
+DROP FUNCTION IF EXISTS sp_set_submission_grade(integer, integer, text, text);
 CREATE OR REPLACE FUNCTION sp_set_submission_grade(
   p_teacher_id integer,
   p_submission_id integer,
   p_grade text,
   p_feedback text
 )
-RETURNS void
+RETURNS TABLE(
+  id integer,
+  student_login text,
+  original_name text,
+  uploaded_at timestamp,
+  grade text,
+  feedback text,
+  file_path text
+)
 LANGUAGE plpgsql
 AS $$
 DECLARE
@@ -277,19 +662,96 @@ BEGIN
   END IF;
 
   IF NOT EXISTS (
-    SELECT 1 FROM assignments
-    WHERE id = v_assignment_id AND created_by = p_teacher_id
+    SELECT 1 FROM assignments a
+    WHERE a.id = v_assignment_id AND a.created_by = p_teacher_id
   ) THEN
     RAISE EXCEPTION 'forbidden';
   END IF;
 
-  UPDATE submissions
-  SET grade = NULLIF(p_grade, ''),
-      feedback = NULLIF(p_feedback, '')
-  WHERE id = p_submission_id;
-
   INSERT INTO audit_log(user_id, action, details, ts)
   VALUES (p_teacher_id, 'grade_submission', concat('submission_id=', p_submission_id), now());
+
+  RETURN QUERY
+    WITH upd AS (
+      UPDATE submissions s
+      SET grade = NULLIF(p_grade, ''),
+          feedback = NULLIF(p_feedback, '')
+      WHERE s.id = p_submission_id
+      RETURNING s.id, s.student_id, s.original_name, s.uploaded_at, s.grade, s.feedback, s.file_path
+    )
+    SELECT upd.id, COALESCE(u.login, ''), upd.original_name, upd.uploaded_at,
+           upd.grade, upd.feedback, upd.file_path
+    FROM upd
+    LEFT JOIN users u ON u.id = upd.student_id;
+END;
+$$;
+
+-- Пакетная оценка: элементы массивов — тройки (отправление, оценка, комментарий).
+-- Одна проверка владельца на задание, один UPDATE и одна запись аудита.
+CREATE OR REPLACE FUNCTION sp_set_submission_grades(
+  p_teacher_id integer,
+  p_submission_ids integer[],
+  p_grades text[],
+  p_feedbacks text[]
+)
+RETURNS TABLE(
+  id integer,
+  student_login text,
+  original_name text,
+  uploaded_at timestamp,
+  grade text,
+  feedback text,
+  file_path text
+)
+LANGUAGE plpgsql
+AS $$
+DECLARE
+  v_count integer := COALESCE(cardinality(p_submission_ids), 0);
+  v_found integer;
+BEGIN
+  IF v_count = 0 THEN
+    RETURN;
+  END IF;
+
+  IF cardinality(p_grades) IS DISTINCT FROM v_count
+     OR cardinality(p_feedbacks) IS DISTINCT FROM v_count
+     OR (SELECT count(DISTINCT x) FROM unnest(p_submission_ids) x) <> v_count THEN
+    RAISE EXCEPTION 'invalid_argument';
+  END IF;
+
+  -- Блокируем строки до проверки, чтобы параллельная оценка не вклинилась между ними
+  PERFORM 1 FROM submissions s WHERE s.id = ANY(p_submission_ids) FOR UPDATE;
+  GET DIAGNOSTICS v_found = ROW_COUNT;
+  IF v_found <> v_count THEN
+    RAISE EXCEPTION 'not_found';
+  END IF;
+
+  IF EXISTS (
+    SELECT 1
+    FROM (SELECT DISTINCT s.assignment_id FROM submissions s WHERE s.id = ANY(p_submission_ids)) x
+    LEFT JOIN assignments a ON a.id = x.assignment_id AND a.created_by = p_teacher_id
+    WHERE a.id IS NULL
+  ) THEN
+    RAISE EXCEPTION 'forbidden';
+  END IF;
+
+  INSERT INTO audit_log(user_id, action, details, ts)
+  VALUES (p_teacher_id, 'grade_submissions',
+          concat('count=', v_count, ' submission_ids=', array_to_string(p_submission_ids, ',')), now());
+
+  RETURN QUERY
+    WITH upd AS (
+      UPDATE submissions s
+      SET grade = NULLIF(g.grade, ''),
+          feedback = NULLIF(g.feedback, '')
+      FROM unnest(p_submission_ids, p_grades, p_feedbacks) AS g(submission_id, grade, feedback)
+      WHERE s.id = g.submission_id
+      RETURNING s.id, s.student_id, s.original_name, s.uploaded_at, s.grade, s.feedback, s.file_path
+    )
+    SELECT upd.id, COALESCE(u.login, ''), upd.original_name, upd.uploaded_at,
+           upd.grade, upd.feedback, upd.file_path
+    FROM upd
+    LEFT JOIN users u ON u.id = upd.student_id;
 END;
 $$;
 
@@ -316,9 +778,59 @@ BEGIN
 END;
 $$;
 
+-- Создание задания вместе с адресатами и вложениями за один вызов (одна транзакция).
+-- Пустой p_student_ids — задание открыто всем. Возвращает id задания.
+CREATE OR REPLACE FUNCTION sp_create_assignment_full(
+  p_teacher_id integer,
+  p_title text,
+  p_description text,
+  p_due_date timestamp,
+  p_student_ids integer[],
+  p_file_paths text[],
+  p_original_names text[]
+)
+RETURNS integer
+LANGUAGE plpgsql
+AS $$
+DECLARE
+  v_id integer;
+  v_students integer;
+  v_files integer;
+BEGIN
+  IF COALESCE(cardinality(p_file_paths), 0) <> COALESCE(cardinality(p_original_names), 0) THEN
+    RAISE EXCEPTION 'invalid_argument';
+  END IF;
+
+  -- restricted выставляется сразу, чтобы триггер адресатов не обновлял строку повторно
+  INSERT INTO assignments (title, description, discipline_id, created_by, due_date, created_at, restricted)
+  VALUES (p_title, NULLIF(p_description, ''), NULL, p_teacher_id, p_due_date, NOW(),
+          EXISTS (SELECT 1 FROM unnest(p_student_ids) AS sid WHERE sid IS NOT NULL))
+  RETURNING id INTO v_id;
+
+  INSERT INTO assignment_students (assignment_id, student_id)
+  SELECT DISTINCT v_id, sid
+  FROM unnest(p_student_ids) AS sid
+  WHERE sid IS NOT NULL;
+  GET DIAGNOSTICS v_students = ROW_COUNT;
+
+  INSERT INTO assignment_files (assignment_id, file_path, original_name, uploaded_at)
+  SELECT v_id, f.file_path, f.original_name, NOW()
+  FROM unnest(p_file_paths, p_original_names) AS f(file_path, original_name);
+  GET DIAGNOSTICS v_files = ROW_COUNT;
+
+  INSERT INTO audit_log(user_id, action, details, ts)
+  VALUES (p_teacher_id, 'create_assignment',
+          concat('assignment_id=', v_id, ' students=', v_students, ' files=', v_files), now());
+
+  RETURN v_id;
+END;
+$$;
+
 CREATE OR REPLACE FUNCTION sp_list_students(p_teacher_id integer)
 RETURNS TABLE(id integer, login text, full_name text)
 LANGUAGE sql
+STABLE
+PARALLEL SAFE
 AS $$
   SELECT u.id, u.login, COALESCE(u.full_name, '')
   FROM users u
@@ -348,6 +860,36 @@ BEGIN
 END;
 $$;
 
+-- Назначение набора студентов за один вызов: одна проверка владельца и один INSERT
+CREATE OR REPLACE FUNCTION sp_assign_students_to_assignment(
+  p_teacher_id integer,
+  p_assignment_id integer,
+  p_student_ids integer[]
+)
+RETURNS integer
+LANGUAGE plpgsql
+AS $$
+DECLARE
+  v_count integer;
+BEGIN
+  IF NOT EXISTS (
+    SELECT 1 FROM assignments
+    WHERE id = p_assignment_id AND created_by = p_teacher_id
+  ) THEN
+    RAISE EXCEPTION 'forbidden';
+  END IF;
+
+  INSERT INTO assignment_students (assignment_id, student_id)
+  SELECT DISTINCT p_assignment_id, sid
+  FROM unnest(p_student_ids) AS sid
+  WHERE sid IS NOT NULL
+  ON CONFLICT DO NOTHING;
+
+  GET DIAGNOSTICS v_count = ROW_COUNT;
+  RETURN v_count;
+END;
+$$;
+
 CREATE OR REPLACE FUNCTION sp_add_assignment_file(
   p_teacher_id integer,
   p_assignment_id integer,
@@ -376,6 +918,8 @@ $$;
 CREATE OR REPLACE FUNCTION sp_get_assignment_details(p_assignment_id integer)
 RETURNS TABLE(title text, description text, due_date timestamp)
 LANGUAGE sql
+STABLE
+PARALLEL SAFE
 AS $$
   SELECT a.title, COALESCE(a.description, ''), a.due_date
   FROM assignments a
@@ -385,9 +929,475 @@ $$;
 CREATE OR REPLACE FUNCTION sp_get_assignment_files(p_assignment_id integer)
 RETURNS TABLE(id integer, original_name text, file_path text)
 LANGUAGE sql
+STABLE
+PARALLEL SAFE
 AS $$
   SELECT f.id, f.original_name, f.file_path
   FROM assignment_files f
   WHERE f.assignment_id = p_assignment_id
   ORDER BY f.uploaded_at DESC, f.id DESC;
 $$;
+
+-- Полнотекстовый поиск по заданиям и комментариям к работам. Запрос — в синтаксисе
+-- websearch_to_tsquery. score = ts_rank_cd * 10^6 целым числом, чтобы ключ keyset-пагинации
+-- (score DESC, kind, id) без потерь возвращался клиентом. Фрагменты ts_headline
+-- строятся только для строк страницы.
+CREATE OR REPLACE FUNCTION sp_search_for_teacher(
+  p_teacher_id integer,
+  p_query text,
+  p_after_score integer,
+  p_after_kind text,
+  p_after_id integer,
+  p_limit integer
+)
+RETURNS TABLE(kind text, id integer, assignment_id integer, title text, snippet text, score integer)
+LANGUAGE sql
+STABLE
+PARALLEL SAFE
+AS $$
+  WITH q AS (
+    SELECT websearch_to_tsquery('russian', p_query) AS tsq
+  ),
+  hits AS (
+    SELECT 'assignment'::text AS kind, a.id, a.id AS assignment_id,
+           (ts_rank_cd(a.search_tsv, q.tsq) * 1000000)::integer AS score
+    FROM assignments a, q
+    WHERE a.created_by = p_teacher_id AND a.search_tsv @@ q.tsq
+
+    UNION ALL
+
+    SELECT 'feedback'::text, s.id, s.assignment_id,
+           (ts_rank_cd(s.feedback_tsv, q.tsq) * 1000000)::integer
+    FROM submissions s
+    JOIN assignments a ON a.id = s.assignment_id, q
+    WHERE a.created_by = p_teacher_id
+      AND s.feedback IS NOT NULL
+      AND s.feedback_tsv @@ q.tsq
+  ),
+  page AS (
+    SELECT h.kind, h.id, h.assignment_id, h.score
+    FROM hits h
+    WHERE p_after_score IS NULL
+       OR h.score < p_after_score
+       OR (h.score = p_after_score AND (h.kind, h.id) > (p_after_kind, p_after_id))
+    ORDER BY h.score DESC, h.kind, h.id
+    LIMIT p_limit
+  )
+  SELECT p.kind, p.id, p.assignment_id,
+         CASE WHEN p.kind = 'assignment' THEN a.title
+              ELSE concat(a.title, ' — ', COALESCE(u.login, '')) END,
+         ts_headline('russian',
+                     CASE WHEN p.kind = 'assignment' THEN concat_ws(' ', a.title, a.description)
+                          ELSE s.feedback END,
+                     q.tsq, 'StartSel=«, StopSel=», MaxWords=20, MinWords=5, MaxFragments=2'),
+         p.score
+  FROM page p
+  CROSS JOIN q
+  JOIN assignments a ON a.id = p.assignment_id
+  LEFT JOIN submissions s ON p.kind = 'feedback' AND s.id = p.id
+  LEFT JOIN users u ON u.id = s.student_id
+  ORDER BY p.score DESC, p.kind, p.id;
+$$;
+
+-- Студенту видны задания по тем же правилам, что в sp_get_assignments_for_student,
+-- и комментарии только к своим работам
+CREATE OR REPLACE FUNCTION sp_search_for_student(
+  p_student_id integer,
+  p_query text,
+  p_after_score integer,
+  p_after_kind text,
+  p_after_id integer,
+  p_limit integer
+)
+RETURNS TABLE(kind text, id integer, assignment_id integer, title text, snippet text, score integer)
+LANGUAGE sql
+STABLE
+PARALLEL SAFE
+AS $$
+  WITH q AS (
+    SELECT websearch_to_tsquery('russian', p_query) AS tsq
+  ),
+  hits AS (
+    SELECT 'assignment'::text AS kind, a.id, a.id AS assignment_id,
+           (ts_rank_cd(a.search_tsv, q.tsq) * 1000000)::integer AS score
+    FROM assignments a, q
+    WHERE NOT a.restricted AND a.search_tsv @@ q.tsq
+
+    UNION ALL
+
+    SELECT 'assignment'::text, a.id, a.id,
+           (ts_rank_cd(a.search_tsv, q.tsq) * 1000000)::integer
+    FROM assignment_students st
+    JOIN assignments a ON a.id = st.assignment_id AND a.restricted, q
+    WHERE st.student_id = p_student_id AND a.search_tsv @@ q.tsq
+
+    UNION ALL
+
+    SELECT 'feedback'::text, s.id, s.assignment_id,
+           (ts_rank_cd(s.feedback_tsv, q.tsq) * 1000000)::integer
+    FROM submissions s, q
+    WHERE s.student_id = p_student_id
+      AND s.feedback IS NOT NULL
+      AND s.feedback_tsv @@ q.tsq
+  ),
+  page AS (
+    SELECT h.kind, h.id, h.assignment_id, h.score
+    FROM hits h
+    WHERE p_after_score IS NULL
+       OR h.score < p_after_score
+       OR (h.score = p_after_score AND (h.kind, h.id) > (p_after_kind, p_after_id))
+    ORDER BY h.score DESC, h.kind, h.id
+    LIMIT p_limit
+  )
+  SELECT p.kind, p.id, p.assignment_id,
+         CASE WHEN p.kind = 'assignment' THEN a.title
+              ELSE concat(a.title, ' — ', s.original_name) END,
+         ts_headline('russian',
+                     CASE WHEN p.kind = 'assignment' THEN concat_ws(' ', a.title, a.description)
+                          ELSE s.feedback END,
+                     q.tsq, 'StartSel=«, StopSel=», MaxWords=20, MinWords=5, MaxFragments=2'),
+         p.score
+  FROM page p
+  CROSS JOIN q
+  JOIN assignments a ON a.id = p.assignment_id
+  LEFT JOIN submissions s ON p.kind = 'feedback' AND s.id = p.id
+  ORDER BY p.score DESC, p.kind, p.id;
+$$;
+
+-- Ведомость преподавателя: столбцы — его задания в порядке sp_gradebook_assignments,
+-- строки — студенты, сдававшие работы или назначенные на задания. В ячейке — оценка
+-- последней сдачи (NULL, если не сдано или не оценено). Выгружается через COPY.
+CREATE OR REPLACE FUNCTION sp_gradebook_assignments(p_teacher_id integer)
+RETURNS TABLE(id integer, title text, due_date timestamp)
+LANGUAGE sql
+STABLE
+PARALLEL SAFE
+AS $$
+  SELECT a.id, a.title, a.due_date
+  FROM assignments a
+  WHERE a.created_by = p_teacher_id
+  ORDER BY a.due_date NULLS LAST, a.id;
+$$;
+
+CREATE OR REPLACE FUNCTION sp_gradebook(p_teacher_id integer)
+RETURNS TABLE(student_id integer, login text, full_name text, grades text[])
+LANGUAGE sql
+STABLE
+PARALLEL SAFE
+AS $$
+  WITH cols AS (
+    SELECT a.id, row_number() OVER (ORDER BY a.due_date NULLS LAST, a.id) AS pos
+    FROM assignments a
+    WHERE a.created_by = p_teacher_id
+  ),
+  latest AS (
+    SELECT DISTINCT ON (s.student_id, s.assignment_id) s.student_id, s.assignment_id, s.grade
+    FROM submissions_all s
+    JOIN cols c ON c.id = s.assignment_id
+    WHERE s.student_id IS NOT NULL
+    ORDER BY s.student_id, s.assignment_id, s.uploaded_at DESC, s.id DESC
+  ),
+  roster AS (
+    SELECT l.student_id FROM latest l
+    UNION
+    SELECT st.student_id FROM assignment_students st JOIN cols c ON c.id = st.assignment_id
+  )
+  SELECT u.id, u.login, COALESCE(u.full_name, ''),
+         array_agg(l.grade ORDER BY c.pos)
+  FROM roster r
+  JOIN users u ON u.id = r.student_id
+  CROSS JOIN cols c
+  LEFT JOIN latest l ON l.student_id = r.student_id AND l.assignment_id = c.id
+  GROUP BY u.id, u.login, u.full_name
+  ORDER BY u.login;
+$$;
+
+-- Уведомления об изменениях для открытых окон клиента (канал edudesk_changes).
+-- Полезная нагрузка — JSON с таблицей, операцией и ключами изменённой строки;
+-- pid — backend, сделавший изменение: клиент пропускает уведомления о своих записях.
+CREATE OR REPLACE FUNCTION trg_notify_change()
+RETURNS trigger
+LANGUAGE plpgsql
+AS $$
+DECLARE
+  v_row record;
+  v_payload jsonb;
+BEGIN
+  IF TG_OP = 'DELETE' THEN
+    -- Перенос в архив: строка остаётся видимой через submissions_all
+    IF TG_TABLE_NAME = 'submissions' AND current_setting('edudesk.archiving', true) = 'on' THEN
+      RETURN NULL;
+    END IF;
+    v_row := OLD;
+  ELSE
+    v_row := NEW;
+  END IF;
+
+  v_payload := jsonb_build_object('table', TG_TABLE_NAME, 'op', TG_OP, 'pid', pg_backend_pid());
+
+  IF TG_TABLE_NAME = 'submissions' THEN
+    v_payload := v_payload || jsonb_build_object(
+      'id', v_row.id, 'assignment_id', v_row.assignment_id, 'student_id', v_row.student_id);
+  ELSIF TG_TABLE_NAME = 'assignments' THEN
+    v_payload := v_payload || jsonb_build_object('id', v_row.id, 'created_by', v_row.created_by);
+  ELSE
+    v_payload := v_payload || jsonb_build_object(
+      'assignment_id', v_row.assignment_id, 'student_id', v_row.student_id);
+  END IF;
+
+  PERFORM pg_notify('edudesk_changes', v_payload::text);
+  RETURN NULL;
+END;
+$$;
+
+CREATE OR REPLACE TRIGGER submissions_notify
+AFTER INSERT OR UPDATE OR DELETE ON submissions
+FOR EACH ROW EXECUTE FUNCTION trg_notify_change();
+
+CREATE OR REPLACE TRIGGER assignments_notify
+AFTER INSERT OR UPDATE OR DELETE ON assignments
+FOR EACH ROW EXECUTE FUNCTION trg_notify_change();
+
+CREATE OR REPLACE TRIGGER assignment_students_notify
+AFTER INSERT OR DELETE ON assignment_students
+FOR EACH ROW EXECUTE FUNCTION trg_notify_change();
+
+-- Поддерживает assignment_stats. Вставка — upsert строки задания; удаление и
+-- снятие оценки только уменьшают счётчики (при каскадном удалении задания строка
+-- статистики уже удалена, и вставлять её заново нельзя).
+-- Перенос в архив (edudesk.archiving = on) счётчики не меняет: архивные
+-- отправления по-прежнему входят в статистику задания.
+CREATE OR REPLACE FUNCTION trg_submissions_stats()
+RETURNS trigger
+LANGUAGE plpgsql
+AS $$
+BEGIN
+  IF TG_OP = 'INSERT' THEN
+    INSERT INTO assignment_stats AS st (assignment_id, submitted, graded, late, last_upload_at)
+    SELECT NEW.assignment_id,
+           1,
+           (NEW.grade IS NOT NULL)::integer,
+           COALESCE(NEW.uploaded_at > a.due_date, false)::integer,
+           NEW.uploaded_at
+    FROM assignments a
+    WHERE a.id = NEW.assignment_id
+    ON CONFLICT (assignment_id) DO UPDATE
+    SET submitted = st.submitted + 1,
+        graded = st.graded + EXCLUDED.graded,
+        late = st.late + EXCLUDED.late,
+        last_upload_at = GREATEST(st.last_upload_at, EXCLUDED.last_upload_at);
+
+  ELSIF TG_OP = 'UPDATE' THEN
+    IF (OLD.grade IS NULL) <> (NEW.grade IS NULL) THEN
+      UPDATE assignment_stats st
+      SET graded = st.graded + CASE WHEN NEW.grade IS NULL THEN -1 ELSE 1 END
+      WHERE st.assignment_id = NEW.assignment_id;
+    END IF;
+
+  ELSIF current_setting('edudesk.archiving', true) IS DISTINCT FROM 'on' THEN
+    UPDATE assignment_stats st
+    SET submitted = st.submitted - 1,
+        graded = st.graded - (OLD.grade IS NOT NULL)::integer,
+        late = st.late - COALESCE(OLD.uploaded_at > a.due_date, false)::integer,
+        last_upload_at = (
+          SELECT max(s.uploaded_at) FROM submissions_all s WHERE s.assignment_id = OLD.assignment_id
+        )
+    FROM assignments a
+    WHERE st.assignment_id = OLD.assignment_id
+      AND a.id = OLD.assignment_id;
+  END IF;
+  RETURN NULL;
+END;
+$$;
+
+CREATE OR REPLACE TRIGGER submissions_stats
+AFTER INSERT OR DELETE OR UPDATE OF grade ON submissions
+FOR EACH ROW EXECUTE FUNCTION trg_submissions_stats();
+
+-- Полный пересчёт assignment_stats (развёртывание на существующих данных, сверка)
+CREATE OR REPLACE FUNCTION sp_assignment_stats_rebuild()
+RETURNS integer
+LANGUAGE plpgsql
+AS $$
+DECLARE
+  v_count integer;
+BEGIN
+  LOCK TABLE assignment_stats IN EXCLUSIVE MODE;
+  DELETE FROM assignment_stats;
+
+  INSERT INTO assignment_stats (assignment_id, submitted, graded, late, last_upload_at)
+  SELECT s.assignment_id,
+         count(*),
+         count(s.grade),
+         count(*) FILTER (WHERE s.uploaded_at > a.due_date),
+         max(s.uploaded_at)
+  FROM submissions_all s
+  JOIN assignments a ON a.id = s.assignment_id
+  GROUP BY s.assignment_id;
+
+  GET DIAGNOSTICS v_count = ROW_COUNT;
+  RETURN v_count;
+END;
+$$;
+
+-- Кандидаты на перенос в архив: отправления, загруженные до p_before, по id
+CREATE OR REPLACE FUNCTION sp_archive_candidates(p_before timestamp, p_after_id integer, p_limit integer)
+RETURNS TABLE(id integer, file_path text)
+LANGUAGE sql
+STABLE
+PARALLEL SAFE
+AS $$
+  SELECT s.id, s.file_path
+  FROM submissions s
+  WHERE s.uploaded_at < p_before
+    AND s.id > COALESCE(p_after_id, 0)
+  ORDER BY s.id
+  LIMIT p_limit;
+$$;
+
+-- Переносит строки в archive.submissions после того, как их файлы записаны в сегмент
+-- p_segment по смещениям p_offsets. Возвращает id перенесённых (удалённые тем временем
+-- пропускаются). Триггеры статистики и NOTIFY перенос пропускают.
+CREATE OR REPLACE FUNCTION sp_archive_submissions(p_ids integer[], p_segment text, p_offsets bigint[])
+RETURNS integer[]
+LANGUAGE plpgsql
+AS $$
+DECLARE
+  v_moved integer[];
+BEGIN
+  IF cardinality(p_ids) IS DISTINCT FROM cardinality(p_offsets) THEN
+    RAISE EXCEPTION 'invalid_argument';
+  END IF;
+
+  PERFORM set_config('edudesk.archiving', 'on', true);
+
+  WITH moved AS (
+    DELETE FROM submissions s
+    USING unnest(p_ids, p_offsets) AS m(submission_id, segment_offset)
+    WHERE s.id = m.submission_id
+    RETURNING s.id, s.assignment_id, s.student_id, s.file_path, s.original_name,
+              s.uploaded_at, s.grade, s.feedback, m.segment_offset
+  ), ins AS (
+    INSERT INTO archive.submissions (id, assignment_id, student_id, file_path, original_name,
+                                     uploaded_at, grade, feedback, segment, segment_offset)
+    SELECT moved.id, moved.assignment_id, moved.student_id, moved.file_path, moved.original_name,
+           moved.uploaded_at, moved.grade, moved.feedback, p_segment, moved.segment_offset
+    FROM moved
+    RETURNING archive.submissions.id
+  )
+  SELECT COALESCE(array_agg(ins.id), '{}') INTO v_moved FROM ins;
+
+  PERFORM set_config('edudesk.archiving', '', true);
+
+  INSERT INTO audit_log(user_id, action, details, ts)
+  VALUES (NULL, 'archive_submissions', concat('count=', cardinality(v_moved), ' segment=', p_segment), now());
+
+  RETURN v_moved;
+END;
+$$;
+
+-- Место архивного файла для скачивания: студенту — свои работы, преподавателю —
+-- работы по своим заданиям. Пусто, если отправление не в архиве или недоступно.
+CREATE OR REPLACE FUNCTION sp_get_archived_submission(p_user_id integer, p_submission_id integer)
+RETURNS TABLE(segment text, segment_offset bigint)
+LANGUAGE sql
+STABLE
+PARALLEL SAFE
+AS $$
+  SELECT s.segment, s.segment_offset
+  FROM archive.submissions s
+  JOIN assignments a ON a.id = s.assignment_id
+  WHERE s.id = p_submission_id
+    AND (s.student_id = p_user_id OR a.created_by = p_user_id);
+$$;
+
+-- Отставание реплики в мс (0 на основном сервере и на догнавшей реплике).
+-- Простаивающая реплика без входящего WAL считается актуальной, поэтому
+-- сравниваются позиции receive/replay, а не только время последней транзакции.
+-- VOLATILE: позиции WAL меняются и в пределах одного запроса.
+CREATE OR REPLACE FUNCTION sp_replica_lag_ms()
+RETURNS integer
+LANGUAGE sql
+VOLATILE
+AS $$
+  SELECT CASE
+    WHEN NOT pg_is_in_recovery() THEN 0
+    WHEN pg_last_wal_receive_lsn() = pg_last_wal_replay_lsn() THEN 0
+    ELSE COALESCE((EXTRACT(EPOCH FROM now() - pg_last_xact_replay_timestamp()) * 1000)::integer, 0)
+  END;
+$$;
+
+-- Обслуживание секций audit_log:
+--   * создаёт месячные секции на p_months_ahead месяцев вперёд (строки, успевшие
+--     попасть в audit_log_default, переносятся в новую секцию);
+--   * если задан p_retention_months, отсоединяет секции старше срока и либо
+--     переносит их в схему audit_archive, либо удаляет (p_archive = false).
+CREATE OR REPLACE FUNCTION sp_audit_log_maintain(
+  p_months_ahead integer DEFAULT 3,
+  p_retention_months integer DEFAULT NULL,
+  p_archive boolean DEFAULT true
+)
+RETURNS TABLE(action text, partition_name text)
+LANGUAGE plpgsql
+AS $$
+DECLARE
+  v_month date;
+  v_next date;
+  v_name text;
+  v_cutoff date;
+  r record;
+BEGIN
+  FOR i IN 0..GREATEST(p_months_ahead, 0) LOOP
+    v_month := (date_trunc('month', CURRENT_DATE) + make_interval(months => i))::date;
+    v_next := (v_month + interval '1 month')::date;
+    v_name := 'audit_log_' || to_char(v_month, 'YYYYMM');
+
+    CONTINUE WHEN to_regclass('public.' || v_name) IS NOT NULL;
+
+    EXECUTE format(
+      'CREATE TABLE public.%I (LIKE public.audit_log INCLUDING DEFAULTS INCLUDING CONSTRAINTS)', v_name);
+    EXECUTE format(
+      'WITH moved AS (DELETE FROM public.audit_log_default WHERE ts >= %L AND ts < %L RETURNING *) '
+      'INSERT INTO public.%I SELECT * FROM moved', v_month, v_next, v_name);
+    EXECUTE format(
+      'ALTER TABLE public.audit_log ATTACH PARTITION public.%I FOR VALUES FROM (%L) TO (%L)',
+      v_name, v_month, v_next);
+
+    action := 'created';
+    partition_name := v_name;
+    RETURN NEXT;
+  END LOOP;
+
+  IF p_retention_months IS NULL THEN
+    RETURN;
+  END IF;
+
+  v_cutoff := (date_trunc('month', CURRENT_DATE) - make_interval(months => p_retention_months))::date;
+
+  FOR r IN
+    SELECT c.relname
+    FROM pg_inherits inh
+    JOIN pg_class c ON c.oid = inh.inhrelid
+    WHERE inh.inhparent = 'public.audit_log'::regclass
+      AND c.relname ~ '^audit_log_[0-9]{6}$'
+      AND to_date(substr(c.relname, 11), 'YYYYMM') < v_cutoff
+    ORDER BY c.relname
+  LOOP
+    EXECUTE format('ALTER TABLE public.audit_log DETACH PARTITION public.%I', r.relname);
+    IF p_archive THEN
+      EXECUTE format('ALTER TABLE public.%I SET SCHEMA audit_archive', r.relname);
+      action := 'archived';
+    ELSE
+      EXECUTE format('DROP TABLE public.%I', r.relname);
+      action := 'dropped';
+    END IF;
+    partition_name := r.relname;
+    RETURN NEXT;
+  END LOOP;
+END;
+$$;
+
+-- Секции на текущий и ближайшие месяцы при развёртывании схемы
+SELECT * FROM sp_audit_log_maintain(3);
+
+SELECT sp_assignment_stats_rebuild();
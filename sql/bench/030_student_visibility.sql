@@ -0,0 +1,77 @@
+-- Бенчмарк видимости заданий студента (sp_get_assignments_for_student).
+--
+-- Запускать ТОЛЬКО на отдельной пустой базе со схемой 001/002, например:
+--   docker exec edudesk-db createdb -U edudesk edudesk_bench
+--   docker exec -i edudesk-db psql -U edudesk -d edudesk_bench < sql/001_schema.sql
+--   docker exec -i edudesk-db psql -U edudesk -d edudesk_bench < sql/002_sp.sql
+--   docker exec -i edudesk-db psql -U edudesk -d edudesk_bench < sql/bench/030_student_visibility.sql
+--
+-- Данные: 50k студентов, 100 преподавателей, 100k заданий, из них 5% открытых,
+-- остальные назначены 20 студентам каждое (~1.9M строк assignment_students).
+-- Ожидаемый план: Index Only Scan по idx_assignments_open и
+-- idx_assignment_students_student + Index Only Scan по idx_assignments_restricted.
+
+\set ON_ERROR_STOP on
+\timing on
+
+BEGIN;
+
+INSERT INTO users (login, role, password_hash, salt)
+SELECT 'bench_teacher_' || g, 'teacher', 'x', 'x'
+FROM generate_series(1, 100) g;
+
+INSERT INTO users (login, role, password_hash, salt)
+SELECT 'bench_student_' || g, 'student', 'x', 'x'
+FROM generate_series(1, 50000) g;
+
+CREATE TEMP TABLE bench_students AS
+SELECT row_number() OVER (ORDER BY id) AS n, id
+FROM users WHERE role = 'student' AND login LIKE 'bench_student_%';
+
+INSERT INTO assignments (title, description, created_by, due_date)
+SELECT 'Задание ' || g, NULL,
+       (SELECT min(id) FROM users WHERE login LIKE 'bench_teacher_%') + (g % 100),
+       now() + (g % 365) * interval '1 day'
+FROM generate_series(1, 100000) g;
+
+-- Триггер выставит restricted = true для каждого назначенного задания
+INSERT INTO assignment_students (assignment_id, student_id)
+SELECT a.id, bs.id
+FROM assignments a
+CROSS JOIN generate_series(0, 19) k
+JOIN bench_students bs ON bs.n = 1 + ((a.id * 7919 + k * 2503) % 50000)
+WHERE a.id % 20 <> 0
+ON CONFLICT DO NOTHING;
+
+COMMIT;
+
+VACUUM ANALYZE users;
+VACUUM ANALYZE assignments;
+VACUUM ANALYZE assignment_students;
+
+SELECT count(*) FILTER (WHERE NOT restricted) AS open_assignments,
+       count(*) FILTER (WHERE restricted) AS restricted_assignments
+FROM assignments;
+
+SELECT id AS bench_student_id
+FROM users WHERE login = 'bench_student_12345' \gset
+
+-- Тело процедуры (функция на SQL инлайнится не всегда, план смотрим напрямую)
+EXPLAIN (ANALYZE, BUFFERS, COSTS OFF)
+SELECT v.id, v.title, v.due_date
+FROM (
+  SELECT a.id, a.title, a.due_date
+  FROM assignments a
+  WHERE NOT a.restricted
+  UNION ALL
+  SELECT a.id, a.title, a.due_date
+  FROM assignment_students s
+  JOIN assignments a ON a.id = s.assignment_id AND a.restricted
+  WHERE s.student_id = :bench_student_id
+) v
+ORDER BY v.due_date NULLS LAST, v.id;
+
+-- Сквозное время вызова процедуры
+SELECT count(*) FROM sp_get_assignments_for_student(:bench_student_id);
+SELECT count(*) FROM sp_get_assignments_for_student(:bench_student_id);
+SELECT count(*) FROM sp_get_assignments_for_student(:bench_student_id);
@@ -0,0 +1,134 @@
+-- Бенчмарк встраивания процедур чтения: прежние версии на plpgsql (RETURN QUERY,
+-- VOLATILE по умолчанию) против LANGUAGE sql STABLE из 002_sp.sql.
+--
+-- Запускать ТОЛЬКО на отдельной пустой базе со схемой 001/002, например:
+--   docker exec edudesk-db createdb -U edudesk edudesk_bench
+--   docker exec -i edudesk-db psql -U edudesk -d edudesk_bench < sql/001_schema.sql
+--   docker exec -i edudesk-db psql -U edudesk -d edudesk_bench < sql/002_sp.sql
+--   docker exec -i edudesk-db psql -U edudesk -d edudesk_bench < sql/bench/031_sql_functions.sql
+--
+-- Данные: 20k студентов, 100 преподавателей, 2000 заданий по 100 отправлений и одно
+-- «большое» задание с 50k отправлений.
+-- Ожидаемый результат: plpgsql-версия — Function Scan, весь результат собирается
+-- в tuplestore до LIMIT и фильтра; SQL-версия встраивается, и план читает
+-- idx_submissions_assignment / users_pkey ровно на нужные строки.
+-- Сквозную задержку под нагрузкой сравнивает bench_db --read-only до и после 002.
+
+\set ON_ERROR_STOP on
+\timing on
+
+BEGIN;
+
+INSERT INTO users (login, role, password_hash, salt)
+SELECT 'bench_teacher_' || g, 'teacher', 'x', 'x'
+FROM generate_series(1, 100) g;
+
+INSERT INTO users (login, role, password_hash, salt)
+SELECT 'bench_student_' || g, 'student', 'x', 'x'
+FROM generate_series(1, 20000) g;
+
+CREATE TEMP TABLE bench_students AS
+SELECT row_number() OVER (ORDER BY id) AS n, id
+FROM users WHERE role = 'student' AND login LIKE 'bench_student_%';
+
+INSERT INTO assignments (title, description, created_by, due_date)
+SELECT 'Задание ' || g, NULL,
+       (SELECT min(id) FROM users WHERE login LIKE 'bench_teacher_%') + (g % 100),
+       now() + (g % 365) * interval '1 day'
+FROM generate_series(1, 2001) g;
+
+INSERT INTO submissions (assignment_id, student_id, file_path, original_name, uploaded_at)
+SELECT a.id, bs.id, 'bench.bin', 'bench.pdf', now() - (k % 1000) * interval '1 hour'
+FROM assignments a
+CROSS JOIN generate_series(0, 99) k
+JOIN bench_students bs ON bs.n = 1 + ((a.id * 7919 + k * 2503) % 20000);
+
+INSERT INTO submissions (assignment_id, student_id, file_path, original_name, uploaded_at)
+SELECT (SELECT max(id) FROM assignments), bs.id, 'bench.bin', 'bench.pdf',
+       now() - (k % 5000) * interval '1 minute'
+FROM generate_series(0, 49999) k
+JOIN bench_students bs ON bs.n = 1 + ((k * 7919) % 20000);
+
+COMMIT;
+
+VACUUM ANALYZE users;
+VACUUM ANALYZE assignments;
+VACUUM ANALYZE submissions;
+
+SELECT a.id AS bench_assignment_id, a.created_by AS bench_teacher_id
+FROM assignments a ORDER BY a.id DESC LIMIT 1 \gset
+
+SELECT id AS bench_user_id
+FROM users WHERE login = 'bench_student_12345' \gset
+
+-- Прежние версии (только на время сеанса)
+CREATE FUNCTION pg_temp.legacy_submissions_for_assignment(p_teacher_id integer, p_assignment_id integer)
+RETURNS TABLE(
+  id integer,
+  student_login text,
+  original_name text,
+  uploaded_at timestamp,
+  grade text,
+  feedback text,
+  file_path text
+)
+LANGUAGE plpgsql
+AS $$
+BEGIN
+  IF NOT EXISTS (
+    SELECT 1 FROM assignments
+    WHERE assignments.id = p_assignment_id AND created_by = p_teacher_id
+  ) THEN
+    RAISE EXCEPTION 'forbidden';
+  END IF;
+
+  RETURN QUERY
+    SELECT
+      s.id,
+      COALESCE(u.login, ''),
+      s.original_name,
+      s.uploaded_at,
+      s.grade,
+      s.feedback,
+      s.file_path
+    FROM submissions_all s
+    LEFT JOIN users u ON s.student_id = u.id
+    WHERE s.assignment_id = p_assignment_id
+    ORDER BY s.uploaded_at DESC, s.id DESC;
+END;
+$$;
+
+CREATE FUNCTION pg_temp.legacy_admin_list_users(p_admin_id integer)
+RETURNS TABLE(user_id integer, login text, full_name text, role text)
+LANGUAGE plpgsql
+AS $$
+BEGIN
+  RETURN QUERY
+    SELECT u.id, u.login, COALESCE(u.full_name, ''), u.role
+    FROM users u
+    ORDER BY u.id;
+END;
+$$;
+
+-- Первая экранная страница поверх полного списка отправлений
+EXPLAIN (ANALYZE, BUFFERS, COSTS OFF)
+SELECT * FROM pg_temp.legacy_submissions_for_assignment(:bench_teacher_id, :bench_assignment_id) LIMIT 50;
+
+EXPLAIN (ANALYZE, BUFFERS, COSTS OFF)
+SELECT * FROM sp_get_submissions_for_assignment(:bench_teacher_id, :bench_assignment_id) LIMIT 50;
+
+-- Внешний фильтр по ключу
+EXPLAIN (ANALYZE, BUFFERS, COSTS OFF)
+SELECT * FROM pg_temp.legacy_admin_list_users(0) WHERE user_id = :bench_user_id;
+
+EXPLAIN (ANALYZE, BUFFERS, COSTS OFF)
+SELECT * FROM sp_admin_list_users(0) WHERE user_id = :bench_user_id;
+
+-- Сквозное время полного вызова
+SELECT count(*) FROM pg_temp.legacy_submissions_for_assignment(:bench_teacher_id, :bench_assignment_id);
+SELECT count(*) FROM pg_temp.legacy_submissions_for_assignment(:bench_teacher_id, :bench_assignment_id);
+SELECT count(*) FROM pg_temp.legacy_submissions_for_assignment(:bench_teacher_id, :bench_assignment_id);
+
+SELECT count(*) FROM sp_get_submissions_for_assignment(:bench_teacher_id, :bench_assignment_id);
+SELECT count(*) FROM sp_get_submissions_for_assignment(:bench_teacher_id, :bench_assignment_id);
+SELECT count(*) FROM sp_get_submissions_for_assignment(:bench_teacher_id, :bench_assignment_id);
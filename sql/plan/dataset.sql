@@ -0,0 +1,69 @@
+-- Синтетический набор данных для проверки планов (src/tools/plan_check.cpp).
+-- Загружается инструментом в пустую базу со схемой 001/002; данные детерминированы,
+-- чтобы пороги буферов в checks.json были воспроизводимы.
+--
+-- 1 админ, 200 преподавателей, 20k студентов, 5k заданий (каждое пятое открытое,
+-- остальные назначены 25 студентам), 200k отправлений, 100k записей аудита.
+
+INSERT INTO users (login, role, full_name, password_hash, salt)
+VALUES ('plan_admin', 'admin', 'Plan Admin', 'x', 'x');
+
+INSERT INTO users (login, role, full_name, password_hash, salt)
+SELECT 'plan_teacher_' || g, 'teacher', 'Преподаватель ' || g, 'x', 'x'
+FROM generate_series(1, 200) g;
+
+INSERT INTO users (login, role, full_name, password_hash, salt)
+SELECT 'plan_student_' || g, 'student', 'Студент ' || g, 'x', 'x'
+FROM generate_series(1, 20000) g;
+
+CREATE TEMP TABLE plan_teachers AS
+SELECT row_number() OVER (ORDER BY id) AS n, id
+FROM users WHERE login LIKE 'plan_teacher_%';
+
+CREATE TEMP TABLE plan_students AS
+SELECT row_number() OVER (ORDER BY id) AS n, id
+FROM users WHERE login LIKE 'plan_student_%';
+
+INSERT INTO assignments (title, description, created_by, created_at, due_date)
+SELECT 'Задание ' || g, 'Описание задания ' || g, t.id,
+       timestamp '2026-01-01' + (g % 300) * interval '1 day',
+       timestamp '2026-01-15' + (g % 300) * interval '1 day'
+FROM generate_series(1, 5000) g
+JOIN plan_teachers t ON t.n = 1 + (g % 200);
+
+CREATE TEMP TABLE plan_assignments AS
+SELECT row_number() OVER (ORDER BY id) AS n, id, due_date
+FROM assignments WHERE title LIKE 'Задание %';
+
+INSERT INTO assignment_students (assignment_id, student_id)
+SELECT a.id, s.id
+FROM plan_assignments a
+CROSS JOIN generate_series(0, 24) k
+JOIN plan_students s ON s.n = 1 + ((a.n * 7919 + k * 2503) % 20000)
+WHERE a.n % 5 <> 0
+ON CONFLICT DO NOTHING;
+
+INSERT INTO assignment_files (assignment_id, file_path, original_name)
+SELECT a.id, 'plan_' || a.n || '_task.pdf', 'task.pdf'
+FROM plan_assignments a
+WHERE a.n % 3 = 0;
+
+-- Отправления: 40 на задание, часть после дедлайна, половина оценена
+INSERT INTO submissions (assignment_id, student_id, file_path, original_name, uploaded_at, grade, feedback)
+SELECT a.id, s.id,
+       'plan_' || a.n || '_' || k || '.bin',
+       'work_' || k || '.pdf',
+       a.due_date - interval '5 days' + ((a.n * 31 + k * 17) % 7200) * interval '1 minute',
+       CASE WHEN k % 2 = 0 THEN (3 + k % 3)::text END,
+       CASE WHEN k % 4 = 0 THEN 'Комментарий' END
+FROM plan_assignments a
+CROSS JOIN generate_series(0, 39) k
+JOIN plan_students s ON s.n = 1 + ((a.n * 104729 + k * 1299709) % 20000);
+
+INSERT INTO audit_log (user_id, action, details, ts)
+SELECT s.id, 'upload_submission', 'plan ' || g,
+       timestamp '2026-01-01' + (g % 300) * interval '1 day' + (g % 86400) * interval '1 second'
+FROM generate_series(1, 100000) g
+JOIN plan_students s ON s.n = 1 + (g % 20000);
+
+SELECT sp_assignment_stats_rebuild();
@@ -34,10 +34,7 @@ bool AuthManager::registerUser(const std::string &login,
     auto pw = auth::createPasswordHash(password, iters);
 
     QString loginQ = QString::fromStdString(login);
-    QSqlDatabase db = Database::instance().get();
-    QSqlQuery q(db);
-
-    q.prepare(R"SQL(
+    QSqlQuery q = Database::instance().prepared(R"SQL(
         SELECT sp_register_user(?, ?, ?, ?)
     )SQL");
     q.addBindValue(loginQ);
@@ -45,7 +42,7 @@ bool AuthManager::registerUser(const std::string &login,
     q.addBindValue(QString::fromStdString(auth::toHex(pw.hash)));
     q.addBindValue(QString::fromStdString(auth::toHex(pw.salt)));
 
-    if (!q.exec()) {
+    if (!Database::exec(q)) {
         qWarning() << "Register error:" << q.lastError().text();
         return false;
     }
@@ -59,15 +56,12 @@ bool AuthManager::authenticate(const std::string &login,
                                int &outUserId,
                                std::string &outRole)
 {
-    QSqlDatabase db = Database::instance().get();
-    QSqlQuery q(db);
-
-    q.prepare(R"SQL(
+    QSqlQuery q = Database::instance().prepared(R"SQL(
         SELECT * FROM sp_get_user_auth_data(?)
     )SQL");
     q.addBindValue(QString::fromStdString(login));
 
-    if (!q.exec()) {
+    if (!Database::exec(q)) {
         qWarning() << "Auth query error:" << q.lastError().text();
         return false;
     }
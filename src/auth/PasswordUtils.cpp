@@ -37,12 +37,17 @@ bool validatePasswordRules(const std::string &password, std::string &error) {
 }
 
 PBKDF2Result createPasswordHash(const std::string &password, int iterations) {
-    PBKDF2Result res;
-    res.salt.resize(16);
-    if (RAND_bytes(res.salt.data(), static_cast<int>(res.salt.size())) != 1) {
-        res.salt.clear();
-        return res;
+    std::vector<unsigned char> salt(16);
+    if (RAND_bytes(salt.data(), static_cast<int>(salt.size())) != 1) {
+        return PBKDF2Result();
     }
+    return createPasswordHash(password, iterations, salt);
+}
+
+PBKDF2Result createPasswordHash(const std::string &password, int iterations,
+                                const std::vector<unsigned char> &salt) {
+    PBKDF2Result res;
+    res.salt = salt;
     res.hash.resize(32);
     int ok = PKCS5_PBKDF2_HMAC(
         password.data(),
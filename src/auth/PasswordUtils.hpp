@@ -12,6 +12,9 @@ struct PBKDF2Result {
 bool validatePasswordRules(const std::string &password, std::string &error);
 
 PBKDF2Result createPasswordHash(const std::string &password, int iterations);
+/// То же с заданной солью (воспроизводимые тестовые данные).
+PBKDF2Result createPasswordHash(const std::string &password, int iterations,
+                                const std::vector<unsigned char> &salt);
 
 bool verifyPassword(const std::string &password,
                     const std::vector<unsigned char> &salt,
@@ -3,7 +3,9 @@
 #include <QFile>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QJsonArray>
 #include <QByteArray>
+#include <QCoreApplication>
 #include <QDebug>
 #include <QDir>
 #include <QFileInfo>
@@ -41,6 +43,20 @@ ConfigManager& ConfigManager::instance() {
     return inst;
 }
 
+std::string ConfigManager::findConfigPath() {
+    const QString appDir = QCoreApplication::applicationDirPath();
+    const QString candidates[] = {
+        QDir(appDir).filePath("config/config.json"),
+        QDir(appDir).filePath("config.json"),
+        QDir::current().filePath("config/config.json"),
+        QDir::current().filePath("config.json"),
+    };
+    for (const QString &p : candidates) {
+        if (QFileInfo(p).exists()) return p.toStdString();
+    }
+    return std::string();
+}
+
 bool ConfigManager::load(const std::string &path) {
     QFile f(QString::fromStdString(path));
     if (!f.open(QIODevice::ReadOnly)) {
@@ -76,6 +92,18 @@ bool ConfigManager::load(const std::string &path) {
         m_dbName = db.value("name").toString("edudesk").toStdString();
         m_dbUser = db.value("user").toString("edudesk").toStdString();
         m_dbPassword = db.value("password").toString("edudesk_pass").toStdString();
+
+        m_dbReplicas.clear();
+        for (const QJsonValue &v : db.value("replicas").toArray()) {
+            const QJsonObject r = v.toObject();
+            const QString host = r.value("host").toString().trimmed();
+            if (host.isEmpty()) continue;
+            m_dbReplicas.push_back(DbReplica{host.toStdString(), r.value("port").toInt(5432)});
+        }
+
+        m_replicaMaxLagMs = qMax(0, db.value("replica_max_lag_ms").toInt(1000));
+        m_readYourWritesMs = qMax(0, db.value("read_your_writes_ms").toInt(5000));
+        m_slowQueryMs = qMax(0, db.value("slow_query_ms").toInt(500));
     }
 
     QString storage = defaultStorageRoot();
@@ -130,6 +158,22 @@ std::string ConfigManager::dbPassword() const {
     return m_dbPassword;
 }
 
+const std::vector<DbReplica> &ConfigManager::dbReplicas() const {
+    return m_dbReplicas;
+}
+
+int ConfigManager::replicaMaxLagMs() const {
+    return m_replicaMaxLagMs;
+}
+
+int ConfigManager::readYourWritesMs() const {
+    return m_readYourWritesMs;
+}
+
+int ConfigManager::slowQueryMs() const {
+    return m_slowQueryMs;
+}
+
 std::string ConfigManager::storageRoot() const {
     if (!m_storageRoot.empty()) return m_storageRoot;
     return defaultStorageRoot().toStdString();
@@ -152,6 +196,7 @@ bool ConfigManager::ensureStorageLayout() const {
     QDir().mkpath(d.filePath("files"));
     QDir().mkpath(d.filePath("metadata"));
     QDir().mkpath(d.filePath("assignments"));
+    QDir().mkpath(d.filePath("archive"));
 
     return true;
 }
@@ -3,9 +3,18 @@
 #include <vector>
 #include <string>
 
+/// Реплика только для чтения; имя БД и учётные данные общие с основным сервером.
+struct DbReplica {
+    std::string host;
+    int port = 5432;
+};
+
 class ConfigManager {
 public:
     static ConfigManager& instance();
+    /// Путь к config.json: config/config.json или config.json рядом с исполняемым
+    /// файлом, затем в текущем каталоге; пустая строка, если не найден.
+    static std::string findConfigPath();
 
     bool load(const std::string &path);
 
@@ -18,6 +27,14 @@ public:
     std::string dbUser() const;
     std::string dbPassword() const;
 
+    const std::vector<DbReplica> &dbReplicas() const;
+    /// Максимально допустимое отставание реплики, мс.
+    int replicaMaxLagMs() const;
+    /// Сколько после собственной записи читать только с основного сервера, мс.
+    int readYourWritesMs() const;
+    /// Порог записи вызова в logs/slow_queries.log, мс; 0 — не писать.
+    int slowQueryMs() const;
+
     std::string storageRoot() const;
     std::string storagePath(const std::string &relative) const;
     bool ensureStorageLayout() const;
@@ -34,5 +51,10 @@ private:
     std::string m_dbUser = "edudesk";
     std::string m_dbPassword = "edudesk_pass";
 
+    std::vector<DbReplica> m_dbReplicas;
+    int m_replicaMaxLagMs = 1000;
+    int m_readYourWritesMs = 5000;
+    int m_slowQueryMs = 500;
+
     std::string m_storageRoot;
 };
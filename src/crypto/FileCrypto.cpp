@@ -15,30 +15,26 @@ std::vector<unsigned char> genRandomBytes(std::size_t len) {
     return out;
 }
 
-static bool encryptBufferSecretbox(const std::vector<unsigned char> &key,
-                                   const QByteArray &plain,
-                                   QByteArray &outCipher,
-                                   std::string &err)
+static bool sealSecretbox(const std::vector<unsigned char> &key,
+                          const unsigned char *nonce,
+                          const unsigned char *plain,
+                          std::size_t plainLen,
+                          unsigned char *dst,
+                          std::string &err)
 {
     if (key.size() != crypto_secretbox_KEYBYTES) {
         err = "invalid key size for secretbox (must be 32 bytes)";
         return false;
     }
 
-    unsigned char nonce[crypto_secretbox_NONCEBYTES];
-    randombytes_buf(nonce, sizeof(nonce));
-
-    outCipher.resize(crypto_secretbox_NONCEBYTES + plain.size() + crypto_secretbox_MACBYTES);
-
-    unsigned char *dst = reinterpret_cast<unsigned char*>(outCipher.data());
     std::memcpy(dst, nonce, crypto_secretbox_NONCEBYTES);
 
     unsigned char *c = dst + crypto_secretbox_NONCEBYTES;
 
     if (crypto_secretbox_easy(
             c,
-            reinterpret_cast<const unsigned char*>(plain.constData()),
-            static_cast<unsigned long long>(plain.size()),
+            plain,
+            static_cast<unsigned long long>(plainLen),
             nonce,
             key.data()) != 0)
     {
@@ -49,6 +45,39 @@ static bool encryptBufferSecretbox(const std::vector<unsigned char> &key,
     return true;
 }
 
+static bool encryptBufferSecretbox(const std::vector<unsigned char> &key,
+                                   const QByteArray &plain,
+                                   QByteArray &outCipher,
+                                   std::string &err)
+{
+    unsigned char nonce[crypto_secretbox_NONCEBYTES];
+    randombytes_buf(nonce, sizeof(nonce));
+
+    outCipher.resize(crypto_secretbox_NONCEBYTES + plain.size() + crypto_secretbox_MACBYTES);
+
+    return sealSecretbox(key, nonce,
+                         reinterpret_cast<const unsigned char*>(plain.constData()),
+                         static_cast<std::size_t>(plain.size()),
+                         reinterpret_cast<unsigned char*>(outCipher.data()),
+                         err);
+}
+
+bool encryptBuffer(const std::vector<unsigned char> &key,
+                   const std::vector<unsigned char> &nonce,
+                   const unsigned char *plain,
+                   std::size_t plainLen,
+                   std::vector<unsigned char> &outCipher,
+                   std::string &err)
+{
+    if (nonce.size() != crypto_secretbox_NONCEBYTES) {
+        err = "invalid nonce size for secretbox";
+        return false;
+    }
+
+    outCipher.resize(crypto_secretbox_NONCEBYTES + plainLen + crypto_secretbox_MACBYTES);
+    return sealSecretbox(key, nonce.data(), plain, plainLen, outCipher.data(), err);
+}
+
 static bool decryptBufferSecretbox(const std::vector<unsigned char> &key,
                                    const QByteArray &cipher,
                                    QByteArray &outPlain,
@@ -91,6 +120,21 @@ static bool decryptBufferSecretbox(const std::vector<unsigned char> &key,
     return true;
 }
 
+bool decryptBuffer(const std::vector<unsigned char> &key,
+                   const unsigned char *cipher,
+                   std::size_t cipherLen,
+                   std::vector<unsigned char> &outPlain,
+                   std::string &err)
+{
+    const QByteArray raw = QByteArray::fromRawData(reinterpret_cast<const char*>(cipher), static_cast<int>(cipherLen));
+    QByteArray plain;
+    if (!decryptBufferSecretbox(key, raw, plain, err)) {
+        return false;
+    }
+    outPlain.assign(plain.constData(), plain.constData() + plain.size());
+    return true;
+}
+
 bool aes256_cbc_encrypt(const std::vector<unsigned char> &key,
                         const std::vector<unsigned char> &iv,
                         const std::string &inPath,
@@ -7,6 +7,21 @@ namespace crypto {
 /// Генерация случайных байт (libsodium randombytes_buf)
 std::vector<unsigned char> genRandomBytes(std::size_t len);
 
+/// Шифрование буфера в формате файлов хранилища (nonce || secretbox) с заданным nonce
+bool encryptBuffer(const std::vector<unsigned char> &key,
+                   const std::vector<unsigned char> &nonce,
+                   const unsigned char *plain,
+                   std::size_t plainLen,
+                   std::vector<unsigned char> &outCipher,
+                   std::string &err);
+
+/// Расшифровка буфера в формате файлов хранилища (nonce || secretbox)
+bool decryptBuffer(const std::vector<unsigned char> &key,
+                   const unsigned char *cipher,
+                   std::size_t cipherLen,
+                   std::vector<unsigned char> &outPlain,
+                   std::string &err);
+
 /// Шифрование файла
 bool aes256_cbc_encrypt(const std::vector<unsigned char> &key,
                         const std::vector<unsigned char> &iv,
@@ -28,6 +28,31 @@ bool encryptWithAesGcm(const std::vector<unsigned char> &masterKey,
     iv.resize(crypto_secretbox_NONCEBYTES);
     randombytes_buf(iv.data(), iv.size());
 
+    tag.clear();
+    return encryptWithNonce(masterKey, plaintextKey, iv, encKey, err);
+}
+
+bool encryptWithNonce(const std::vector<unsigned char> &masterKey,
+                      const std::vector<unsigned char> &plaintextKey,
+                      const std::vector<unsigned char> &iv,
+                      std::vector<unsigned char> &encKey,
+                      std::string &err)
+{
+    if (masterKey.size() != crypto_secretbox_KEYBYTES) {
+        err = "masterKey must be 32 bytes for secretbox";
+        return false;
+    }
+
+    if (plaintextKey.empty()) {
+        err = "plaintextKey is empty";
+        return false;
+    }
+
+    if (iv.size() != crypto_secretbox_NONCEBYTES) {
+        err = "iv must be crypto_secretbox_NONCEBYTES long";
+        return false;
+    }
+
     encKey.resize(plaintextKey.size() + crypto_secretbox_MACBYTES);
 
     if (crypto_secretbox_easy(
@@ -41,7 +66,6 @@ bool encryptWithAesGcm(const std::vector<unsigned char> &masterKey,
         return false;
     }
 
-    tag.clear();
     return true;
 }
 
@@ -11,6 +11,13 @@ bool encryptWithAesGcm(const std::vector<unsigned char> &masterKey,
                        std::vector<unsigned char> &tag,
                        std::string &err);
 
+/// То же с заданным nonce (iv) — для воспроизводимых тестовых данных.
+bool encryptWithNonce(const std::vector<unsigned char> &masterKey,
+                      const std::vector<unsigned char> &plaintextKey,
+                      const std::vector<unsigned char> &iv,
+                      std::vector<unsigned char> &encKey,
+                      std::string &err);
+
 bool decryptWithAesGcm(const std::vector<unsigned char> &masterKey,
                        const std::vector<unsigned char> &encKey,
                        const std::vector<unsigned char> &iv,
@@ -0,0 +1,74 @@
+#include "ChangeListener.hpp"
+#include "Database.hpp"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDebug>
+
+static const char *kListenerConnection = "EduDeskListener";
+static const char *kChannel = "edudesk_changes";
+
+ChangeListener& ChangeListener::instance() {
+    static ChangeListener inst;
+    return inst;
+}
+
+bool ChangeListener::start() {
+    if (m_db.isValid() && m_db.isOpen()) return true;
+
+    m_db = Database::openConnection(kListenerConnection);
+    if (!m_db.isOpen()) return false;
+
+    QSqlDriver *drv = m_db.driver();
+    if (!drv->subscribeToNotification(kChannel)) {
+        qWarning() << "LISTEN" << kChannel << "failed:" << drv->lastError().text();
+        return false;
+    }
+
+    connect(drv, QOverload<const QString &, QSqlDriver::NotificationSource, const QVariant &>::of(&QSqlDriver::notification),
+            this, &ChangeListener::onNotification, Qt::UniqueConnection);
+    return true;
+}
+
+void ChangeListener::stop() {
+    if (!m_db.isValid()) return;
+
+    if (m_db.isOpen()) {
+        m_db.driver()->unsubscribeFromNotification(kChannel);
+        m_db.close();
+    }
+    m_db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(kListenerConnection);
+}
+
+bool ChangeListener::isActive() const {
+    return m_db.isValid() && m_db.isOpen()
+        && m_db.driver()->subscribedToNotifications().contains(QLatin1String(kChannel));
+}
+
+void ChangeListener::onNotification(const QString &name, QSqlDriver::NotificationSource, const QVariant &payload) {
+    if (name != QLatin1String(kChannel)) return;
+
+    const QJsonDocument doc = QJsonDocument::fromJson(payload.toString().toUtf8());
+    if (!doc.isObject()) {
+        qWarning() << "Unexpected change payload:" << payload;
+        return;
+    }
+
+    const QJsonObject o = doc.object();
+    // Свои записи окна уже применили к моделям сами — не перечитываем их повторно
+    const int pid = o.value("pid").toInt();
+    if (pid != 0 && pid == Database::instance().backendPid()) return;
+
+    const QString table = o.value("table").toString();
+    const QString op = o.value("op").toString();
+
+    if (table == QLatin1String("submissions")) {
+        emit submissionChanged(o.value("id").toInt(), o.value("assignment_id").toInt(),
+                               o.value("student_id").toInt(), op);
+    } else if (table == QLatin1String("assignments")) {
+        emit assignmentChanged(o.value("id").toInt(), o.value("created_by").toInt(), op);
+    } else if (table == QLatin1String("assignment_students")) {
+        emit audienceChanged(o.value("assignment_id").toInt(), o.value("student_id").toInt(), op);
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QVariant>
+#include <QSqlDatabase>
+#include <QSqlDriver>
+
+/// Слушает канал edudesk_changes (LISTEN/NOTIFY) на выделенном соединении
+/// и раздаёт изменения строк submissions / assignments / assignment_students.
+class ChangeListener : public QObject {
+    Q_OBJECT
+public:
+    static ChangeListener& instance();
+
+    bool start();
+    void stop();
+
+    /// true, если канал прослушивается и изменения строк придут сигналами.
+    bool isActive() const;
+
+signals:
+    void submissionChanged(int submissionId, int assignmentId, int studentId, const QString &op);
+    void assignmentChanged(int assignmentId, int createdBy, const QString &op);
+    void audienceChanged(int assignmentId, int studentId, const QString &op);
+
+private slots:
+    void onNotification(const QString &name, QSqlDriver::NotificationSource source, const QVariant &payload);
+
+private:
+    ChangeListener() = default;
+
+    QSqlDatabase m_db;
+};
@@ -1,36 +1,120 @@
 #include "Database.hpp"
+#include "PgConnection.hpp"
+#include "PgPipeline.hpp"
+#include "QueryStats.hpp"
 #include "../config/ConfigManager.hpp"
 #include <QSqlDatabase>
 #include <QSqlError>
+#include <QElapsedTimer>
 #include <QDebug>
 
+#include <chrono>
+
+static qint64 steadyNowMs() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static QSqlDatabase openNamed(const QString &name, const std::string &host, int port, const QString &options) {
+    QSqlDatabase conn;
+    if (QSqlDatabase::contains(name)) {
+        conn = QSqlDatabase::database(name, false);
+    } else {
+        auto &cfg = ConfigManager::instance();
+        conn = QSqlDatabase::addDatabase("QPSQL", name);
+        conn.setHostName(QString::fromStdString(host));
+        conn.setPort(port);
+        conn.setDatabaseName(QString::fromStdString(cfg.dbName()));
+        conn.setUserName(QString::fromStdString(cfg.dbUser()));
+        conn.setPassword(QString::fromStdString(cfg.dbPassword()));
+        if (!options.isEmpty()) conn.setConnectOptions(options);
+    }
+    if (!conn.isOpen() && !conn.open()) {
+        qWarning() << "Failed to open Postgres DB" << name << ":" << conn.lastError().text();
+    }
+    return conn;
+}
+
 Database& Database::instance() {
     static Database inst;
     return inst;
 }
 
-bool Database::open() {
+Database::~Database() = default;
+
+QSqlDatabase Database::openConnection(const QString &name) {
     auto &cfg = ConfigManager::instance();
-    QString host = QString::fromStdString(cfg.dbHost());
-    int port = cfg.dbPort();
-    QString dbname = QString::fromStdString(cfg.dbName());
-    QString user = QString::fromStdString(cfg.dbUser());
-    QString pass = QString::fromStdString(cfg.dbPassword());
-
-    if (QSqlDatabase::contains("EduDeskConnection")) {
-        db = QSqlDatabase::database("EduDeskConnection");
-    } else {
-        db = QSqlDatabase::addDatabase("QPSQL", "EduDeskConnection");
-        db.setHostName(host);
-        db.setPort(port);
-        db.setDatabaseName(dbname);
-        db.setUserName(user);
-        db.setPassword(pass);
+    return openNamed(name, cfg.dbHost(), cfg.dbPort(), QString());
+}
+
+QSqlDatabase Database::openReplicaConnection(const QString &name, int index) {
+    const auto &replicas = ConfigManager::instance().dbReplicas();
+    if (index < 0 || index >= static_cast<int>(replicas.size())) return QSqlDatabase();
+
+    // Недоступная реплика не должна надолго блокировать рабочий поток
+    return openNamed(name, replicas[index].host, replicas[index].port, QStringLiteral("connect_timeout=2"));
+}
+
+int Database::replicaCount() {
+    return static_cast<int>(ConfigManager::instance().dbReplicas().size());
+}
+
+void Database::noteWrite() {
+    m_lastWriteMs.store(steadyNowMs(), std::memory_order_relaxed);
+}
+
+bool Database::replicaReadAllowed() const {
+    auto &cfg = ConfigManager::instance();
+    if (cfg.dbReplicas().empty()) return false;
+
+    const qint64 last = m_lastWriteMs.load(std::memory_order_relaxed);
+    if (last == 0) return true;
+
+    // Окно не короче допустимого отставания плюс период его проверки: по истечении
+    // окна реплика с отставанием в пределах порога уже содержит эту запись
+    const qint64 window = qMax<qint64>(cfg.readYourWritesMs(), cfg.replicaMaxLagMs() + kReplicaCheckMs);
+    return steadyNowMs() - last >= window;
+}
+
+QString Database::intArrayLiteral(const QList<int> &values) {
+    QString out = QStringLiteral("{");
+    for (int i = 0; i < values.size(); ++i) {
+        if (i > 0) out += QLatin1Char(',');
+        out += QString::number(values[i]);
     }
-    if (!db.open()) {
-        qWarning() << "Failed to open Postgres DB:" << db.lastError().text();
-        return false;
+    out += QLatin1Char('}');
+    return out;
+}
+
+QString Database::textArrayLiteral(const QStringList &values) {
+    QString out = QStringLiteral("{");
+    for (int i = 0; i < values.size(); ++i) {
+        if (i > 0) out += QLatin1Char(',');
+        const QString &v = values[i];
+        if (v.isNull()) {
+            out += QStringLiteral("NULL");
+            continue;
+        }
+        out += QLatin1Char('"');
+        for (const QChar c : v) {
+            if (c == QLatin1Char('"') || c == QLatin1Char('\\')) out += QLatin1Char('\\');
+            out += c;
+        }
+        out += QLatin1Char('"');
     }
+    out += QLatin1Char('}');
+    return out;
+}
+
+bool Database::open() {
+    db = openConnection("EduDeskConnection");
+    m_statements.setDatabase(db);
+    m_backendPid = 0;
+    if (!db.isOpen()) return false;
+
+    QSqlQuery q(db);
+    if (q.exec("SELECT pg_backend_pid()") && q.next())
+        m_backendPid = q.value(0).toInt();
     return true;
 }
 
@@ -38,6 +122,39 @@ QSqlDatabase Database::get() const {
     return db;
 }
 
+QSqlQuery Database::prepared(const QString &sql) {
+    return m_statements.prepare(sql);
+}
+
+bool Database::exec(QSqlQuery &q) {
+    QElapsedTimer timer;
+    timer.start();
+    const bool ok = q.exec();
+    const qint64 us = timer.nsecsElapsed() / 1000;
+
+    QVariantList binds;
+    const int count = q.boundValues().size();
+    for (int i = 0; i < count; ++i) binds << q.boundValue(i);
+    QueryStats::instance().record(q.lastQuery(), binds, us, -1, -1, ok);
+    return ok;
+}
+
+PgPipeline *Database::pipeline() {
+    if (m_pipeline && m_pgConn->isOpen()) return m_pipeline.get();
+
+    // Подготовленные запросы конвейера жили на прежнем соединении
+    m_pipeline.reset();
+    if (!m_pgConn) m_pgConn = std::make_unique<PgConnection>();
+    if (!m_pgConn->open()) return nullptr;
+
+    m_pipeline = std::make_unique<PgPipeline>(*m_pgConn);
+    return m_pipeline.get();
+}
+
 void Database::close() {
+    m_statements.clear();
+    m_pipeline.reset();
+    if (m_pgConn) m_pgConn->close();
     if (db.isOpen()) db.close();
+    m_backendPid = 0;
 }
@@ -1,15 +1,70 @@
 #pragma once
 #include <QString>
+#include <QList>
+#include <QStringList>
 #include <QSqlDatabase>
+#include <QSqlQuery>
+
+#include <atomic>
+#include <memory>
+
+#include "StatementCache.hpp"
+
+class PgConnection;
+class PgPipeline;
 
 class Database {
 public:
     static Database& instance();
+    ~Database();
     bool open();
     QSqlDatabase get() const;
     void close();
+    /// pg_backend_pid() основного соединения (0, если не открыто): по нему
+    /// ChangeListener отбрасывает NOTIFY о записях самого клиента.
+    int backendPid() const { return m_backendPid; }
+
+    /// Подготовленный запрос основного соединения из кэша (см. StatementCache).
+    QSqlQuery prepared(const QString &sql);
+    const StatementCache &statements() const { return m_statements; }
+
+    /// q.exec() с записью задержки в QueryStats (и в журнал медленных запросов).
+    /// Для синхронных вызовов: строки разбирает вызывающий, поэтому они не считаются.
+    static bool exec(QSqlQuery &q);
+
+    /// Конвейер libpq для пакетов мелких вызовов (см. PgPipeline) на отдельном
+    /// соединении основного потока, открываемом при первом обращении.
+    /// nullptr, если подключиться не удалось.
+    PgPipeline *pipeline();
+
+    /// Открывает (или переиспользует) именованное соединение с параметрами из конфига.
+    /// Соединение можно использовать только из потока, в котором оно было открыто.
+    static QSqlDatabase openConnection(const QString &name);
+    /// То же для реплики №index из db.replicas (только чтение).
+    static QSqlDatabase openReplicaConnection(const QString &name, int index);
+    static int replicaCount();
+
+    /// Как часто рабочий поток перепроверяет отставание реплики, мс.
+    static constexpr int kReplicaCheckMs = 1000;
+
+    /// Отмечает запись на основном сервере (своим соединением или дочерним процессом):
+    /// в течение окна read-your-writes чтения идут только на основной сервер.
+    /// Перечитывание по NOTIFY окна не открывает — оно само идёт с ReadFrom::Primary.
+    void noteWrite();
+    /// true, если реплики настроены и окно после последней записи истекло.
+    bool replicaReadAllowed() const;
+
+    /// Литерал массива PostgreSQL ("{1,2,3}") для привязки как ?::integer[].
+    static QString intArrayLiteral(const QList<int> &values);
+    /// Литерал массива text[]; null-строки передаются как NULL.
+    static QString textArrayLiteral(const QStringList &values);
 
 private:
     Database() = default;
     QSqlDatabase db;
+    StatementCache m_statements;
+    std::unique_ptr<PgConnection> m_pgConn;
+    std::unique_ptr<PgPipeline> m_pipeline;
+    std::atomic<qint64> m_lastWriteMs{0};
+    int m_backendPid = 0;
 };
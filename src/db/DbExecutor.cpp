@@ -0,0 +1,407 @@
+#include "DbExecutor.hpp"
+#include "Database.hpp"
+#include "StatementCache.hpp"
+#include "QueryStats.hpp"
+#include "../config/ConfigManager.hpp"
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QSqlDriver>
+#include <QSqlError>
+#include <QSqlResult>
+#include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <QSet>
+
+#include <chrono>
+
+#include <libpq-fe.h>
+
+static const char *kWorkerConnection = "EduDeskWorker";
+static const char *kReplicaConnection = "EduDeskWorkerReplica";
+
+DbRow dbRowFromQuery(const QSqlQuery &q) {
+    const int cols = q.record().count();
+    DbRow row(cols);
+    for (int c = 0; c < cols; ++c) row[c] = q.value(c);
+    return row;
+}
+
+// Байты текущей строки в ответе сервера. QPSQL отдаёт PGresult через handle();
+// для forward-only запросов это однострочный результат (single-row mode)
+static qint64 pgRowBytes(const QSqlQuery &q) {
+    const QVariant h = q.result()->handle();
+    if (qstrcmp(h.typeName(), "PGresult*") != 0) return 0;
+    const PGresult *res = *static_cast<PGresult *const *>(h.constData());
+    if (!res) return 0;
+
+    const int row = PQntuples(res) == 1 ? 0 : q.at();
+    if (row < 0 || row >= PQntuples(res)) return 0;
+    qint64 bytes = 0;
+    for (int c = 0, n = PQnfields(res); c < n; ++c) bytes += PQgetlength(res, row, c);
+    return bytes;
+}
+
+// Живёт в рабочем потоке и владеет его соединением с БД
+class DbWorker : public QObject {
+public:
+    explicit DbWorker(DbExecutor *owner) : m_owner(owner) {}
+
+    void run(quint64 ticket, const QString &sql, const QVariantList &binds, DbExecutor::ReadFrom from);
+    void closeConnection();
+
+private:
+    bool execute(quint64 ticket, StatementCache &statements, const QString &sql,
+                 const QVariantList &binds, DbResult &result);
+    bool replicaUsable();
+    void dropReplica();
+
+    DbExecutor *m_owner;
+    QSqlDatabase m_db;
+    StatementCache m_statements;
+
+    // Реплика для чтения (db.replicas); -1 — не выбрана
+    QSqlDatabase m_replica;
+    StatementCache m_replicaStatements;
+    int m_replicaIndex = -1;
+    bool m_replicaFresh = false;
+    std::chrono::steady_clock::time_point m_replicaCheckedAt;
+    // Реплики, о переходе которых в отставание уже предупредили
+    QSet<int> m_laggingReplicas;
+};
+
+// Дескриптор отмены соединения, на котором выполняется q (PQcancel)
+static PGcancel *cancelHandle(const QSqlQuery &q) {
+    const QVariant h = q.driver() ? q.driver()->handle() : QVariant();
+    if (qstrcmp(h.typeName(), "PGconn*") != 0) return nullptr;
+    PGconn *conn = *static_cast<PGconn *const *>(h.constData());
+    return conn ? PQgetCancel(conn) : nullptr;
+}
+
+// false — запрос отменён (до ответа сервера или во время разбора строк)
+bool DbWorker::execute(quint64 ticket, StatementCache &statements, const QString &sql,
+                       const QVariantList &binds, DbResult &result) {
+    QElapsedTimer timer;
+    timer.start();
+
+    QSqlQuery q = statements.prepare(sql);
+    for (const QVariant &v : binds) q.addBindValue(v);
+
+    m_owner->waitForCancels();
+    m_owner->setRunning(ticket, cancelHandle(q));
+    struct RunningGuard {
+        DbExecutor *owner;
+        ~RunningGuard() { owner->setRunning(0, nullptr); }
+    } running{m_owner};
+
+    if (!q.exec()) {
+        if (!m_owner->isPending(ticket)) return false;
+        result.error = q.lastError().text();
+        QueryStats::instance().record(sql, binds, timer.nsecsElapsed() / 1000, -1, -1, false);
+        return true;
+    }
+
+    qint64 bytes = 0;
+    if (q.size() > 0) result.rows.reserve(q.size());
+    while (q.next()) {
+        // Отменённый запрос дальше не разбираем
+        if ((result.rows.size() & 1023) == 0 && !m_owner->isPending(ticket)) return false;
+
+        bytes += pgRowBytes(q);
+        result.rows.push_back(dbRowFromQuery(q));
+    }
+    if (!m_owner->isPending(ticket)) return false;
+
+    // В single-row mode ошибка (в том числе отмена) может прийти посреди строк
+    if (q.lastError().isValid()) {
+        result.error = q.lastError().text();
+        result.rows.clear();
+        QueryStats::instance().record(sql, binds, timer.nsecsElapsed() / 1000, -1, -1, false);
+        return true;
+    }
+
+    result.ok = true;
+    // Время — до последней строки: в single-row mode строки приходят по мере чтения
+    QueryStats::instance().record(sql, binds, timer.nsecsElapsed() / 1000, result.rows.size(), bytes, true);
+    return true;
+}
+
+// Выбирает реплику с отставанием в пределах replica_max_lag_ms; результат проверки
+// держится kReplicaCheckMs, чтобы не добавлять лишний запрос к каждому чтению
+bool DbWorker::replicaUsable() {
+    const int count = Database::replicaCount();
+    if (count == 0) return false;
+
+    const auto now = std::chrono::steady_clock::now();
+    if (m_replicaIndex >= 0 && now - m_replicaCheckedAt < std::chrono::milliseconds(Database::kReplicaCheckMs))
+        return m_replicaFresh;
+
+    m_replicaCheckedAt = now;
+    m_replicaFresh = false;
+
+    const int maxLag = ConfigManager::instance().replicaMaxLagMs();
+    const int start = qMax(0, m_replicaIndex);
+    for (int i = 0; i < count; ++i) {
+        const int idx = (start + i) % count;
+        if (idx != m_replicaIndex || !m_replica.isOpen()) {
+            dropReplica();
+            m_replica = Database::openReplicaConnection(kReplicaConnection, idx);
+            m_replicaStatements.setDatabase(m_replica);
+            m_replicaIndex = idx;
+        }
+        if (!m_replica.isOpen()) continue;
+
+        QSqlQuery q = m_replicaStatements.prepare("SELECT sp_replica_lag_ms()");
+        if (!q.exec() || !q.next()) {
+            qWarning() << "Replica" << idx << "lag check failed:" << q.lastError().text();
+            continue;
+        }
+
+        // Пишем только смену состояния: проверка идёт каждые kReplicaCheckMs
+        const int lag = q.value(0).toInt();
+        if (lag <= maxLag) {
+            if (m_laggingReplicas.remove(idx)) qWarning() << "Replica" << idx << "caught up, lag" << lag << "ms";
+            m_replicaFresh = true;
+            return true;
+        }
+        if (!m_laggingReplicas.contains(idx)) {
+            m_laggingReplicas.insert(idx);
+            qWarning() << "Replica" << idx << "lags" << lag << "ms, reading from primary";
+        }
+    }
+    return false;
+}
+
+void DbWorker::dropReplica() {
+    m_replicaStatements.clear();
+    m_replicaIndex = -1;
+    m_replicaFresh = false;
+    if (m_replica.isValid()) {
+        m_replica.close();
+        m_replica = QSqlDatabase();
+        QSqlDatabase::removeDatabase(kReplicaConnection);
+    }
+}
+
+void DbWorker::run(quint64 ticket, const QString &sql, const QVariantList &binds, DbExecutor::ReadFrom from) {
+    if (!m_owner->isPending(ticket)) return;
+
+    DbResult result;
+    bool served = false;
+
+    // Через исполнитель идут только чтения: сначала пробуем реплику
+    if (from == DbExecutor::ReadFrom::Any && Database::instance().replicaReadAllowed() && replicaUsable()) {
+        if (!execute(ticket, m_replicaStatements, sql, binds, result)) return;
+        served = result.ok;
+        if (!served) {
+            qWarning() << "Replica query failed, retrying on primary:" << result.error;
+            m_replicaFresh = false;
+            result = DbResult();
+        }
+    }
+
+    if (!served) {
+        if (!m_db.isValid() || !m_db.isOpen()) {
+            m_db = Database::openConnection(kWorkerConnection);
+            m_statements.setDatabase(m_db);
+        }
+
+        if (!m_db.isOpen()) {
+            result.error = m_db.lastError().text();
+        } else if (!execute(ticket, m_statements, sql, binds, result)) {
+            return;
+        }
+    }
+
+    DbExecutor *owner = m_owner;
+    QMetaObject::invokeMethod(owner, [owner, ticket, result]() {
+        owner->deliver(ticket, result);
+    }, Qt::QueuedConnection);
+}
+
+void DbWorker::closeConnection() {
+    dropReplica();
+    m_statements.clear();
+    if (m_db.isValid()) {
+        m_db.close();
+        m_db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(kWorkerConnection);
+    }
+}
+
+DbExecutor& DbExecutor::instance() {
+    static DbExecutor inst;
+    return inst;
+}
+
+DbExecutor::DbExecutor() {
+    m_worker = new DbWorker(this);
+    m_worker->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+    m_thread.setObjectName("EduDeskDbWorker");
+    m_thread.start();
+
+    m_canceller = std::thread([this]() { cancelLoop(); });
+}
+
+DbExecutor::~DbExecutor() {
+    shutdown();
+    stopCanceller();
+}
+
+quint64 DbExecutor::submit(const QString &sql, const QVariantList &binds, QObject *context, Callback cb,
+                           ReadFrom from) {
+    return enqueue(QString(), sql, binds, context, std::move(cb), from);
+}
+
+quint64 DbExecutor::submitLatest(const QString &key, const QString &sql, const QVariantList &binds,
+                                 QObject *context, Callback cb, ReadFrom from) {
+    quint64 previous;
+    {
+        QMutexLocker lock(&m_mutex);
+        previous = m_latest.value(LatestKey(context, key));
+    }
+    cancel(previous);
+    return enqueue(key, sql, binds, context, std::move(cb), from);
+}
+
+quint64 DbExecutor::enqueue(const QString &key, const QString &sql, const QVariantList &binds,
+                            QObject *context, Callback cb, ReadFrom from) {
+    quint64 ticket;
+    {
+        QMutexLocker lock(&m_mutex);
+        ticket = m_nextTicket++;
+        m_pending.insert(ticket, Pending{QPointer<QObject>(context), std::move(cb), key});
+        if (!key.isEmpty()) m_latest.insert(LatestKey(context, key), ticket);
+    }
+
+    if (!m_thread.isRunning()) {
+        DbResult res;
+        res.error = QStringLiteral("DB executor is stopped");
+        deliver(ticket, res);
+        return ticket;
+    }
+
+    DbWorker *worker = m_worker;
+    QMetaObject::invokeMethod(worker, [worker, ticket, sql, binds, from]() {
+        worker->run(ticket, sql, binds, from);
+    }, Qt::QueuedConnection);
+
+    return ticket;
+}
+
+void DbExecutor::cancel(quint64 ticket) {
+    if (ticket == 0) return;
+    {
+        QMutexLocker lock(&m_mutex);
+        auto it = m_pending.find(ticket);
+        if (it == m_pending.end()) return;
+        const LatestKey latest(it->context.data(), it->key);
+        if (!it->key.isEmpty() && m_latest.value(latest) == ticket) m_latest.remove(latest);
+        m_pending.erase(it);
+    }
+
+    QMutexLocker lock(&m_runningMutex);
+    if (m_runningTicket != ticket || !m_runningCancel) return;
+
+    PGcancel *handle = m_runningCancel;
+    m_runningCancel = nullptr;
+    m_runningTicket = 0;
+    {
+        std::lock_guard<std::mutex> cancelLock(m_cancelMutex);
+        if (m_cancelStop) {
+            PQfreeCancel(handle);
+            return;
+        }
+        m_cancelQueue.push_back(handle);
+    }
+    m_cancelCv.notify_all();
+}
+
+void DbExecutor::cancelLoop() {
+    std::unique_lock<std::mutex> lock(m_cancelMutex);
+    for (;;) {
+        m_cancelCv.wait(lock, [this]() { return m_cancelStop || !m_cancelQueue.empty(); });
+        if (m_cancelQueue.empty()) break;
+
+        PGcancel *handle = m_cancelQueue.front();
+        m_cancelQueue.pop_front();
+        m_cancelBusy = true;
+        lock.unlock();
+
+        char err[256];
+        if (!PQcancel(handle, err, sizeof(err))) qWarning() << "PQcancel failed:" << err;
+        PQfreeCancel(handle);
+
+        lock.lock();
+        m_cancelBusy = false;
+        m_cancelCv.notify_all();
+    }
+}
+
+void DbExecutor::waitForCancels() {
+    std::unique_lock<std::mutex> lock(m_cancelMutex);
+    m_cancelCv.wait(lock, [this]() { return m_cancelStop || (m_cancelQueue.empty() && !m_cancelBusy); });
+}
+
+// Уже поставленные отмены отправляются до выхода потока
+void DbExecutor::stopCanceller() {
+    {
+        std::lock_guard<std::mutex> lock(m_cancelMutex);
+        m_cancelStop = true;
+    }
+    m_cancelCv.notify_all();
+    if (m_canceller.joinable()) m_canceller.join();
+}
+
+void DbExecutor::setRunning(quint64 ticket, PGcancel *cancel) {
+    PGcancel *previous;
+    {
+        QMutexLocker lock(&m_runningMutex);
+        previous = m_runningCancel;
+        m_runningTicket = ticket;
+        m_runningCancel = cancel;
+    }
+    if (previous) PQfreeCancel(previous);
+}
+
+bool DbExecutor::isPending(quint64 ticket) const {
+    QMutexLocker lock(&m_mutex);
+    return m_pending.contains(ticket);
+}
+
+void DbExecutor::deliver(quint64 ticket, const DbResult &result) {
+    Pending p;
+    {
+        QMutexLocker lock(&m_mutex);
+        auto it = m_pending.find(ticket);
+        if (it == m_pending.end()) return;
+        p = it.value();
+        const LatestKey latest(p.context.data(), p.key);
+        if (!p.key.isEmpty() && m_latest.value(latest) == ticket) m_latest.remove(latest);
+        m_pending.erase(it);
+    }
+
+    if (!p.context) return;
+    if (!result.ok) qWarning() << "Async query failed:" << result.error;
+    p.callback(result);
+}
+
+void DbExecutor::shutdown() {
+    if (!m_thread.isRunning()) return;
+
+    {
+        QMutexLocker lock(&m_mutex);
+        m_pending.clear();
+        m_latest.clear();
+    }
+
+    DbWorker *worker = m_worker;
+    QMetaObject::invokeMethod(worker, [worker]() { worker->closeConnection(); }, Qt::BlockingQueuedConnection);
+    m_thread.quit();
+    m_thread.wait();
+    m_worker = nullptr;
+    stopCanceller();
+}
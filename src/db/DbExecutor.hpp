@@ -0,0 +1,117 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QPointer>
+#include <QThread>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+class QSqlQuery;
+typedef struct pg_cancel PGcancel;
+
+using DbRow = QVector<QVariant>;
+
+/// Копирует текущую строку запроса (после next()) в DbRow.
+DbRow dbRowFromQuery(const QSqlQuery &q);
+
+struct DbResult {
+    bool ok = false;
+    QString error;
+    QVector<DbRow> rows;
+};
+
+class DbWorker;
+
+/// Выполняет вызовы хранимых процедур на отдельном соединении в фоновом потоке
+/// и доставляет строки обратно в GUI-поток. Только для процедур без записи:
+/// при настроенных db.replicas они читаются с реплики (см. Database::replicaReadAllowed).
+class DbExecutor : public QObject {
+    Q_OBJECT
+public:
+    using Callback = std::function<void(const DbResult &)>;
+
+    /// Primary — читать только с основного сервера (например, строку по свежему NOTIFY).
+    enum class ReadFrom { Any, Primary };
+
+    static DbExecutor& instance();
+
+    /// Ставит запрос в очередь. Колбэк вызывается в GUI-потоке, только если context
+    /// ещё существует и запрос не был отменён. Возвращает идентификатор запроса.
+    quint64 submit(const QString &sql, const QVariantList &binds, QObject *context, Callback cb,
+                   ReadFrom from = ReadFrom::Any);
+
+    /// То же, но запрос с ключом key вытесняет предыдущий запрос того же context
+    /// с тем же ключом (например, список отправлений при переходе к другому заданию):
+    /// старый отменяется, как при cancel(), и его результат не доставляется.
+    quint64 submitLatest(const QString &key, const QString &sql, const QVariantList &binds,
+                         QObject *context, Callback cb, ReadFrom from = ReadFrom::Any);
+
+    /// Отменяет запрос: ещё не начатый запрос не будет отправлен в БД, уже
+    /// выполняющийся прерывается на сервере (PQcancel), его результат отбрасывается.
+    void cancel(quint64 ticket);
+
+    /// Останавливает рабочий поток и закрывает его соединение.
+    void shutdown();
+
+private:
+    DbExecutor();
+    ~DbExecutor() override;
+
+    bool isPending(quint64 ticket) const;
+    void deliver(quint64 ticket, const DbResult &result);
+    quint64 enqueue(const QString &key, const QString &sql, const QVariantList &binds,
+                    QObject *context, Callback cb, ReadFrom from);
+
+    /// Рабочий поток сообщает, какой запрос сейчас выполняет сервер (cancel — дескриптор
+    /// отмены его соединения, переходит во владение исполнителя); 0 — ничего.
+    void setRunning(quint64 ticket, PGcancel *cancel);
+
+    /// Поток отмены: PQcancel открывает отдельное соединение с сервером, поэтому
+    /// отмены отправляются не из GUI-потока, а по очереди из одного потока.
+    void cancelLoop();
+    /// Ждёт, пока отправятся все поставленные отмены: отмена прежнего запроса
+    /// не должна дойти до сервера, когда он уже выполняет следующий.
+    void waitForCancels();
+    void stopCanceller();
+
+    struct Pending {
+        QPointer<QObject> context;
+        Callback callback;
+        QString key;
+    };
+    using LatestKey = QPair<QObject *, QString>;
+
+    QThread m_thread;
+    DbWorker *m_worker = nullptr;
+
+    mutable QMutex m_mutex;
+    QHash<quint64, Pending> m_pending;
+    QHash<LatestKey, quint64> m_latest;
+    quint64 m_nextTicket = 1;
+
+    // Выполняющийся запрос; отдельный мьютекс, чтобы отмена не задерживала isPending
+    QMutex m_runningMutex;
+    quint64 m_runningTicket = 0;
+    PGcancel *m_runningCancel = nullptr;
+
+    // Очередь отмен; берётся под m_runningMutex, чтобы рабочий поток, закончив
+    // запрос, уже видел его отмену в очереди
+    std::thread m_canceller;
+    std::mutex m_cancelMutex;
+    std::condition_variable m_cancelCv;
+    std::deque<PGcancel *> m_cancelQueue;
+    bool m_cancelBusy = false;
+    bool m_cancelStop = false;
+
+    friend class DbWorker;
+};
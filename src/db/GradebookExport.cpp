@@ -0,0 +1,80 @@
+#include "GradebookExport.hpp"
+#include "PgConnection.hpp"
+
+#include <QIODevice>
+#include <QStringList>
+
+namespace gradebook {
+
+// Поле CSV по правилам COPY (FORMAT csv): кавычки при разделителе, кавычке или переводе строки
+static QString csvField(const QString &value, QChar delimiter) {
+    if (!value.contains(delimiter) && !value.contains(QLatin1Char('"'))
+        && !value.contains(QLatin1Char('\n')) && !value.contains(QLatin1Char('\r'))) {
+        return value;
+    }
+    QString quoted = value;
+    quoted.replace(QLatin1Char('"'), QStringLiteral("\"\""));
+    return QLatin1Char('"') + quoted + QLatin1Char('"');
+}
+
+bool exportCsv(PgConnection &conn, int teacherId, QIODevice &out, const CsvOptions &options,
+               QString *error, qint64 *rows) {
+    const QChar delim = options.delimiter;
+    if (delim == QLatin1Char('"') || delim == QLatin1Char('\n') || delim == QLatin1Char('\r')
+        || delim == QLatin1Char('\'') || delim.unicode() > 0x7f) {
+        if (error) *error = QStringLiteral("invalid delimiter");
+        return false;
+    }
+
+    auto fail = [&](const QString &msg) {
+        if (error) *error = msg;
+        conn.exec("ROLLBACK");
+        return false;
+    };
+
+    // Заголовок и данные читаются из одного снимка: иначе новое задание
+    // между запросами сдвинуло бы столбцы
+    PgResult begin = conn.exec("BEGIN ISOLATION LEVEL REPEATABLE READ READ ONLY");
+    if (!begin.ok()) {
+        if (error) *error = begin.error();
+        return false;
+    }
+
+    PgResult cols = conn.exec("SELECT title FROM sp_gradebook_assignments($1)", {teacherId});
+    if (!cols.ok()) return fail(cols.error());
+
+    QStringList header = {QStringLiteral("Логин"), QStringLiteral("ФИО")};
+    for (int i = 0; i < cols.rows(); ++i) header << cols.value(i, 0);
+
+    QStringList fields;
+    for (const QString &h : header) fields << csvField(h, delim);
+
+    QByteArray head;
+    if (options.bom) head += "\xEF\xBB\xBF";
+    head += fields.join(delim).toUtf8();
+    head += '\n';
+    if (out.write(head) != head.size()) return fail(QStringLiteral("write failed"));
+
+    // Массив оценок раскладывается в столбцы на сервере; COPY не принимает параметры,
+    // поэтому id подставляется числом
+    QString select = QStringLiteral("SELECT g.login, g.full_name");
+    for (int i = 1; i <= cols.rows(); ++i) select += QStringLiteral(", g.grades[%1]").arg(i);
+    select += QStringLiteral(" FROM sp_gradebook(%1) g").arg(teacherId);
+
+    const QString copy = QStringLiteral("COPY (%1) TO STDOUT WITH (FORMAT csv, DELIMITER '%2')")
+                             .arg(select, QString(delim));
+
+    qint64 count = 0;
+    QString copyError;
+    const bool ok = conn.copyOut(copy, [&out, &count](const char *data, int len) {
+        ++count;
+        return out.write(data, len) == len;
+    }, &copyError);
+    if (!ok) return fail(copyError);
+
+    conn.exec("COMMIT");
+    if (rows) *rows = count;
+    return true;
+}
+
+} // namespace gradebook
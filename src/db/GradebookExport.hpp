@@ -0,0 +1,24 @@
+#pragma once
+
+#include <QChar>
+#include <QString>
+
+class QIODevice;
+class PgConnection;
+
+/// Выгрузка ведомости преподавателя (студенты × задания) в CSV. Строки приходят
+/// потоком через COPY (SELECT ... FROM sp_gradebook) TO STDOUT и сразу пишутся
+/// в out, поэтому память не растёт с размером курса.
+namespace gradebook {
+
+struct CsvOptions {
+    QChar delimiter = QLatin1Char(',');
+    /// BOM UTF-8 в начале файла, чтобы Excel распознал кодировку.
+    bool bom = false;
+};
+
+/// rows — число выгруженных студентов. Возвращает false и текст ошибки в error.
+bool exportCsv(PgConnection &conn, int teacherId, QIODevice &out, const CsvOptions &options,
+               QString *error = nullptr, qint64 *rows = nullptr);
+
+} // namespace gradebook
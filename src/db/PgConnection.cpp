@@ -0,0 +1,224 @@
+#include "PgConnection.hpp"
+#include "QueryStats.hpp"
+#include "../config/ConfigManager.hpp"
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include <vector>
+
+bool PgResult::ok() const {
+    const ExecStatusType st = status();
+    return st == PGRES_COMMAND_OK || st == PGRES_TUPLES_OK;
+}
+
+QString PgResult::error() const {
+    if (!m_res) return QStringLiteral("no result");
+    return QString::fromUtf8(PQresultErrorMessage(m_res.get())).trimmed();
+}
+
+QString PgResult::value(int row, int col) const {
+    return QString::fromUtf8(PQgetvalue(m_res.get(), row, col), PQgetlength(m_res.get(), row, col));
+}
+
+QByteArray PgResult::bytes(int row, int col) const {
+    return QByteArray(PQgetvalue(m_res.get(), row, col), PQgetlength(m_res.get(), row, col));
+}
+
+PgConnection::~PgConnection() {
+    close();
+}
+
+bool PgConnection::open() {
+    auto &cfg = ConfigManager::instance();
+    return open(cfg.dbHost(), cfg.dbPort());
+}
+
+bool PgConnection::open(const std::string &host, int port) {
+    close();
+
+    auto &cfg = ConfigManager::instance();
+    const std::string portStr = std::to_string(port);
+    const std::string dbName = cfg.dbName();
+    const std::string user = cfg.dbUser();
+    const std::string password = cfg.dbPassword();
+
+    const char *keys[] = {"host", "port", "dbname", "user", "password", "client_encoding", nullptr};
+    const char *values[] = {host.c_str(), portStr.c_str(), dbName.c_str(), user.c_str(),
+                            password.c_str(), "UTF8", nullptr};
+
+    m_conn = PQconnectdbParams(keys, values, 0);
+    if (PQstatus(m_conn) != CONNECTION_OK) {
+        qWarning() << "libpq connection failed:" << lastError();
+        return false;
+    }
+
+    PQsetNoticeReceiver(m_conn, &PgConnection::noticeReceiver, this);
+    return true;
+}
+
+void PgConnection::close() {
+    m_preparedSql.clear();
+    if (m_conn) {
+        PQfinish(m_conn);
+        m_conn = nullptr;
+    }
+}
+
+bool PgConnection::isOpen() const {
+    return m_conn && PQstatus(m_conn) == CONNECTION_OK;
+}
+
+QString PgConnection::lastError() const {
+    if (!m_conn) return QStringLiteral("not connected");
+    return QString::fromUtf8(PQerrorMessage(m_conn)).trimmed();
+}
+
+// Строки и байты ответа в QueryStats
+static void recordResult(const QString &sql, const QVariantList &params, const QElapsedTimer &timer,
+                         const PgResult &r) {
+    qint64 bytes = 0;
+    if (PGresult *res = r.get()) {
+        const int rows = PQntuples(res), cols = PQnfields(res);
+        for (int i = 0; i < rows; ++i)
+            for (int c = 0; c < cols; ++c) bytes += PQgetlength(res, i, c);
+    }
+    QueryStats::instance().record(sql, params, timer.nsecsElapsed() / 1000, r.rows(), bytes, r.ok());
+}
+
+PgResult PgConnection::exec(const QString &sql) {
+    QElapsedTimer timer;
+    timer.start();
+    PgResult r(PQexec(m_conn, sql.toUtf8().constData()));
+    recordResult(sql, {}, timer, r);
+    return r;
+}
+
+// Текстовые значения параметров; storage держит байты, пока идёт вызов libpq
+static void textParams(const QVariantList &params, std::vector<QByteArray> &storage,
+                       std::vector<const char *> &values) {
+    storage.reserve(params.size());
+    values.reserve(params.size());
+
+    for (const QVariant &p : params) {
+        if (p.isNull()) {
+            values.push_back(nullptr);
+            continue;
+        }
+        storage.push_back(p.toString().toUtf8());
+        values.push_back(storage.back().constData());
+    }
+}
+
+PgResult PgConnection::exec(const QString &sql, const QVariantList &params) {
+    std::vector<QByteArray> storage;
+    std::vector<const char *> values;
+    textParams(params, storage, values);
+
+    QElapsedTimer timer;
+    timer.start();
+    PgResult r(PQexecParams(m_conn, sql.toUtf8().constData(), static_cast<int>(values.size()),
+                            nullptr, values.data(), nullptr, nullptr, 0));
+    recordResult(sql, params, timer, r);
+    return r;
+}
+
+bool PgConnection::prepare(const QByteArray &name, const QString &sql) {
+    PgResult r(PQprepare(m_conn, name.constData(), sql.toUtf8().constData(), 0, nullptr));
+    if (!r.ok()) {
+        qWarning() << "PQprepare" << name << "failed:" << r.error();
+        return false;
+    }
+    m_preparedSql.insert(name, sql);
+    return true;
+}
+
+PgResult PgConnection::execPrepared(const QByteArray &name, const QVariantList &params) {
+    std::vector<QByteArray> storage;
+    std::vector<const char *> values;
+    textParams(params, storage, values);
+
+    QElapsedTimer timer;
+    timer.start();
+    PgResult r(PQexecPrepared(m_conn, name.constData(), static_cast<int>(values.size()),
+                              values.data(), nullptr, nullptr, 0));
+    recordResult(m_preparedSql.value(name, QString::fromLatin1(name)), params, timer, r);
+    return r;
+}
+
+bool PgConnection::copyInBegin(const QString &sql) {
+    PgResult r(PQexec(m_conn, sql.toUtf8().constData()));
+    return r.status() == PGRES_COPY_IN;
+}
+
+bool PgConnection::copyInPut(const QByteArray &data) {
+    if (data.isEmpty()) return true;
+    return PQputCopyData(m_conn, data.constData(), data.size()) == 1;
+}
+
+bool PgConnection::copyInEnd(QString *error) {
+    bool ok = PQputCopyEnd(m_conn, nullptr) == 1;
+    if (!ok && error) *error = lastError();
+
+    // Итог COPY приходит отдельным результатом
+    while (PGresult *raw = PQgetResult(m_conn)) {
+        PgResult r(raw);
+        if (r.status() != PGRES_COMMAND_OK) {
+            ok = false;
+            if (error) *error = r.error();
+        }
+    }
+    return ok;
+}
+
+bool PgConnection::copyOut(const QString &sql, const CopySink &sink, QString *error) {
+    QElapsedTimer timer;
+    timer.start();
+    qint64 rows = 0, bytes = 0;
+
+    PgResult start(PQexec(m_conn, sql.toUtf8().constData()));
+    if (start.status() != PGRES_COPY_OUT) {
+        if (error) *error = start.error();
+        return false;
+    }
+
+    bool ok = true;
+    char *buf = nullptr;
+    int len = 0;
+    // Синхронный режим: PQgetCopyData ждёт следующую строку, -1 — конец COPY
+    while ((len = PQgetCopyData(m_conn, &buf, 0)) > 0) {
+        ++rows;
+        bytes += len;
+        if (ok && !sink(buf, len)) {
+            ok = false;
+            if (error) *error = QStringLiteral("write failed");
+        }
+        PQfreemem(buf);
+    }
+    if (len == -2) {
+        ok = false;
+        if (error) *error = lastError();
+    }
+
+    while (PGresult *raw = PQgetResult(m_conn)) {
+        PgResult r(raw);
+        if (r.status() != PGRES_COMMAND_OK) {
+            ok = false;
+            if (error) *error = r.error();
+        }
+    }
+    QueryStats::instance().record(sql, {}, timer.nsecsElapsed() / 1000, rows, bytes, ok);
+    return ok;
+}
+
+void PgConnection::noticeReceiver(void *arg, const PGresult *res) {
+    auto *self = static_cast<PgConnection *>(arg);
+    const QString msg = QString::fromUtf8(PQresultErrorField(res, PG_DIAG_MESSAGE_PRIMARY));
+    if (self->m_notice) {
+        self->m_notice(msg);
+        return;
+    }
+    // Без обработчика в журнал попадают только WARNING; NOTICE и ниже отбрасываются
+    const char *severity = PQresultErrorField(res, PG_DIAG_SEVERITY_NONLOCALIZED);
+    if (severity && qstrcmp(severity, "WARNING") == 0) qWarning() << "Postgres:" << msg;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <QString>
+#include <QVariant>
+#include <QByteArray>
+#include <QHash>
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <libpq-fe.h>
+
+/// Результат libpq с автоматическим PQclear.
+class PgResult {
+public:
+    PgResult() = default;
+    explicit PgResult(PGresult *res) : m_res(res, &PQclear) {}
+
+    bool isNull() const { return !m_res; }
+    ExecStatusType status() const { return m_res ? PQresultStatus(m_res.get()) : PGRES_FATAL_ERROR; }
+    /// PGRES_COMMAND_OK или PGRES_TUPLES_OK.
+    bool ok() const;
+    QString error() const;
+
+    int rows() const { return m_res ? PQntuples(m_res.get()) : 0; }
+    int columns() const { return m_res ? PQnfields(m_res.get()) : 0; }
+    bool isNull(int row, int col) const { return PQgetisnull(m_res.get(), row, col) != 0; }
+    QString value(int row, int col) const;
+    QByteArray bytes(int row, int col) const;
+
+    PGresult *get() const { return m_res.get(); }
+
+private:
+    std::shared_ptr<PGresult> m_res;
+};
+
+/// Тонкая обёртка над соединением libpq для инструментов и путей, которым
+/// не хватает QPSQL (уведомления сервера, COPY). Не потокобезопасна.
+/// Вызовы exec/execPrepared/copyOut замеряются в QueryStats.
+class PgConnection {
+public:
+    using NoticeHandler = std::function<void(const QString &)>;
+    /// Получатель данных COPY TO STDOUT; false прерывает запись (остаток читается вхолостую).
+    using CopySink = std::function<bool(const char *data, int len)>;
+
+    PgConnection() = default;
+    ~PgConnection();
+
+    PgConnection(const PgConnection &) = delete;
+    PgConnection &operator=(const PgConnection &) = delete;
+
+    /// Подключается с параметрами db из ConfigManager.
+    bool open();
+    bool open(const std::string &host, int port);
+    void close();
+
+    bool isOpen() const;
+    QString lastError() const;
+    PGconn *handle() const { return m_conn; }
+
+    /// Простой протокол: допускает несколько команд через ';', без параметров.
+    PgResult exec(const QString &sql);
+    /// Расширенный протокол; параметры передаются текстом, null QVariant — NULL.
+    PgResult exec(const QString &sql, const QVariantList &params);
+
+    /// Именованный серверный подготовленный запрос (PQprepare / PQexecPrepared).
+    bool prepare(const QByteArray &name, const QString &sql);
+    PgResult execPrepared(const QByteArray &name, const QVariantList &params);
+
+    /// COPY ... FROM STDIN: copyInBegin, затем данные кусками в текстовом формате COPY,
+    /// copyInEnd возвращает итог всей команды.
+    bool copyInBegin(const QString &sql);
+    bool copyInPut(const QByteArray &data);
+    bool copyInEnd(QString *error = nullptr);
+
+    /// COPY ... TO STDOUT: строки отдаются в sink по мере прихода, без накопления в памяти.
+    bool copyOut(const QString &sql, const CopySink &sink, QString *error = nullptr);
+
+    /// Сообщения сервера уровня NOTICE/WARNING (RAISE NOTICE, auto_explain и т.п.).
+    /// Без обработчика WARNING пишется в qWarning, остальное отбрасывается.
+    void setNoticeHandler(NoticeHandler handler) { m_notice = std::move(handler); }
+
+private:
+    static void noticeReceiver(void *arg, const PGresult *res);
+
+    PGconn *m_conn = nullptr;
+    NoticeHandler m_notice;
+    // Текст подготовленных запросов по имени — для QueryStats
+    QHash<QByteArray, QString> m_preparedSql;
+};
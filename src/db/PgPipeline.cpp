@@ -0,0 +1,299 @@
+#include "PgPipeline.hpp"
+#include "QueryStats.hpp"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QtEndian>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+#include <poll.h>
+
+// OID встроенных типов (pg_type.dat); catalog/pg_type_d.h в клиентских пакетах есть не всегда
+static constexpr Oid kBoolOid = 16;
+static constexpr Oid kInt8Oid = 20;
+static constexpr Oid kInt4Oid = 23;
+static constexpr Oid kFloat8Oid = 701;
+
+static Oid binaryType(const QVariant &v) {
+    switch (v.type()) {
+    case QVariant::Bool: return kBoolOid;
+    case QVariant::Int: return kInt4Oid;
+    case QVariant::LongLong: return kInt8Oid;
+    case QVariant::Double: return kFloat8Oid;
+    default: return 0;
+    }
+}
+
+// Значение в двоичном формате типа oid (сетевой порядок байт)
+static QByteArray binaryValue(const QVariant &v, Oid oid) {
+    QByteArray out;
+    switch (oid) {
+    case kBoolOid:
+        out.append(v.toBool() ? '\1' : '\0');
+        break;
+    case kInt4Oid:
+        out.resize(4);
+        qToBigEndian<qint32>(v.toInt(), out.data());
+        break;
+    case kInt8Oid:
+        out.resize(8);
+        qToBigEndian<qint64>(v.toLongLong(), out.data());
+        break;
+    case kFloat8Oid: {
+        const double d = v.toDouble();
+        quint64 bits;
+        std::memcpy(&bits, &d, sizeof(bits));
+        out.resize(8);
+        qToBigEndian<quint64>(bits, out.data());
+        break;
+    }
+    }
+    return out;
+}
+
+void PgPipeline::add(const QString &sql, const QVariantList &params) {
+    m_calls.push_back(Call{statementFor(sql, params), params});
+}
+
+// Типы параметров фиксируются при первой подготовке: двоичными потом передаются
+// только значения того же типа, остальные — текстом с выводом типа на сервере
+int PgPipeline::statementFor(const QString &sql, const QVariantList &params) {
+    const auto it = m_statementIndex.constFind(sql);
+    if (it != m_statementIndex.constEnd()) return it.value();
+
+    static std::atomic<int> seq{0};
+    Statement st;
+    st.name = "edudesk_pl_" + QByteArray::number(++seq);
+    st.sql = sql;
+    st.types.reserve(params.size());
+    for (const QVariant &p : params) st.types.push_back(p.isNull() ? 0 : binaryType(p));
+
+    m_statements.push_back(std::move(st));
+    const int index = static_cast<int>(m_statements.size()) - 1;
+    m_statementIndex.insert(sql, index);
+    return index;
+}
+
+bool PgPipeline::run(QList<PgResult> *results, QString *error) {
+    QList<PgResult> out;
+    bool ok = true;
+    if (!m_calls.empty()) {
+        QElapsedTimer timer;
+        timer.start();
+#ifdef LIBPQ_HAS_PIPELINING
+        ok = runPipelined(out, error);
+#else
+        ok = runSequential(out, error);
+#endif
+        // Пакет — одна запись: задержка отдельных вызовов внутри конвейера не определена
+        QueryStats::instance().record(QStringLiteral("PIPELINE"), {}, timer.nsecsElapsed() / 1000,
+                                      static_cast<qint64>(m_calls.size()), -1, ok);
+    }
+    m_calls.clear();
+    if (results) *results = std::move(out);
+    return ok;
+}
+
+bool PgPipeline::runSequential(QList<PgResult> &out, QString *error) {
+    bool ok = true;
+    for (const Call &call : m_calls) {
+        Statement &st = m_statements[call.statement];
+        if (!st.prepared) st.prepared = m_conn.prepare(st.name, st.sql);
+
+        PgResult r = st.prepared ? m_conn.execPrepared(st.name, call.params) : m_conn.exec(st.sql, call.params);
+        if (ok && !r.ok()) {
+            ok = false;
+            if (error) *error = r.error();
+        }
+        out.append(r);
+    }
+    return ok;
+}
+
+#ifdef LIBPQ_HAS_PIPELINING
+
+namespace {
+
+// Что сервер вернёт в ответ на очередной отправленный элемент конвейера
+struct Expect {
+    enum Kind { Prepare, Query, Sync } kind;
+    int call = -1;        // индекс в out для Query
+    int statement = -1;   // для Prepare: чей статус подготовки
+    bool gotResult = false;
+};
+
+bool waitSocket(PGconn *conn, bool forWrite) {
+    pollfd pfd{};
+    pfd.fd = PQsocket(conn);
+    pfd.events = POLLIN | (forWrite ? POLLOUT : 0);
+    int rc;
+    do {
+        rc = ::poll(&pfd, 1, -1);
+    } while (rc < 0 && errno == EINTR);
+    return rc > 0;
+}
+
+} // namespace
+
+bool PgPipeline::runPipelined(QList<PgResult> &out, QString *error) {
+    PGconn *conn = m_conn.handle();
+    auto fail = [&](const QString &msg) {
+        if (error && !msg.isEmpty()) *error = msg;
+        return false;
+    };
+
+    if (PQpipelineStatus(conn) != PQ_PIPELINE_OFF || !PQenterPipelineMode(conn))
+        return fail(m_conn.lastError());
+    // В неблокирующем режиме отправка не зависает, пока сервер ждёт, что мы прочтём
+    // его ответы: при заполненном буфере сокета вычитываем входящие и повторяем
+    PQsetnonblocking(conn, 1);
+
+    std::vector<Expect> expected;
+    expected.reserve(m_calls.size() + 2);
+    std::size_t next = 0;
+    bool ok = true;
+    bool broken = false;
+    QString firstError;
+
+    for (int i = 0; i < static_cast<int>(m_calls.size()); ++i) out.append(PgResult());
+
+    auto noteError = [&](const PgResult &r) {
+        if (r.status() == PGRES_FATAL_ERROR && firstError.isEmpty()) firstError = r.error();
+        ok = false;
+    };
+
+    // Забирает все уже пришедшие результаты, не блокируясь
+    auto collect = [&]() {
+        while (next < expected.size() && !PQisBusy(conn)) {
+            Expect &e = expected[next];
+            PGresult *raw = PQgetResult(conn);
+
+            if (e.kind == Expect::Sync) {
+                if (!raw) break;
+                PgResult r(raw);
+                if (r.status() == PGRES_PIPELINE_SYNC) ++next;
+                else noteError(r);
+                continue;
+            }
+
+            if (!raw) {
+                // NULL завершает ответ на очередной элемент
+                if (!e.gotResult) {
+                    broken = true;
+                    return;
+                }
+                ++next;
+                continue;
+            }
+
+            PgResult r(raw);
+            e.gotResult = true;
+            if (!r.ok()) {
+                noteError(r);
+                if (e.kind == Expect::Prepare) m_statements[e.statement].prepared = false;
+            }
+            if (e.kind == Expect::Query) out[e.call] = r;
+        }
+    };
+
+    auto flush = [&]() {
+        for (;;) {
+            const int rc = PQflush(conn);
+            if (rc == 0) return true;
+            if (rc < 0 || !waitSocket(conn, true) || !PQconsumeInput(conn)) return false;
+            collect();
+        }
+    };
+
+    std::vector<QByteArray> storage;
+    std::vector<const char *> values;
+    std::vector<int> lengths;
+    std::vector<int> formats;
+
+    bool sent = true;
+    for (int i = 0; i < static_cast<int>(m_calls.size()) && sent; ++i) {
+        const Call &call = m_calls[i];
+        Statement &st = m_statements[call.statement];
+
+        if (!st.prepared) {
+            sent = PQsendPrepare(conn, st.name.constData(), st.sql.toUtf8().constData(),
+                                 static_cast<int>(st.types.size()), st.types.data()) == 1;
+            if (!sent) break;
+            st.prepared = true;
+            expected.push_back(Expect{Expect::Prepare, -1, call.statement, false});
+        }
+
+        const int n = call.params.size();
+        storage.clear();
+        storage.reserve(n);
+        values.assign(n, nullptr);
+        lengths.assign(n, 0);
+        formats.assign(n, 0);
+        for (int k = 0; k < n; ++k) {
+            const QVariant &p = call.params[k];
+            if (p.isNull()) continue;
+            const Oid oid = k < static_cast<int>(st.types.size()) ? st.types[k] : 0;
+            if (oid != 0 && binaryType(p) == oid) {
+                storage.push_back(binaryValue(p, oid));
+                formats[k] = 1;
+            } else {
+                storage.push_back(p.toString().toUtf8());
+            }
+            values[k] = storage.back().constData();
+            lengths[k] = storage.back().size();
+        }
+
+        sent = PQsendQueryPrepared(conn, st.name.constData(), n, values.data(), lengths.data(),
+                                   formats.data(), 0) == 1;
+        if (!sent) break;
+        expected.push_back(Expect{Expect::Query, i, -1, false});
+
+        // Не копим весь пакет в памяти клиента: отдаём, как только libpq готова
+        if (PQflush(conn) < 0 || !PQconsumeInput(conn)) sent = false;
+        else collect();
+    }
+
+    if (sent && PQpipelineSync(conn) == 1) {
+        expected.push_back(Expect{Expect::Sync});
+        sent = flush();
+    } else {
+        sent = false;
+    }
+
+    if (!sent) {
+        // Соединение в неизвестном состоянии: сбрасываем его, иначе следующий
+        // запрос получит чужие ответы
+        qWarning() << "Pipeline send failed:" << m_conn.lastError();
+        firstError = m_conn.lastError();
+        PQreset(conn);
+        for (Statement &st : m_statements) st.prepared = false;
+        PQsetnonblocking(conn, 0);
+        return fail(firstError);
+    }
+
+    while (next < expected.size() && !broken) {
+        collect();
+        if (next >= expected.size() || broken) break;
+        if (!waitSocket(conn, false) || !PQconsumeInput(conn)) {
+            broken = true;
+            break;
+        }
+    }
+
+    if (broken) {
+        firstError = m_conn.lastError();
+        PQreset(conn);
+        for (Statement &st : m_statements) st.prepared = false;
+        PQsetnonblocking(conn, 0);
+        return fail(firstError);
+    }
+
+    PQexitPipelineMode(conn);
+    PQsetnonblocking(conn, 0);
+    return ok || fail(firstError);
+}
+
+#endif
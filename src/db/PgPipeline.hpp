@@ -0,0 +1,57 @@
+#pragma once
+
+#include "PgConnection.hpp"
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVariantList>
+
+#include <vector>
+
+/// Пакетное выполнение мелких вызовов через конвейер libpq (pipeline mode, libpq 14+):
+/// все вызовы пакета уходят на сервер подряд, без ожидания ответа на каждый, и
+/// стоят одного сетевого круга вместо N. Каждый текст sql готовится на сервере один
+/// раз за жизнь объекта; целые, bool и double передаются в двоичном формате.
+///
+/// Вызовы пакета не объединяются в транзакцию: ошибка одного прерывает остаток
+/// пакета (PGRES_PIPELINE_ABORTED), но уже выполненные остаются в силе. Если нужна
+/// атомарность, добавьте BEGIN/COMMIT первым и последним вызовом.
+/// Без поддержки конвейера в libpq вызовы выполняются по одному.
+class PgPipeline {
+public:
+    explicit PgPipeline(PgConnection &conn) : m_conn(conn) {}
+
+    PgPipeline(const PgPipeline &) = delete;
+    PgPipeline &operator=(const PgPipeline &) = delete;
+
+    /// Ставит вызов в текущий пакет; плейсхолдеры $1, $2, ...
+    void add(const QString &sql, const QVariantList &params = {});
+    int pending() const { return static_cast<int>(m_calls.size()); }
+
+    /// Отправляет пакет и ждёт все результаты. results — в порядке add; false и
+    /// первая ошибка сервера в error, если хотя бы один вызов не выполнен.
+    /// Пакет очищается в любом случае.
+    bool run(QList<PgResult> *results = nullptr, QString *error = nullptr);
+
+private:
+    struct Statement {
+        QByteArray name;
+        QString sql;
+        std::vector<Oid> types;
+        bool prepared = false;
+    };
+    struct Call {
+        int statement;
+        QVariantList params;
+    };
+
+    int statementFor(const QString &sql, const QVariantList &params);
+    bool runSequential(QList<PgResult> &out, QString *error);
+    bool runPipelined(QList<PgResult> &out, QString *error);
+
+    PgConnection &m_conn;
+    std::vector<Statement> m_statements;
+    QHash<QString, int> m_statementIndex;
+    std::vector<Call> m_calls;
+};
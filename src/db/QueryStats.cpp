@@ -0,0 +1,174 @@
+#include "QueryStats.hpp"
+#include "../config/ConfigManager.hpp"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QStringList>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cmath>
+
+// Позиции параметров с хешем пароля и солью (0-based)
+static const QHash<QString, QList<int>> &secretParams() {
+    static const QHash<QString, QList<int>> table = {
+        {QStringLiteral("sp_register_user"), {2, 3}},
+        {QStringLiteral("sp_admin_create_user"), {4, 5}},
+    };
+    return table;
+}
+
+// Хеши и соли передаются hex-строками: маскируем и в процедурах не из таблицы
+static bool looksLikeSecret(const QString &value) {
+    static const QRegularExpression hex(QStringLiteral("^[0-9a-fA-F]{32,}$"));
+    return value.size() >= 32 && hex.match(value).hasMatch();
+}
+
+static int bucketFor(qint64 us) {
+    int b = 0;
+    while (b < QueryStats::kBuckets - 1 && us >= (qint64(2) << b)) ++b;
+    return b;
+}
+
+qint64 QueryStats::Entry::percentileUs(double q) const {
+    if (calls == 0) return 0;
+    const quint64 target = static_cast<quint64>(std::ceil(q * static_cast<double>(calls)));
+    quint64 seen = 0;
+    for (int b = 0; b < kBuckets; ++b) {
+        seen += buckets[b];
+        if (seen >= target) return std::min(qint64(2) << b, maxUs);
+    }
+    return maxUs;
+}
+
+QueryStats &QueryStats::instance() {
+    static QueryStats inst;
+    return inst;
+}
+
+QString QueryStats::procedureName(const QString &sql) {
+    static const QRegularExpression proc(QStringLiteral("\\b(sp_[A-Za-z0-9_]+)\\s*\\("));
+    const auto m = proc.match(sql);
+    if (m.hasMatch()) return m.captured(1);
+
+    const QString trimmed = sql.trimmed();
+    const int space = trimmed.indexOf(QRegularExpression(QStringLiteral("\\s")));
+    return (space < 0 ? trimmed : trimmed.left(space)).toUpper();
+}
+
+QString QueryStats::redactedParams(const QString &name, const QVariantList &binds) {
+    const QList<int> secret = secretParams().value(name);
+    QStringList parts;
+    for (int i = 0; i < binds.size(); ++i) {
+        const QVariant &v = binds[i];
+        if (v.isNull()) {
+            parts << QStringLiteral("NULL");
+            continue;
+        }
+        const QString s = v.toString();
+        if (secret.contains(i) || looksLikeSecret(s)) {
+            parts << QStringLiteral("<redacted>");
+        } else {
+            // Длинные описания и массивы в журнале не нужны целиком
+            parts << (s.size() > 200 ? s.left(200) + QStringLiteral("…") : s);
+        }
+    }
+    return QLatin1Char('[') + parts.join(QStringLiteral(", ")) + QLatin1Char(']');
+}
+
+void QueryStats::record(const QString &sql, const QVariantList &binds, qint64 elapsedUs,
+                        qint64 rows, qint64 bytes, bool ok) {
+    const QString name = procedureName(sql);
+    {
+        QMutexLocker lock(&m_mutex);
+        Entry &e = m_entries[name];
+        if (e.name.isEmpty()) e.name = name;
+        ++e.calls;
+        if (!ok) ++e.errors;
+        if (rows > 0) e.rows += rows;
+        if (bytes > 0) e.bytes += bytes;
+        e.totalUs += elapsedUs;
+        e.maxUs = std::max(e.maxUs, elapsedUs);
+        ++e.buckets[bucketFor(elapsedUs)];
+    }
+
+    const int slowMs = ConfigManager::instance().slowQueryMs();
+    if (slowMs > 0 && elapsedUs >= qint64(slowMs) * 1000) logSlow(name, binds, elapsedUs, rows, ok);
+}
+
+void QueryStats::logSlow(const QString &name, const QVariantList &binds, qint64 elapsedUs, qint64 rows, bool ok) {
+    QMutexLocker lock(&m_slowMutex);
+    if (!m_slowLog.isOpen()) {
+        QDir().mkpath(QStringLiteral("logs"));
+        m_slowLog.setFileName(QStringLiteral("logs/slow_queries.log"));
+        if (!m_slowLog.open(QIODevice::Append | QIODevice::Text)) return;
+    }
+
+    QTextStream out(&m_slowLog);
+    out << QDateTime::currentDateTime().toString(Qt::ISODateWithMs)
+        << " | " << QString::number(elapsedUs / 1000.0, 'f', 1) << " ms"
+        << " | " << name
+        << " | rows:" << (rows >= 0 ? QString::number(rows) : QStringLiteral("?"))
+        << (ok ? "" : " | error")
+        << " | params:" << redactedParams(name, binds) << "\n";
+    out.flush();
+}
+
+QList<QueryStats::Entry> QueryStats::snapshot() const {
+    QMutexLocker lock(&m_mutex);
+    return m_entries.values();
+}
+
+void QueryStats::recordStatementCache(bool hit) {
+    (hit ? m_cacheHits : m_cacheMisses).fetch_add(1, std::memory_order_relaxed);
+}
+
+QString QueryStats::report() const {
+    QList<Entry> entries = snapshot();
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+        return a.totalUs > b.totalUs;
+    });
+
+    auto ms = [](qint64 us) { return QString::number(us / 1000.0, 'f', 1); };
+    QString text = QStringLiteral("%1%2%3%4%5%6%7%8%9")
+                       .arg(QStringLiteral("procedure"), -40)
+                       .arg(QStringLiteral("calls"), 9).arg(QStringLiteral("errors"), 9)
+                       .arg(QStringLiteral("p50 ms"), 9).arg(QStringLiteral("p95 ms"), 9)
+                       .arg(QStringLiteral("p99 ms"), 9).arg(QStringLiteral("max ms"), 9)
+                       .arg(QStringLiteral("total ms"), 11).arg(QStringLiteral("rows / bytes"), 24)
+                 + QLatin1Char('\n');
+    for (const Entry &e : entries) {
+        text += QStringLiteral("%1%2%3%4%5%6%7%8%9")
+                    .arg(e.name, -40)
+                    .arg(e.calls, 9).arg(e.errors, 9)
+                    .arg(ms(e.percentileUs(0.50)), 9).arg(ms(e.percentileUs(0.95)), 9)
+                    .arg(ms(e.percentileUs(0.99)), 9).arg(ms(e.maxUs), 9)
+                    .arg(ms(e.totalUs), 11)
+                    .arg(QStringLiteral("%1 / %2").arg(e.rows).arg(e.bytes), 24)
+              + QLatin1Char('\n');
+    }
+
+    const quint64 hits = m_cacheHits.load(std::memory_order_relaxed);
+    const quint64 misses = m_cacheMisses.load(std::memory_order_relaxed);
+    if (hits + misses > 0) {
+        text += QStringLiteral("\nstatement cache: hits %1, misses %2, hit rate %3%\n")
+                    .arg(hits).arg(misses)
+                    .arg(QString::number(100.0 * static_cast<double>(hits) / static_cast<double>(hits + misses), 'f', 1));
+    }
+    return text;
+}
+
+bool QueryStats::writeReport(const QString &path) const {
+    const QString text = report();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QSaveFile f(path);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+    f.write(QDateTime::currentDateTime().toString(Qt::ISODate).toUtf8() + "\n");
+    f.write(text.toUtf8());
+    return f.commit();
+}
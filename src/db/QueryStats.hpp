@@ -0,0 +1,68 @@
+#pragma once
+
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QVariantList>
+
+#include <array>
+#include <atomic>
+
+/// Замеры вызовов БД по имени процедуры: гистограмма задержек (корзины по степеням
+/// двойки в микросекундах), строки и байты ответа. Вызовы дольше db.slow_query_ms
+/// пишутся в logs/slow_queries.log с параметрами; хеши паролей и соли маскируются.
+/// Потокобезопасен: пишут GUI-поток, рабочий поток DbExecutor и инструменты.
+class QueryStats {
+public:
+    /// Корзина i: [2^i, 2^(i+1)) мкс; последняя — всё, что дольше ~8.4 с.
+    static constexpr int kBuckets = 24;
+
+    struct Entry {
+        QString name;
+        quint64 calls = 0;
+        quint64 errors = 0;
+        qint64 rows = 0;
+        qint64 bytes = 0;
+        qint64 totalUs = 0;
+        qint64 maxUs = 0;
+        std::array<quint64, kBuckets> buckets{};
+
+        /// Верхняя граница корзины, в которую попадает квантиль q (0..1), мкс.
+        qint64 percentileUs(double q) const;
+    };
+
+    static QueryStats &instance();
+
+    /// rows/bytes < 0 — неизвестно (не учитываются).
+    void record(const QString &sql, const QVariantList &binds, qint64 elapsedUs,
+                qint64 rows, qint64 bytes, bool ok);
+
+    /// Обращение к кэшу подготовленных запросов (StatementCache) любого соединения.
+    void recordStatementCache(bool hit);
+
+    QList<Entry> snapshot() const;
+    /// Таблица по процедурам, самые затратные по суммарному времени — сверху.
+    QString report() const;
+    bool writeReport(const QString &path) const;
+
+    /// "SELECT * FROM sp_x(?)" -> "sp_x"; без процедуры — первое слово запроса.
+    static QString procedureName(const QString &sql);
+    /// Параметры для журнала: секретные позиции и hex-строки длиной от 32 — "<redacted>".
+    static QString redactedParams(const QString &name, const QVariantList &binds);
+
+private:
+    QueryStats() = default;
+
+    void logSlow(const QString &name, const QVariantList &binds, qint64 elapsedUs, qint64 rows, bool ok);
+
+    mutable QMutex m_mutex;
+    QHash<QString, Entry> m_entries;
+
+    std::atomic<quint64> m_cacheHits{0};
+    std::atomic<quint64> m_cacheMisses{0};
+
+    QMutex m_slowMutex;
+    QFile m_slowLog;
+};
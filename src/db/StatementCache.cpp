@@ -0,0 +1,46 @@
+#include "StatementCache.hpp"
+#include "QueryStats.hpp"
+
+#include <QSqlError>
+#include <QDebug>
+
+StatementCache::StatementCache(const QSqlDatabase &db)
+    : m_db(db) {}
+
+void StatementCache::setDatabase(const QSqlDatabase &db) {
+    clear();
+    m_db = db;
+}
+
+QSqlQuery StatementCache::prepare(const QString &sql) {
+    auto it = m_queries.constFind(sql);
+    if (it != m_queries.constEnd()) {
+        ++m_hits;
+        QueryStats::instance().recordStatementCache(true);
+        QSqlQuery q = *it.value();
+        q.finish();
+        return q;
+    }
+
+    ++m_misses;
+    QueryStats::instance().recordStatementCache(false);
+    auto q = QSharedPointer<QSqlQuery>::create(m_db);
+    q->setForwardOnly(true);
+    if (!q->prepare(sql)) {
+        // Неудачный prepare не кэшируем: ошибка вернётся из exec() вызывающему
+        qWarning() << "Statement prepare failed:" << q->lastError().text();
+        return *q;
+    }
+
+    m_queries.insert(sql, q);
+    return *q;
+}
+
+void StatementCache::clear() {
+    m_queries.clear();
+}
+
+double StatementCache::hitRate() const {
+    const quint64 total = m_hits + m_misses;
+    return total == 0 ? 0.0 : static_cast<double>(m_hits) / static_cast<double>(total);
+}
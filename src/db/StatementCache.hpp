@@ -0,0 +1,34 @@
+#pragma once
+
+#include <QString>
+#include <QHash>
+#include <QSharedPointer>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+
+/// Кэш серверных подготовленных запросов одного соединения, ключ — текст SQL.
+/// Повторный вызов с тем же SQL только привязывает параметры и выполняет запрос,
+/// без PREPARE/DEALLOCATE на каждый вызов. Не потокобезопасен: один кэш — одно соединение.
+class StatementCache {
+public:
+    StatementCache() = default;
+    explicit StatementCache(const QSqlDatabase &db);
+
+    void setDatabase(const QSqlDatabase &db);
+
+    /// Возвращает подготовленный запрос (общий с кэшем дескриптор QSqlQuery).
+    /// Все параметры нужно привязать и выполнить запрос до следующего вызова с тем же SQL.
+    QSqlQuery prepare(const QString &sql);
+
+    void clear();
+
+    quint64 hits() const { return m_hits; }
+    quint64 misses() const { return m_misses; }
+    double hitRate() const;
+
+private:
+    QSqlDatabase m_db;
+    QHash<QString, QSharedPointer<QSqlQuery>> m_queries;
+    quint64 m_hits = 0;
+    quint64 m_misses = 0;
+};
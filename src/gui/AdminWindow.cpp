@@ -1,5 +1,8 @@
 #include "AdminWindow.hpp"
+#include "UserModel.hpp"
+#include "SortFilterModel.hpp"
 #include "../db/Database.hpp"
+#include "../db/DbExecutor.hpp"
 #include "../auth/AuthManager.hpp"
 #include "../utils/Logger.hpp"
 
@@ -10,13 +13,16 @@
 #include <QInputDialog>
 #include <QMessageBox>
 #include <QLabel>
+#include <QLineEdit>
 #include <QHeaderView>
-#include <QTableWidgetItem>
+#include <QScrollBar>
 #include <QDebug>
 
 #include "../auth/PasswordUtils.hpp"
 #include "../config/ConfigManager.hpp"
 
+static const int kPrefetchRows = 20;
+
 AdminWindow::AdminWindow(int adminId, QWidget *parent)
     : QWidget(parent), m_adminId(adminId)
 {
@@ -26,13 +32,34 @@ AdminWindow::AdminWindow(int adminId, QWidget *parent)
     auto v = new QVBoxLayout(this);
 
     // Таблица пользователей: ID, Login, Full name, Role
-    tblUsers = new QTableWidget(this);
-    tblUsers->setColumnCount(3);
-    tblUsers->setHorizontalHeaderLabels({"Login", "Full name", "Role"});
+    m_users = new UserModel(m_adminId, this);
+    connect(m_users, &DbListModel::pageLoaded, this, [this](bool first) {
+        if (first) tblUsers->resizeColumnsToContents();
+    });
+    connect(m_users, &DbListModel::loadFailed, this, [this](const QString &error) {
+        showError("Не удалось загрузить пользователей: " + error);
+    });
+
+    // Сортировка по заголовку и фильтр считаются в фоне; до первого щелчка — порядок по id
+    m_usersProxy = new SortFilterModel(m_users, this);
+
+    edUsersFilter = new QLineEdit(this);
+    edUsersFilter->setPlaceholderText("Фильтр по логину или ФИО");
+    edUsersFilter->setClearButtonEnabled(true);
+    connect(edUsersFilter, &QLineEdit::textChanged, m_usersProxy, &SortFilterModel::setFilterText);
+
+    tblUsers = new QTableView(this);
+    tblUsers->setModel(m_usersProxy);
     tblUsers->setSelectionBehavior(QAbstractItemView::SelectRows);
     tblUsers->setEditTriggers(QAbstractItemView::NoEditTriggers);
     tblUsers->horizontalHeader()->setStretchLastSection(true);
+    tblUsers->horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+    tblUsers->setSortingEnabled(true);
+    connect(tblUsers->verticalScrollBar(), &QScrollBar::valueChanged, this, [this](int value) {
+        if (value >= tblUsers->verticalScrollBar()->maximum() - kPrefetchRows) m_users->fetchMore(QModelIndex());
+    });
     v->addWidget(new QLabel("Пользователи:"));
+    v->addWidget(edUsersFilter);
     v->addWidget(tblUsers, 1);
 
     // Панель кнопок для работы с пользователями
@@ -67,37 +94,9 @@ void AdminWindow::showError(const QString &text) {
     QMessageBox::warning(this, "Ошибка", text);
 }
 
+// Загрузка пользователей без привязки к группам, постранично по id
 void AdminWindow::loadUsers() {
-    tblUsers->setRowCount(0);
-    QSqlQuery q(Database::instance().get());
-
-    // Загрузка пользователей без привязки к группам
-    q.prepare("SELECT * FROM sp_admin_list_users(?)");
-    q.addBindValue(m_adminId);
-    if (!q.exec()) {
-        showError("Не удалось загрузить пользователей: " + q.lastError().text());
-        return;
-    }
-
-    int r = 0;
-    while (q.next()) {
-        const int uid = q.value(0).toInt();
-        const QString login = q.value(1).toString();
-        const QString full  = q.value(2).toString();
-        const QString role  = q.value(3).toString();
-
-        tblUsers->insertRow(r);
-
-        auto *loginItem = new QTableWidgetItem(login);
-        loginItem->setData(Qt::UserRole, uid);   // id НЕ отображаем, храним как metadata
-        tblUsers->setItem(r, 0, loginItem);
-
-        tblUsers->setItem(r, 1, new QTableWidgetItem(full));
-        tblUsers->setItem(r, 2, new QTableWidgetItem(role));
-
-        ++r;
-    }
-    tblUsers->resizeColumnsToContents();
+    m_users->reload();
 }
 
 void AdminWindow::onCreateUser() {
@@ -132,8 +131,7 @@ void AdminWindow::onCreateUser() {
 
     auto pw = auth::createPasswordHash(pwd.toStdString(), iters);
 
-    QSqlQuery q(Database::instance().get());
-    q.prepare("SELECT sp_admin_create_user(?, ?, ?, ?, ?, ?)");
+    QSqlQuery q = Database::instance().prepared("SELECT sp_admin_create_user(?, ?, ?, ?, ?, ?)");
     q.addBindValue(m_adminId);
     q.addBindValue(login);
     q.addBindValue(role);
@@ -141,56 +139,48 @@ void AdminWindow::onCreateUser() {
     q.addBindValue(QString::fromStdString(auth::toHex(pw.hash)));
     q.addBindValue(QString::fromStdString(auth::toHex(pw.salt)));
 
-    if (!q.exec() || !q.next()) {
+    if (!Database::exec(q) || !q.next()) {
         showError("Не удалось создать пользователя (возможно логин занят)");
         return;
     }
 
     int newUserId = q.value(0).toInt();
+    Database::instance().noteWrite();
 
     Logger::log(m_adminId, "create_user",
-                QString("id=%1 login=%2 role=%3").arg(newUserId).arg(login).arg(role));
-    loadUsers();
+                QString("id=%1 login=%2 role=%3").arg(newUserId).arg(login).arg(role), Logger::FileOnly);
+
+    // Список упорядочен по id: новый пользователь — последний. Если догружены
+    // ещё не все страницы, он появится при прокрутке сам.
+    if (!m_users->hasMore() && !m_users->isLoading()) m_users->upsert(DbRow{newUserId, login, full, role});
     QMessageBox::information(this, "OK", "Пользователь создан");
 }
 
 void AdminWindow::onToggleActive() {
-    auto sel = tblUsers->selectedItems();
-    if (sel.isEmpty()) {
-        showError("Выберите пользователя");
-        return;
-    }
     int uid = selectedUserId();
     if (uid < 0) { showError("Выберите пользователя"); return; }
 
-    QSqlQuery q(Database::instance().get());
-    q.prepare("SELECT sp_admin_toggle_user_active(?, ?)");
+    QSqlQuery q = Database::instance().prepared("SELECT * FROM sp_admin_toggle_user_active(?, ?)");
     q.addBindValue(m_adminId);
     q.addBindValue(uid);
-    if (!q.exec()) {
+    if (!Database::exec(q)) {
         showError("Не удалось обновить статус: " + q.lastError().text());
         return;
     }
 
-    q.next();
+    Database::instance().noteWrite();
+    if (q.next() && m_users->findRow(uid) >= 0) m_users->upsert(dbRowFromQuery(q));
 
-    Logger::log(m_adminId, "toggle_active", QString("user_id=%1").arg(uid));
-    loadUsers();
+    Logger::log(m_adminId, "toggle_active", QString("user_id=%1").arg(uid), Logger::FileOnly);
 }
 
 void AdminWindow::onEditUser() {
-    auto sel = tblUsers->selectedItems();
-    if (sel.isEmpty()) {
-        showError("Выберите пользователя");
-        return;
-    }
     int uid = selectedUserId();
     if (uid < 0) { showError("Выберите пользователя"); return; }
-    QSqlQuery q(Database::instance().get());
-    q.prepare("SELECT * FROM sp_admin_get_user(?, ?)");
+    QSqlQuery q = Database::instance().prepared("SELECT * FROM sp_admin_get_user(?, ?)");
     q.addBindValue(m_adminId);
     q.addBindValue(uid);
-    if (!q.exec() || !q.next()) {
+    if (!Database::exec(q) || !q.next()) {
         showError("Пользователь не найден");
         return;
     }
@@ -207,21 +197,20 @@ void AdminWindow::onEditUser() {
                                             QLineEdit::Normal, role, &ok);
     if (!ok) return;
 
-    QSqlQuery uq(Database::instance().get());
-    uq.prepare("SELECT sp_admin_update_user(?, ?, ?, ?)");
+    QSqlQuery uq = Database::instance().prepared("SELECT * FROM sp_admin_update_user(?, ?, ?, ?)");
     uq.addBindValue(m_adminId);
     uq.addBindValue(uid);
     uq.addBindValue(newFull);
     uq.addBindValue(newRole);
-    if (!uq.exec()) {
+    if (!Database::exec(uq)) {
         showError("Не удалось обновить пользователя: " + uq.lastError().text());
         return;
     }
 
-    uq.next();
+    Database::instance().noteWrite();
+    if (uq.next() && m_users->findRow(uid) >= 0) m_users->upsert(dbRowFromQuery(uq));
 
-    Logger::log(m_adminId, "edit_user", QString("user_id=%1 login=%2").arg(uid).arg(login));
-    loadUsers();
+    Logger::log(m_adminId, "edit_user", QString("user_id=%1 login=%2").arg(uid).arg(login), Logger::FileOnly);
     QMessageBox::information(this, "OK", "Пользователь изменён");
 }
 
@@ -230,18 +219,10 @@ void AdminWindow::onRefresh() {
 }
 
 void AdminWindow::onDeleteUser() {
-    auto sel = tblUsers->selectedItems();
-    if (sel.isEmpty()) {
-        showError("Выберите пользователя");
-        return;
-    }
-    int row = tblUsers->currentRow();
-    if (row < 0) { showError("Выберите пользователя"); return; }
-
     int userId = selectedUserId();
     if (userId < 0) { showError("Выберите пользователя"); return; }
 
-    QString login = tblUsers->item(row, 0)->text(); // login в 0-й колонке
+    const QString login = m_users->rowAt(m_usersProxy->sourceRow(tblUsers->currentIndex().row())).login;
 
     if (QMessageBox::question(this, "Удалить пользователя",
                               QString("Удалить пользователя %1 ?").arg(login),
@@ -249,26 +230,25 @@ void AdminWindow::onDeleteUser() {
         return;
     }
 
-    QSqlQuery q(Database::instance().get());
-    q.prepare("SELECT sp_delete_user(?, ?)");
+    QSqlQuery q = Database::instance().prepared("SELECT sp_delete_user(?, ?)");
     q.addBindValue(userId);
     q.addBindValue(m_adminId);
-    if (!q.exec()) {
+    if (!Database::exec(q)) {
         showError("Не удалось удалить пользователя: " + q.lastError().text());
         return;
     }
 
     q.next();
 
-    Logger::log(m_adminId, "delete_user", QString("user_id=%1").arg(userId));
-    loadUsers();
+    Database::instance().noteWrite();
+    Logger::log(m_adminId, "delete_user", QString("user_id=%1").arg(userId), Logger::FileOnly);
+    m_users->removeId(userId);
     QMessageBox::information(this, "OK", "Пользователь удалён");
 }
 
 int AdminWindow::selectedUserId() const {
-    int row = tblUsers->currentRow();
-    if (row < 0) return -1;
-    auto *item = tblUsers->item(row, 0); // login
-    if (!item) return -1;
-    return item->data(Qt::UserRole).toInt();
+    const QModelIndex current = tblUsers->currentIndex();
+    if (!tblUsers->selectionModel()->hasSelection() || !current.isValid()) return -1;
+    const int row = m_usersProxy->sourceRow(current.row());
+    return row < 0 ? -1 : m_users->rowAt(row).id;
 }
@@ -1,9 +1,15 @@
 #pragma once
 
 #include <QWidget>
-#include <QTableWidget>
+#include <QTableView>
 #include <QPushButton>
 
+#include "../db/DbExecutor.hpp"
+
+class QLineEdit;
+class UserModel;
+class SortFilterModel;
+
 class AdminWindow : public QWidget {
     Q_OBJECT
 public:
@@ -19,7 +25,10 @@ private slots:
 
 private:
     int m_adminId;
-    QTableWidget *tblUsers;
+    QTableView *tblUsers;
+    UserModel *m_users;
+    SortFilterModel *m_usersProxy;
+    QLineEdit *edUsersFilter;
     QPushButton *btnCreateUser;
     QPushButton *btnEditUser;
     QPushButton *btnToggleActive;
@@ -1,6 +1,6 @@
 #include "AssignmentDetailDialog.hpp"
 
-#include "../db/Database.hpp"
+#include "../db/DbExecutor.hpp"
 #include "../config/ConfigManager.hpp"
 
 #include <QVBoxLayout>
@@ -11,8 +11,6 @@
 #include <QTableWidget>
 #include <QHeaderView>
 #include <QTableWidgetItem>
-#include <QSqlQuery>
-#include <QSqlError>
 #include <QDesktopServices>
 #include <QUrl>
 #include <QProcess>
@@ -71,67 +69,68 @@ AssignmentDetailDialog::AssignmentDetailDialog(int assignmentId, QWidget *parent
 }
 
 void AssignmentDetailDialog::loadDetails() {
-    QSqlQuery q(Database::instance().get());
-    q.prepare("SELECT * FROM sp_get_assignment_details(?)");
-    q.addBindValue(m_assignmentId);
-
-    if (!q.exec() || !q.next()) {
-        lblTitle->setText(QStringLiteral("Задание не найдено"));
-        teDescription->clear();
-        return;
-    }
-
-    const QString title = q.value(0).toString();
-    const QString desc  = q.value(1).toString();
-    const QVariant dueVar = q.value(2);
-
-    QString dueStr;
-    if (!dueVar.isNull()) {
-        if (dueVar.canConvert<QDateTime>()) {
-            dueStr = dueVar.toDateTime().toLocalTime().toString("dd.MM.yyyy HH:mm");
-        } else {
-            dueStr = dueVar.toString();
-        }
-    }
-
-    lblTitle->setText(
-        dueStr.isEmpty()
-            ? title
-            : QStringLiteral("%1 (Дедлайн: %2)").arg(title, dueStr)
-    );
-
-    teDescription->setPlainText(desc);
+    DbExecutor::instance().submit(
+        "SELECT * FROM sp_get_assignment_details(?)", {m_assignmentId}, this,
+        [this](const DbResult &res) {
+            if (!res.ok || res.rows.isEmpty()) {
+                lblTitle->setText(QStringLiteral("Задание не найдено"));
+                teDescription->clear();
+                return;
+            }
+
+            const DbRow &row = res.rows.first();
+            const QString title = row[0].toString();
+            const QString desc  = row[1].toString();
+            const QVariant dueVar = row[2];
+
+            QString dueStr;
+            if (!dueVar.isNull()) {
+                if (dueVar.canConvert<QDateTime>()) {
+                    dueStr = dueVar.toDateTime().toLocalTime().toString("dd.MM.yyyy HH:mm");
+                } else {
+                    dueStr = dueVar.toString();
+                }
+            }
+
+            lblTitle->setText(
+                dueStr.isEmpty()
+                    ? title
+                    : QStringLiteral("%1 (Дедлайн: %2)").arg(title, dueStr)
+            );
+
+            teDescription->setPlainText(desc);
+        });
 }
 
 void AssignmentDetailDialog::loadFiles() {
     tblFiles->setRowCount(0);
 
-    QSqlQuery q(Database::instance().get());
-    q.prepare("SELECT * FROM sp_get_assignment_files(?)");
-    q.addBindValue(m_assignmentId);
-
-    if (!q.exec()) {
-        qWarning() << "Failed to load assignment files:" << q.lastError().text();
-        return;
-    }
+    DbExecutor::instance().submit(
+        "SELECT * FROM sp_get_assignment_files(?)", {m_assignmentId}, this,
+        [this](const DbResult &res) {
+            if (!res.ok) {
+                qWarning() << "Failed to load assignment files:" << res.error;
+                return;
+            }
 
-    int row = 0;
-    while (q.next()) {
-        const int fileId = q.value(0).toInt();
-        const QString originalName = q.value(1).toString();
-        const QString filePath = q.value(2).toString();
+            tblFiles->setRowCount(res.rows.size());
 
-        tblFiles->insertRow(row);
+            int row = 0;
+            for (const DbRow &r : res.rows) {
+                const int fileId = r[0].toInt();
+                const QString originalName = r[1].toString();
+                const QString filePath = r[2].toString();
 
-        auto *item = new QTableWidgetItem(originalName);
-        item->setData(Qt::UserRole, fileId);
-        item->setData(Qt::UserRole + 1, filePath);
-        tblFiles->setItem(row, 0, item);
+                auto *item = new QTableWidgetItem(originalName);
+                item->setData(Qt::UserRole, fileId);
+                item->setData(Qt::UserRole + 1, filePath);
+                tblFiles->setItem(row, 0, item);
 
-        ++row;
-    }
+                ++row;
+            }
 
-    tblFiles->resizeColumnsToContents();
+            tblFiles->resizeColumnsToContents();
+        });
 }
 
 void AssignmentDetailDialog::onFileDoubleClicked(int row, int) {
@@ -0,0 +1,85 @@
+#include "AssignmentModel.hpp"
+
+static QStringList headersFor(AssignmentModel::View view) {
+    if (view == AssignmentModel::View::Teacher)
+        return {"Задание", "Сдано", "Оценено", "С опозданием", "Последняя сдача"};
+    return {QStringLiteral("Задание"), QStringLiteral("Дедлайн")};
+}
+
+AssignmentModel::AssignmentModel(View view, int userId, QObject *parent)
+    : RowListModel<AssignmentRow>(headersFor(view), 0, parent), m_view(view), m_userId(userId) {}
+
+QString AssignmentModel::pageSql(const QVariantList &) const {
+    return m_view == View::Teacher ? QStringLiteral("SELECT * FROM sp_get_assignments_for_teacher(?)")
+                                   : QStringLiteral("SELECT * FROM sp_get_assignments_for_student(?)");
+}
+
+QVariantList AssignmentModel::pageBinds(const QVariantList &) const {
+    return {m_userId};
+}
+
+AssignmentRow AssignmentModel::makeRow(const DbRow &r) const {
+    AssignmentRow row;
+    row.id = r.value(0).toInt();
+    row.title = r.value(1).toString();
+    if (m_view == View::Teacher) {
+        // Счётчики из assignment_stats; у только что созданного задания их ещё нет
+        row.submitted = r.value(2).toInt();
+        row.graded = r.value(3).toInt();
+        row.late = r.value(4).toInt();
+        row.lastUploadAt = epochMsFromDb(r.value(5));
+    } else {
+        row.dueAt = epochMsFromDb(r.value(2));
+    }
+    return row;
+}
+
+// Порядок выдачи: у преподавателя id DESC (новые сверху), у студента — дедлайн
+// по возрастанию, без дедлайна — в конце
+int AssignmentModel::insertPosition(const AssignmentRow &row) const {
+    if (m_view == View::Teacher) return 0;
+    if (row.dueAt == kNoTime) return m_rows.size();
+
+    for (int i = 0; i < m_rows.size(); ++i) {
+        if (m_rows[i].dueAt == kNoTime || row.dueAt < m_rows[i].dueAt) return i;
+    }
+    return m_rows.size();
+}
+
+AssignmentModel::SortKeyFn AssignmentModel::sortKeyFn() const {
+    const View view = m_view;
+    return [view](const AssignmentRow &row, int column) {
+        if (column == 0) return SortKey::string(row.title);
+        if (view == View::Student) return SortKey::number(row.dueAt);
+
+        switch (column) {
+        case 1: return SortKey::number(row.submitted);
+        case 2: return SortKey::number(row.graded);
+        case 3: return SortKey::number(row.late);
+        case 4: return SortKey::number(row.lastUploadAt);
+        }
+        return SortKey();
+    };
+}
+
+AssignmentModel::FilterTextFn AssignmentModel::filterTextFn() const {
+    return [](const AssignmentRow &row) { return row.title; };
+}
+
+QVariant AssignmentModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= m_rows.size() || role != Qt::DisplayRole) return QVariant();
+
+    const AssignmentRow &row = m_rows[index.row()];
+    if (m_view == View::Student) {
+        return index.column() == 0 ? QVariant(row.title) : QVariant(formatEpochMs(row.dueAt));
+    }
+
+    switch (index.column()) {
+    case 0: return row.title;
+    case 1: return row.submitted;
+    case 2: return row.graded;
+    case 3: return row.late;
+    case 4: return formatEpochMs(row.lastUploadAt);
+    }
+    return QVariant();
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "DbListModel.hpp"
+
+struct AssignmentRow {
+    int id = 0;
+    QString title;
+    qint64 dueAt = kNoTime;
+    // Счётчики assignment_stats (только у преподавателя)
+    int submitted = 0;
+    int graded = 0;
+    int late = 0;
+    qint64 lastUploadAt = kNoTime;
+};
+
+/// Список заданий: у преподавателя — его задания со статистикой
+/// (sp_get_assignments_for_teacher), у студента — видимые ему задания
+/// (sp_get_assignments_for_student). Загружается одним вызовом.
+class AssignmentModel : public RowListModel<AssignmentRow> {
+public:
+    enum class View { Teacher, Student };
+
+    AssignmentModel(View view, int userId, QObject *parent = nullptr);
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+protected:
+    QString pageSql(const QVariantList &after) const override;
+    QVariantList pageBinds(const QVariantList &after) const override;
+    AssignmentRow makeRow(const DbRow &r) const override;
+    int insertPosition(const AssignmentRow &row) const override;
+    SortKeyFn sortKeyFn() const override;
+    FilterTextFn filterTextFn() const override;
+
+private:
+    View m_view;
+    int m_userId;
+};
@@ -0,0 +1,72 @@
+#include "DbListModel.hpp"
+
+#include <QDateTime>
+
+qint64 epochMsFromDb(const QVariant &v) {
+    if (v.isNull()) return kNoTime;
+    const QDateTime dt = v.toDateTime();
+    return dt.isValid() ? dt.toMSecsSinceEpoch() : kNoTime;
+}
+
+QString formatEpochMs(qint64 ms) {
+    if (ms == kNoTime) return QString();
+    return QDateTime::fromMSecsSinceEpoch(ms).toString(QStringLiteral("dd.MM.yyyy HH:mm"));
+}
+
+DbListModel::DbListModel(const QStringList &headers, int pageSize, QObject *parent)
+    : QAbstractTableModel(parent), m_headers(headers), m_pageSize(pageSize) {}
+
+int DbListModel::columnCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : m_headers.size();
+}
+
+QVariant DbListModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole && section >= 0 && section < m_headers.size())
+        return m_headers[section];
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+bool DbListModel::canFetchMore(const QModelIndex &parent) const {
+    return !parent.isValid() && m_hasMore;
+}
+
+void DbListModel::fetchMore(const QModelIndex &parent) {
+    if (parent.isValid() || !m_hasMore || m_ticket != 0) return;
+
+    const bool first = m_after.isEmpty();
+
+    m_ticket = DbExecutor::instance().submitLatest(
+        QStringLiteral("page"), pageSql(m_after), pageBinds(m_after), this,
+        [this, first](const DbResult &res) {
+            m_ticket = 0;
+            if (!res.ok) {
+                m_hasMore = false;
+                emit loadFailed(res.error);
+                return;
+            }
+
+            if (!res.rows.isEmpty()) {
+                appendPage(res.rows);
+                m_after = pageCursor(res.rows.last());
+            }
+            m_hasMore = m_pageSize > 0 && res.rows.size() == m_pageSize;
+            emit pageLoaded(first);
+        });
+}
+
+void DbListModel::reload() {
+    clear();
+    m_hasMore = true;
+    fetchMore(QModelIndex());
+}
+
+void DbListModel::clear() {
+    DbExecutor::instance().cancel(m_ticket);
+    m_ticket = 0;
+    m_after.clear();
+    m_hasMore = false;
+
+    beginResetModel();
+    clearRows();
+    endResetModel();
+}
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+
+#include "../db/DbExecutor.hpp"
+
+/// Время строки в мс от эпохи; kNoTime — NULL в БД (при сортировке идёт первым).
+constexpr qint64 kNoTime = std::numeric_limits<qint64>::min();
+
+qint64 epochMsFromDb(const QVariant &v);
+/// "dd.MM.yyyy HH:mm" в местном времени; пустая строка для kNoTime.
+QString formatEpochMs(qint64 ms);
+
+/// Ключ сортировки колонки: время и счётчики — num, текст — text, уже приведённый
+/// к одному регистру (toCaseFolded), чтобы сравнение при сортировке было дешёвым.
+struct SortKey {
+    qint64 num = 0;
+    QString text;
+
+    static SortKey number(qint64 n) { return SortKey{n, QString()}; }
+    static SortKey string(const QString &s) { return SortKey{0, s.toCaseFolded()}; }
+
+    bool operator<(const SortKey &o) const { return num != o.num ? num < o.num : text < o.text; }
+};
+
+/// Неизменяемая копия строк модели с доступом к ключам; читается в фоновом
+/// потоке сортировки (SortFilterModel), пока модель продолжает меняться.
+class RowKeySource {
+public:
+    virtual ~RowKeySource() = default;
+    virtual int size() const = 0;
+    virtual SortKey sortKey(int row, int column) const = 0;
+    /// Текст, по которому ищет фильтр (без приведения регистра).
+    virtual QString filterText(int row) const = 0;
+};
+
+/// Табличная модель над вызовом хранимой процедуры. Строки приходят через
+/// DbExecutor страницами по keyset-курсору из последней строки: QTableView сам
+/// запрашивает следующую через canFetchMore/fetchMore, когда прокрутка доходит до конца.
+/// pageSize 0 — процедура без пагинации, весь список одним вызовом.
+class DbListModel : public QAbstractTableModel {
+    Q_OBJECT
+public:
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    /// Сбрасывает строки и запрашивает первую страницу.
+    void reload();
+    /// Сбрасывает строки без загрузки; запрос в полёте отменяется.
+    void clear();
+
+    bool hasMore() const { return m_hasMore; }
+    bool isLoading() const { return m_ticket != 0; }
+
+    /// Снимок текущих строк для фоновой сортировки и фильтра.
+    virtual std::shared_ptr<const RowKeySource> keySource() const = 0;
+
+signals:
+    /// Страница добавлена; first — первая после reload().
+    void pageLoaded(bool first);
+    void loadFailed(const QString &error);
+
+protected:
+    DbListModel(const QStringList &headers, int pageSize, QObject *parent);
+
+    /// Вызов процедуры; after — курсор (пустой для первой страницы).
+    virtual QString pageSql(const QVariantList &after) const = 0;
+    virtual QVariantList pageBinds(const QVariantList &after) const = 0;
+    /// Курсор следующей страницы по последней строке результата; по умолчанию — id.
+    virtual QVariantList pageCursor(const DbRow &last) const { return {last.value(0)}; }
+
+    /// Добавляет строки страницы в конец.
+    virtual void appendPage(const QVector<DbRow> &page) = 0;
+    /// Удаляет все строки (внутри beginResetModel/endResetModel).
+    virtual void clearRows() = 0;
+
+private:
+    QStringList m_headers;
+    int m_pageSize;
+
+    quint64 m_ticket = 0;
+    QVariantList m_after;
+    bool m_hasMore = false;
+};
+
+/// Строки модели — компактные структуры Row с полем id, а не QVariant на ячейку.
+/// Подкласс задаёт разбор строки результата (makeRow), отображение (data) и место
+/// вставки новой строки (insertPosition), чтобы точечные обновления по NOTIFY
+/// сохраняли порядок выдачи процедуры.
+template <typename Row>
+class RowListModel : public DbListModel {
+public:
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override {
+        return parent.isValid() ? 0 : m_rows.size();
+    }
+
+    const Row &rowAt(int row) const { return m_rows[row]; }
+    const QVector<Row> &rows() const { return m_rows; }
+
+    int findRow(int id) const {
+        for (int i = 0; i < m_rows.size(); ++i)
+            if (m_rows[i].id == id) return i;
+        return -1;
+    }
+
+    /// Заменяет строку с тем же id; false, если такой строки нет.
+    bool update(const DbRow &r) {
+        Row row = makeRow(r);
+        const int existing = findRow(row.id);
+        if (existing < 0) return false;
+        replaceRow(existing, std::move(row));
+        return true;
+    }
+
+    /// Заменяет строку с тем же id или вставляет новую на своё место. Строка,
+    /// которая встала бы за последней загруженной, пока есть следующие страницы,
+    /// не вставляется: она придёт со своей страницей.
+    void upsert(const DbRow &r) {
+        Row row = makeRow(r);
+        const int existing = findRow(row.id);
+        if (existing >= 0) {
+            replaceRow(existing, std::move(row));
+            return;
+        }
+        const int at = std::clamp(insertPosition(row), 0, m_rows.size());
+        if (at == m_rows.size() && hasMore()) return;
+        beginInsertRows(QModelIndex(), at, at);
+        m_rows.insert(at, row);
+        endInsertRows();
+    }
+
+    void removeId(int id) {
+        const int row = findRow(id);
+        if (row < 0) return;
+        beginRemoveRows(QModelIndex(), row, row);
+        m_rows.remove(row);
+        endRemoveRows();
+    }
+
+    std::shared_ptr<const RowKeySource> keySource() const override {
+        return std::make_shared<Keys>(m_rows, sortKeyFn(), filterTextFn());
+    }
+
+protected:
+    using DbListModel::DbListModel;
+
+    /// Ключи вызываются в другом потоке: функции не должны читать состояние модели,
+    /// всё нужное (например, View) захватывается по значению.
+    using SortKeyFn = std::function<SortKey(const Row &, int column)>;
+    using FilterTextFn = std::function<QString(const Row &)>;
+
+    virtual Row makeRow(const DbRow &r) const = 0;
+    virtual int insertPosition(const Row &) const { return 0; }
+    virtual SortKeyFn sortKeyFn() const = 0;
+    virtual FilterTextFn filterTextFn() const = 0;
+
+    // Строки, уже вставленные точечным обновлением, со страницей не дублируются
+    void appendPage(const QVector<DbRow> &page) override {
+        QSet<int> present;
+        present.reserve(m_rows.size());
+        for (const Row &row : m_rows) present.insert(row.id);
+
+        QVector<Row> fresh;
+        fresh.reserve(page.size());
+        for (const DbRow &r : page) {
+            Row row = makeRow(r);
+            if (!present.contains(row.id)) fresh.push_back(std::move(row));
+        }
+        if (fresh.isEmpty()) return;
+
+        const int first = m_rows.size();
+        beginInsertRows(QModelIndex(), first, first + fresh.size() - 1);
+        m_rows.reserve(first + fresh.size());
+        for (Row &row : fresh) m_rows.push_back(std::move(row));
+        endInsertRows();
+    }
+
+    void clearRows() override {
+        m_rows.clear();
+        m_rows.squeeze();
+    }
+
+    QVector<Row> m_rows;
+
+private:
+    void replaceRow(int at, Row row) {
+        m_rows[at] = std::move(row);
+        emit dataChanged(index(at, 0), index(at, columnCount() - 1));
+    }
+
+    // Копия QVector разделяет данные до первой записи в модель, так что снимок дешёвый
+    class Keys : public RowKeySource {
+    public:
+        Keys(QVector<Row> rows, SortKeyFn sortKey, FilterTextFn filterText)
+            : m_rows(std::move(rows)), m_sortKey(std::move(sortKey)), m_filterText(std::move(filterText)) {}
+
+        int size() const override { return m_rows.size(); }
+        SortKey sortKey(int row, int column) const override { return m_sortKey(m_rows[row], column); }
+        QString filterText(int row) const override { return m_filterText(m_rows[row]); }
+
+    private:
+        const QVector<Row> m_rows;
+        const SortKeyFn m_sortKey;
+        const FilterTextFn m_filterText;
+    };
+};
@@ -0,0 +1,144 @@
+#include "SearchDialog.hpp"
+
+#include "../db/DbExecutor.hpp"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QLabel>
+#include <QTableWidget>
+#include <QTableWidgetItem>
+#include <QHeaderView>
+#include <QScrollBar>
+#include <QElapsedTimer>
+#include <QDebug>
+
+#include <memory>
+
+static const int kPageSize = 50;
+static const int kPrefetchRows = 10;
+
+SearchDialog::SearchDialog(const QString &sql, int userId, const QString &query, QWidget *parent)
+    : QDialog(parent), m_sql(sql), m_userId(userId)
+{
+    setWindowTitle(QStringLiteral("Поиск"));
+    resize(800, 500);
+
+    auto *v = new QVBoxLayout(this);
+
+    auto *h = new QHBoxLayout();
+    edQuery = new QLineEdit(this);
+    edQuery->setPlaceholderText(QStringLiteral("Слова из названия, описания или комментария"));
+    edQuery->setText(query);
+    auto *btnSearch = new QPushButton(QStringLiteral("Найти"), this);
+    h->addWidget(edQuery, 1);
+    h->addWidget(btnSearch);
+    v->addLayout(h);
+
+    tblResults = new QTableWidget(this);
+    tblResults->setColumnCount(3);
+    tblResults->setHorizontalHeaderLabels({QStringLiteral("Где"), QStringLiteral("Название"), QStringLiteral("Фрагмент")});
+    tblResults->setSelectionBehavior(QAbstractItemView::SelectRows);
+    tblResults->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    tblResults->horizontalHeader()->setStretchLastSection(true);
+    tblResults->setWordWrap(true);
+    connect(tblResults->verticalScrollBar(), &QScrollBar::valueChanged, this, [this](int value) {
+        if (value >= tblResults->verticalScrollBar()->maximum() - kPrefetchRows) fetchMore();
+    });
+    v->addWidget(tblResults, 1);
+
+    lblStatus = new QLabel(this);
+    v->addWidget(lblStatus);
+
+    connect(btnSearch, &QPushButton::clicked, this, &SearchDialog::startSearch);
+    connect(edQuery, &QLineEdit::returnPressed, this, &SearchDialog::startSearch);
+    connect(tblResults, &QTableWidget::cellDoubleClicked, this, &SearchDialog::onRowDoubleClicked);
+
+    if (!query.trimmed().isEmpty()) startSearch();
+}
+
+void SearchDialog::startSearch() {
+    DbExecutor::instance().cancel(m_ticket);
+    m_ticket = 0;
+    m_query = edQuery->text().trimmed();
+    m_hasMore = !m_query.isEmpty();
+    m_afterKind.clear();
+    tblResults->setRowCount(0);
+    lblStatus->clear();
+
+    fetchMore();
+}
+
+void SearchDialog::fetchMore() {
+    if (m_ticket != 0 || !m_hasMore) return;
+
+    const bool firstPage = m_afterKind.isEmpty();
+    const QVariant afterScore = firstPage ? QVariant(QVariant::Int) : QVariant(m_afterScore);
+    const QVariant afterKind = firstPage ? QVariant(QVariant::String) : QVariant(m_afterKind);
+    const QVariant afterId = firstPage ? QVariant(QVariant::Int) : QVariant(m_afterId);
+
+    auto timer = std::make_shared<QElapsedTimer>();
+    timer->start();
+
+    m_ticket = DbExecutor::instance().submitLatest(
+        "search", m_sql, {m_userId, m_query, afterScore, afterKind, afterId, kPageSize}, this,
+        [this, timer](const DbResult &res) {
+            m_ticket = 0;
+            if (!res.ok) {
+                m_hasMore = false;
+                qWarning() << "search failed:" << res.error;
+                lblStatus->setText(QStringLiteral("Ошибка поиска: ") + res.error);
+                return;
+            }
+
+            int r = tblResults->rowCount();
+            tblResults->setRowCount(r + res.rows.size());
+
+            // kind, id, assignment_id, title, snippet, score
+            for (const DbRow &row : res.rows) {
+                const bool feedback = row[0].toString() == QLatin1String("feedback");
+
+                auto *kindItem = new QTableWidgetItem(feedback ? QStringLiteral("Комментарий")
+                                                               : QStringLiteral("Задание"));
+                kindItem->setData(Qt::UserRole, row[1]);
+                kindItem->setData(Qt::UserRole + 1, row[2]);
+                kindItem->setData(Qt::UserRole + 2, feedback);
+                tblResults->setItem(r, 0, kindItem);
+                tblResults->setItem(r, 1, new QTableWidgetItem(row[3].toString()));
+                tblResults->setItem(r, 2, new QTableWidgetItem(row[4].toString().simplified()));
+                ++r;
+            }
+
+            if (!res.rows.isEmpty()) {
+                const DbRow &last = res.rows.last();
+                m_afterKind = last[0].toString();
+                m_afterId = last[1].toInt();
+                m_afterScore = last[5].toInt();
+            }
+            m_hasMore = res.rows.size() == kPageSize;
+
+            if (tblResults->rowCount() == 0) {
+                lblStatus->setText(QStringLiteral("Ничего не найдено"));
+            } else {
+                lblStatus->setText(QStringLiteral("Найдено: %1%2 (%3 мс)")
+                                       .arg(tblResults->rowCount())
+                                       .arg(m_hasMore ? QStringLiteral("+") : QString())
+                                       .arg(timer->elapsed()));
+            }
+            if (r == res.rows.size()) tblResults->resizeColumnToContents(0);
+        });
+}
+
+void SearchDialog::onRowDoubleClicked(int row, int) {
+    auto *item = tblResults->item(row, 0);
+    if (!item) return;
+
+    const int id = item->data(Qt::UserRole).toInt();
+    const int assignmentId = item->data(Qt::UserRole + 1).toInt();
+    if (item->data(Qt::UserRole + 2).toBool()) {
+        emit feedbackActivated(id, assignmentId);
+    } else {
+        emit assignmentActivated(assignmentId);
+    }
+}
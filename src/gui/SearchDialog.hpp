@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QDialog>
+#include <QString>
+
+class QLineEdit;
+class QTableWidget;
+class QLabel;
+
+/// Полнотекстовый поиск по заданиям и комментариям к работам (sp_search_for_*).
+/// Результаты идут страницами по мере прокрутки; двойной щелчок по строке
+/// сообщает окну, что открыть.
+class SearchDialog : public QDialog {
+    Q_OBJECT
+public:
+    /// sql — вызов процедуры поиска с параметрами (user, query, after_score, after_kind, after_id, limit).
+    SearchDialog(const QString &sql, int userId, const QString &query, QWidget *parent = nullptr);
+
+signals:
+    void assignmentActivated(int assignmentId);
+    void feedbackActivated(int submissionId, int assignmentId);
+
+private slots:
+    void startSearch();
+    void fetchMore();
+    void onRowDoubleClicked(int row, int column);
+
+private:
+    QString m_sql;
+    int m_userId;
+    QString m_query;
+
+    QLineEdit *edQuery = nullptr;
+    QTableWidget *tblResults = nullptr;
+    QLabel *lblStatus = nullptr;
+
+    quint64 m_ticket = 0;
+    bool m_hasMore = false;
+    // Ключ последней строки страницы: (score, kind, id)
+    int m_afterScore = 0;
+    QString m_afterKind;
+    int m_afterId = 0;
+};
@@ -0,0 +1,414 @@
+#include "SortFilterModel.hpp"
+
+#include <QCoreApplication>
+#include <QPointer>
+#include <QRunnable>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <vector>
+
+// Пауза между нажатиями клавиш и пачками страниц, после которой считаем заново
+static constexpr int kDebounceMs = 150;
+// Как часто фоновый проход проверяет, не заменён ли он более новым
+static constexpr int kCancelCheckMask = 0xFFF;
+
+// Ключи одной версии строк: переиспользуются, пока меняются только фильтр или сортировка
+struct SortFilterModel::Cache {
+    quint64 generation = 0;
+    int rows = 0;
+
+    bool hasHaystack = false;
+    QVector<QString> haystack;   // filterText в toCaseFolded
+
+    bool hasSorted = false;
+    int sortColumn = -1;
+    Qt::SortOrder sortOrder = Qt::AscendingOrder;
+    QVector<int> sorted;         // все строки источника в порядке сортировки
+};
+
+struct SortFilterModel::Result {
+    quint64 job = 0;
+    quint64 generation = 0;
+    int sortColumn = -1;
+    Qt::SortOrder sortOrder = Qt::AscendingOrder;
+    QString filter;
+    std::shared_ptr<const Cache> cache;
+    QVector<int> proxyToSource;
+};
+
+class SortFilterModel::Job : public QRunnable {
+public:
+    QPointer<SortFilterModel> owner;
+    std::shared_ptr<std::atomic<quint64>> latest;
+    quint64 id = 0;
+    quint64 generation = 0;
+    int sortColumn = -1;
+    Qt::SortOrder sortOrder = Qt::AscendingOrder;
+    QString filter;
+
+    std::shared_ptr<const RowKeySource> keys;  // nullptr — всё нужное уже в cache
+    std::shared_ptr<const Cache> cache;
+    // Фильтр продолжает прежний: ищем только среди уже отобранных строк
+    bool incremental = false;
+    QVector<int> base;
+
+    void run() override;
+
+private:
+    bool cancelled() const { return latest->load(std::memory_order_relaxed) != id; }
+};
+
+void SortFilterModel::Job::run() {
+    auto next = cache ? std::make_shared<Cache>(*cache) : std::make_shared<Cache>();
+    if (!cache) {
+        next->generation = generation;
+        next->rows = keys->size();
+    }
+    const int n = next->rows;
+
+    if (!next->hasSorted || next->sortColumn != sortColumn || next->sortOrder != sortOrder) {
+        QVector<int> sorted(n);
+        std::iota(sorted.begin(), sorted.end(), 0);
+        if (sortColumn >= 0) {
+            std::vector<SortKey> sortKeys;
+            sortKeys.reserve(n);
+            for (int i = 0; i < n; ++i) {
+                sortKeys.push_back(keys->sortKey(i, sortColumn));
+                if ((i & kCancelCheckMask) == 0 && cancelled()) return;
+            }
+            // Равные ключи остаются в порядке выдачи процедуры
+            const bool desc = sortOrder == Qt::DescendingOrder;
+            std::stable_sort(sorted.begin(), sorted.end(), [&sortKeys, desc](int a, int b) {
+                return desc ? sortKeys[b] < sortKeys[a] : sortKeys[a] < sortKeys[b];
+            });
+        }
+        next->sorted = std::move(sorted);
+        next->sortColumn = sortColumn;
+        next->sortOrder = sortOrder;
+        next->hasSorted = true;
+    }
+    if (cancelled()) return;
+
+    QVector<int> proxyToSource;
+    if (filter.isEmpty()) {
+        proxyToSource = next->sorted;
+    } else {
+        if (!next->hasHaystack) {
+            QVector<QString> haystack;
+            haystack.reserve(n);
+            for (int i = 0; i < n; ++i) {
+                haystack.push_back(keys->filterText(i).toCaseFolded());
+                if ((i & kCancelCheckMask) == 0 && cancelled()) return;
+            }
+            next->haystack = std::move(haystack);
+            next->hasHaystack = true;
+        }
+
+        const QVector<int> &from = incremental ? base : next->sorted;
+        proxyToSource.reserve(from.size());
+        for (int i = 0; i < from.size(); ++i) {
+            if (next->haystack[from[i]].contains(filter)) proxyToSource.push_back(from[i]);
+            if ((i & kCancelCheckMask) == 0 && cancelled()) return;
+        }
+    }
+
+    Result result;
+    result.job = id;
+    result.generation = generation;
+    result.sortColumn = sortColumn;
+    result.sortOrder = sortOrder;
+    result.filter = filter;
+    result.cache = std::move(next);
+    result.proxyToSource = std::move(proxyToSource);
+
+    // Модель может быть удалена раньше, чем очередь GUI дойдёт до результата
+    QPointer<SortFilterModel> target = owner;
+    QMetaObject::invokeMethod(QCoreApplication::instance(), [target, result]() {
+        if (target) target->applyResult(result);
+    }, Qt::QueuedConnection);
+}
+
+SortFilterModel::SortFilterModel(DbListModel *source, QObject *parent)
+    : QAbstractProxyModel(parent), m_source(source), m_latestJob(std::make_shared<std::atomic<quint64>>(0)) {
+    QAbstractProxyModel::setSourceModel(source);
+
+    m_debounce.setSingleShot(true);
+    connect(&m_debounce, &QTimer::timeout, this, &SortFilterModel::startJob);
+
+    connect(source, &QAbstractItemModel::rowsInserted, this, &SortFilterModel::onRowsInserted);
+    connect(source, &QAbstractItemModel::rowsAboutToBeRemoved, this, &SortFilterModel::onRowsAboutToBeRemoved);
+    connect(source, &QAbstractItemModel::rowsRemoved, this, &SortFilterModel::onRowsRemoved);
+    connect(source, &QAbstractItemModel::dataChanged, this, &SortFilterModel::onDataChanged);
+    connect(source, &QAbstractItemModel::modelAboutToBeReset, this, &SortFilterModel::onModelAboutToBeReset);
+    connect(source, &QAbstractItemModel::modelReset, this, &SortFilterModel::onModelReset);
+
+    m_proxyToSource.resize(source->rowCount());
+    std::iota(m_proxyToSource.begin(), m_proxyToSource.end(), 0);
+    rebuildInverse();
+}
+
+SortFilterModel::~SortFilterModel() {
+    cancelJob();
+}
+
+QModelIndex SortFilterModel::index(int row, int column, const QModelIndex &parent) const {
+    if (parent.isValid() || row < 0 || row >= m_proxyToSource.size() || column < 0 || column >= columnCount())
+        return QModelIndex();
+    return createIndex(row, column);
+}
+
+QModelIndex SortFilterModel::parent(const QModelIndex &) const {
+    return QModelIndex();
+}
+
+int SortFilterModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : m_proxyToSource.size();
+}
+
+int SortFilterModel::columnCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : sourceModel()->columnCount();
+}
+
+// Базовая версия берёт заголовок колонки через mapToSource строки 0 и
+// у пустой (отфильтрованной) таблицы теряет его
+QVariant SortFilterModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation == Qt::Horizontal) return sourceModel()->headerData(section, orientation, role);
+    return QAbstractItemModel::headerData(section, orientation, role);
+}
+
+QModelIndex SortFilterModel::mapToSource(const QModelIndex &proxyIndex) const {
+    if (!proxyIndex.isValid()) return QModelIndex();
+    const int row = sourceRow(proxyIndex.row());
+    return row < 0 ? QModelIndex() : sourceModel()->index(row, proxyIndex.column());
+}
+
+QModelIndex SortFilterModel::mapFromSource(const QModelIndex &sourceIndex) const {
+    if (!sourceIndex.isValid()) return QModelIndex();
+    const int row = proxyRow(sourceIndex.row());
+    return row < 0 ? QModelIndex() : index(row, sourceIndex.column());
+}
+
+void SortFilterModel::sort(int column, Qt::SortOrder order) {
+    if (column < 0 || column >= columnCount()) column = -1;
+    if (column == m_sortColumn && order == m_sortOrder) return;
+
+    m_sortColumn = column;
+    m_sortOrder = order;
+    m_appliedValid = false;
+    schedule(0);
+}
+
+void SortFilterModel::setFilterText(const QString &text) {
+    const QString folded = text.trimmed().toCaseFolded();
+    if (folded == m_filter) return;
+
+    m_filter = folded;
+    schedule(kDebounceMs);
+}
+
+void SortFilterModel::schedule(int delayMs) {
+    if (isIdentity()) {
+        cancelJob();
+        QVector<int> identity(m_source->rowCount());
+        std::iota(identity.begin(), identity.end(), 0);
+        setMapping(std::move(identity));
+        m_appliedFilter.clear();
+        m_appliedValid = true;
+        return;
+    }
+
+    // Без фильтра готовая сортировка этой версии строк применяется сразу
+    if (m_filter.isEmpty() && m_cache && m_cache->generation == m_generation && m_cache->hasSorted
+        && m_cache->sortColumn == m_sortColumn && m_cache->sortOrder == m_sortOrder) {
+        cancelJob();
+        setMapping(m_cache->sorted);
+        m_appliedFilter.clear();
+        m_appliedValid = true;
+        return;
+    }
+
+    m_debounce.start(delayMs);
+}
+
+void SortFilterModel::startJob() {
+    auto *job = new Job;
+    job->owner = this;
+    job->latest = m_latestJob;
+    job->id = ++m_job;
+    m_latestJob->store(m_job);
+    job->generation = m_generation;
+    job->sortColumn = m_sortColumn;
+    job->sortOrder = m_sortOrder;
+    job->filter = m_filter;
+
+    const bool cacheFits = m_cache && m_cache->generation == m_generation;
+    const bool keysReady = cacheFits && m_cache->hasSorted && m_cache->sortColumn == m_sortColumn
+                           && m_cache->sortOrder == m_sortOrder && (m_filter.isEmpty() || m_cache->hasHaystack);
+    if (cacheFits) job->cache = m_cache;
+    if (!keysReady) job->keys = m_source->keySource();
+
+    if (cacheFits && m_cache->hasHaystack && m_appliedValid && !m_appliedFilter.isEmpty()
+        && m_filter.contains(m_appliedFilter)) {
+        job->incremental = true;
+        job->base = m_proxyToSource;
+    }
+
+    QThreadPool::globalInstance()->start(job);
+}
+
+void SortFilterModel::cancelJob() {
+    m_debounce.stop();
+    m_latestJob->store(++m_job);
+}
+
+void SortFilterModel::applyResult(const Result &result) {
+    if (result.job != m_job) return;
+    if (result.generation != m_generation) {
+        // Строки изменились, пока считали: индексы результата уже не те
+        schedule(0);
+        return;
+    }
+
+    m_cache = result.cache;
+    setMapping(result.proxyToSource);
+    m_appliedFilter = result.filter;
+    m_appliedValid = result.sortColumn == m_sortColumn && result.sortOrder == m_sortOrder;
+}
+
+// Перестановка подменяется целиком; выделение и текущая строка идут за своими строками
+void SortFilterModel::setMapping(QVector<int> proxyToSource) {
+    if (proxyToSource == m_proxyToSource) return;
+
+    emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+
+    const QModelIndexList from = persistentIndexList();
+    QVector<int> fromSource;
+    fromSource.reserve(from.size());
+    for (const QModelIndex &idx : from) fromSource.push_back(sourceRow(idx.row()));
+
+    m_proxyToSource = std::move(proxyToSource);
+    rebuildInverse();
+
+    QModelIndexList to;
+    to.reserve(from.size());
+    for (int i = 0; i < from.size(); ++i) {
+        const int row = proxyRow(fromSource[i]);
+        to.append(row < 0 ? QModelIndex() : index(row, from[i].column()));
+    }
+    changePersistentIndexList(from, to);
+
+    emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+}
+
+void SortFilterModel::rebuildInverse() {
+    m_sourceToProxy.fill(-1, m_source->rowCount());
+    for (int row = 0; row < m_proxyToSource.size(); ++row) m_sourceToProxy[m_proxyToSource[row]] = row;
+}
+
+void SortFilterModel::onRowsInserted(const QModelIndex &parent, int first, int last) {
+    if (parent.isValid()) return;
+    const int count = last - first + 1;
+    ++m_generation;
+
+    if (isIdentity()) {
+        beginInsertRows(QModelIndex(), first, last);
+        m_proxyToSource.resize(m_source->rowCount());
+        std::iota(m_proxyToSource.begin(), m_proxyToSource.end(), 0);
+        rebuildInverse();
+        endInsertRows();
+        return;
+    }
+
+    for (int &row : m_proxyToSource)
+        if (row >= first) row += count;
+    m_appliedValid = false;
+
+    // Без фильтра новые строки видны сразу (в конце), на место их ставит пересчёт
+    if (m_filter.isEmpty()) {
+        const int at = m_proxyToSource.size();
+        beginInsertRows(QModelIndex(), at, at + count - 1);
+        for (int row = first; row <= last; ++row) m_proxyToSource.push_back(row);
+        rebuildInverse();
+        endInsertRows();
+    } else {
+        rebuildInverse();
+    }
+    schedule(kDebounceMs);
+}
+
+void SortFilterModel::onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last) {
+    if (parent.isValid()) return;
+
+    QVector<int> rows;
+    for (int row = first; row <= last; ++row) {
+        const int p = proxyRow(row);
+        if (p >= 0) rows.push_back(p);
+    }
+    std::sort(rows.begin(), rows.end(), std::greater<int>());
+
+    // Подряд идущие строки прокси удаляются одним диапазоном, с конца, чтобы
+    // номера ещё не удалённых диапазонов не сдвигались
+    for (int i = 0; i < rows.size();) {
+        const int last = rows[i];
+        int first = last;
+        while (++i < rows.size() && rows[i] == first - 1) first = rows[i];
+
+        beginRemoveRows(QModelIndex(), first, last);
+        m_proxyToSource.remove(first, last - first + 1);
+        endRemoveRows();
+    }
+    if (!rows.isEmpty()) rebuildInverse();
+}
+
+// Оставшиеся строки не меняют ни порядка, ни попадания в фильтр: пересчёт не нужен,
+// только сдвиг индексов источника
+void SortFilterModel::onRowsRemoved(const QModelIndex &parent, int first, int last) {
+    if (parent.isValid()) return;
+    const int count = last - first + 1;
+    ++m_generation;
+
+    for (int &row : m_proxyToSource)
+        if (row > last) row -= count;
+    rebuildInverse();
+}
+
+void SortFilterModel::onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight) {
+    if (!topLeft.isValid() || topLeft.parent().isValid()) return;
+    ++m_generation;
+
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        const int p = proxyRow(row);
+        if (p >= 0) emit dataChanged(index(p, topLeft.column()), index(p, bottomRight.column()));
+    }
+
+    // Ключ изменённой строки мог сменить её место или попадание в фильтр
+    if (!isIdentity()) {
+        m_appliedValid = false;
+        schedule(kDebounceMs);
+    }
+}
+
+void SortFilterModel::onModelAboutToBeReset() {
+    beginResetModel();
+}
+
+void SortFilterModel::onModelReset() {
+    ++m_generation;
+    cancelJob();
+    m_cache.reset();
+
+    m_proxyToSource.clear();
+    if (isIdentity()) {
+        m_proxyToSource.resize(m_source->rowCount());
+        std::iota(m_proxyToSource.begin(), m_proxyToSource.end(), 0);
+    }
+    rebuildInverse();
+    m_appliedFilter.clear();
+    m_appliedValid = isIdentity();
+    endResetModel();
+
+    if (!isIdentity() && m_source->rowCount() > 0) schedule(0);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <QAbstractProxyModel>
+#include <QTimer>
+#include <QVector>
+
+#include <atomic>
+#include <memory>
+
+#include "DbListModel.hpp"
+
+/// Сортировка и фильтр поверх DbListModel без блокировки GUI. Перестановка строк
+/// считается в пуле потоков над снимком keySource(): ключи (время в мс, текст в
+/// toCaseFolded) извлекаются один раз на версию данных и переиспользуются при
+/// смене фильтра; готовая перестановка подменяется целиком одним layoutChanged.
+/// Фильтр — подстрока без учёта регистра; если новый текст продолжает прежний,
+/// ищется только среди уже отобранных строк.
+/// Сортируются загруженные строки: следующие страницы модели встают на место
+/// при очередном пересчёте.
+class SortFilterModel : public QAbstractProxyModel {
+    Q_OBJECT
+public:
+    explicit SortFilterModel(DbListModel *source, QObject *parent = nullptr);
+    ~SortFilterModel() override;
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    QModelIndex mapToSource(const QModelIndex &proxyIndex) const override;
+    QModelIndex mapFromSource(const QModelIndex &sourceIndex) const override;
+
+    /// column -1 — порядок выдачи процедуры.
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+    void setFilterText(const QString &text);
+
+    /// Строка модели-источника для строки представления и обратно (-1 — скрыта фильтром).
+    int sourceRow(int proxyRow) const { return m_proxyToSource.value(proxyRow, -1); }
+    int proxyRow(int sourceRow) const { return m_sourceToProxy.value(sourceRow, -1); }
+
+private:
+    struct Cache;
+    struct Result;
+    class Job;
+
+    DbListModel *m_source;
+
+    QVector<int> m_proxyToSource;
+    QVector<int> m_sourceToProxy;
+
+    int m_sortColumn = -1;
+    Qt::SortOrder m_sortOrder = Qt::AscendingOrder;
+    QString m_filter;           // в toCaseFolded
+    QString m_appliedFilter;    // фильтр, по которому построена m_proxyToSource
+
+    // Версия строк источника: растёт при любом изменении, устаревшие результаты отбрасываются
+    quint64 m_generation = 0;
+    quint64 m_job = 0;
+    std::shared_ptr<std::atomic<quint64>> m_latestJob;
+    std::shared_ptr<const Cache> m_cache;
+    bool m_appliedValid = true;  // m_proxyToSource соответствует m_generation и сортировке
+
+    QTimer m_debounce;
+
+    bool isIdentity() const { return m_sortColumn < 0 && m_filter.isEmpty(); }
+    /// Пересчёт: сразу, если перестановка уже известна, иначе в пуле через delayMs.
+    void schedule(int delayMs);
+    void startJob();
+    void cancelJob();
+    void applyResult(const Result &result);
+    void setMapping(QVector<int> proxyToSource);
+    void rebuildInverse();
+
+    void onRowsInserted(const QModelIndex &parent, int first, int last);
+    void onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void onRowsRemoved(const QModelIndex &parent, int first, int last);
+    void onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    void onModelAboutToBeReset();
+    void onModelReset();
+};
@@ -1,28 +1,33 @@
 #include "StudentWindow.hpp"
 #include "AssignmentDetailDialog.hpp"
+#include "SearchDialog.hpp"
+#include "AssignmentModel.hpp"
+#include "SubmissionModel.hpp"
+#include "SortFilterModel.hpp"
 
 #include "../db/Database.hpp"
+#include "../db/DbExecutor.hpp"
+#include "../db/ChangeListener.hpp"
 #include "../config/ConfigManager.hpp"
 #include "../crypto/KeyProtect.hpp"
 #include "../crypto/FileCrypto.hpp"
+#include "../storage/ArchiveReader.hpp"
 #include "../utils/Logger.hpp"
 
-#include <QTableWidget>
+#include <QTableView>
 #include <QHeaderView>
-#include <QTableWidgetItem>
+#include <QScrollBar>
 #include <QPushButton>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QLabel>
+#include <QLineEdit>
 #include <QDesktopServices>
 #include <QUrl>
 #include <QProcess>
 #include <QJsonDocument>
 #include <QJsonObject>
 
-#include <QSqlQuery>
-#include <QSqlError>
-
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QCoreApplication>
@@ -33,6 +38,8 @@
 #include <QFileDevice>
 #include <QDebug>
 
+static const int kPrefetchRows = 20;
+
 static QString storageAbs(const QString &rel) {
     return QString::fromStdString(ConfigManager::instance().storagePath(rel.toStdString()));
 }
@@ -45,9 +52,24 @@ StudentWindow::StudentWindow(int studentId, QWidget *parent)
 
     auto *v = new QVBoxLayout(this);
 
-    tblAssignments = new QTableWidget(this);
-    tblAssignments->setColumnCount(2);
-    tblAssignments->setHorizontalHeaderLabels({QStringLiteral("Задание"), QStringLiteral("Дедлайн")});
+    edSearch = new QLineEdit(this);
+    edSearch->setPlaceholderText(QStringLiteral("Поиск по заданиям и комментариям (Enter)"));
+    edSearch->setClearButtonEnabled(true);
+    connect(edSearch, &QLineEdit::returnPressed, this, &StudentWindow::onSearch);
+    v->addWidget(edSearch);
+
+    m_assignments = new AssignmentModel(AssignmentModel::View::Student, m_studentId, this);
+    connect(m_assignments, &DbListModel::pageLoaded, this, [this]() {
+        tblAssignments->resizeColumnsToContents();
+    });
+    connect(m_assignments, &DbListModel::loadFailed, this, [this](const QString &error) {
+        qWarning() << "sp_get_assignments_for_student failed:" << error;
+        QMessageBox::warning(this, QStringLiteral("Ошибка"),
+                             QStringLiteral("Не удалось загрузить задания: ") + error);
+    });
+
+    tblAssignments = new QTableView(this);
+    tblAssignments->setModel(m_assignments);
     tblAssignments->setSelectionBehavior(QAbstractItemView::SelectRows);
     tblAssignments->setEditTriggers(QAbstractItemView::NoEditTriggers);
     tblAssignments->horizontalHeader()->setStretchLastSection(true);
@@ -60,18 +82,34 @@ StudentWindow::StudentWindow(int studentId, QWidget *parent)
     h1->addStretch();
     v->addLayout(h1);
 
-    tblMySubmissions = new QTableWidget(this);
-    tblMySubmissions->setColumnCount(4);
-    tblMySubmissions->setHorizontalHeaderLabels({
-        QStringLiteral("Задание"),
-        QStringLiteral("Файл"),
-        QStringLiteral("Загружено"),
-        QStringLiteral("Оценка / Комментарий")
+    m_submissions = new SubmissionModel(SubmissionModel::View::Student, m_studentId, this);
+    connect(m_submissions, &DbListModel::pageLoaded, this, &StudentWindow::onSubmissionsPageLoaded);
+    connect(m_submissions, &DbListModel::loadFailed, this, [](const QString &error) {
+        qWarning() << "sp_get_my_submissions_page failed:" << error;
     });
+
+    // Сортировка по заголовку и фильтр считаются в фоне; до первого щелчка — порядок процедуры
+    m_submissionsProxy = new SortFilterModel(m_submissions, this);
+    connect(m_submissionsProxy, &QAbstractItemModel::layoutChanged, this, &StudentWindow::focusSubmission);
+
+    edSubmissionsFilter = new QLineEdit(this);
+    edSubmissionsFilter->setPlaceholderText(QStringLiteral("Фильтр по заданию или файлу"));
+    edSubmissionsFilter->setClearButtonEnabled(true);
+    connect(edSubmissionsFilter, &QLineEdit::textChanged, m_submissionsProxy, &SortFilterModel::setFilterText);
+
+    tblMySubmissions = new QTableView(this);
+    tblMySubmissions->setModel(m_submissionsProxy);
     tblMySubmissions->setSelectionBehavior(QAbstractItemView::SelectRows);
     tblMySubmissions->setEditTriggers(QAbstractItemView::NoEditTriggers);
     tblMySubmissions->horizontalHeader()->setStretchLastSection(true);
+    tblMySubmissions->horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+    tblMySubmissions->setSortingEnabled(true);
+    connect(tblMySubmissions->verticalScrollBar(), &QScrollBar::valueChanged, this, [this](int value) {
+        if (value >= tblMySubmissions->verticalScrollBar()->maximum() - kPrefetchRows)
+            m_submissions->fetchMore(QModelIndex());
+    });
     v->addWidget(new QLabel(QStringLiteral("Мои отправления:"), this));
+    v->addWidget(edSubmissionsFilter);
     v->addWidget(tblMySubmissions, 1);
 
     auto *h2 = new QHBoxLayout();
@@ -81,110 +119,121 @@ StudentWindow::StudentWindow(int studentId, QWidget *parent)
     v->addLayout(h2);
 
     connect(btnUpload, &QPushButton::clicked, this, &StudentWindow::onUpload);
-    connect(tblAssignments, &QTableWidget::cellDoubleClicked, this, &StudentWindow::onAssignmentDoubleClicked);
+    connect(tblAssignments, &QTableView::doubleClicked, this, &StudentWindow::onAssignmentDoubleClicked);
     connect(btnDownloadMy, &QPushButton::clicked, this, &StudentWindow::onDownloadMySubmission);
 
+    auto &changes = ChangeListener::instance();
+    connect(&changes, &ChangeListener::assignmentChanged, this, &StudentWindow::onAssignmentChanged);
+    connect(&changes, &ChangeListener::audienceChanged, this, &StudentWindow::onAudienceChanged);
+    connect(&changes, &ChangeListener::submissionChanged, this, &StudentWindow::onSubmissionChanged);
+
     loadAssignments();
     loadMySubmissions();
 }
 
 void StudentWindow::loadAssignments() {
-    tblAssignments->setRowCount(0);
-
-    QSqlQuery q(Database::instance().get());
-    q.prepare("SELECT * FROM sp_get_assignments_for_student(?)");
-    q.addBindValue(m_studentId);
-
-    if (!q.exec()) {
-        qWarning() << "sp_get_assignments_for_student failed:" << q.lastError().text();
-        QMessageBox::warning(this, QStringLiteral("Ошибка"),
-                             QStringLiteral("Не удалось загрузить задания: ") + q.lastError().text());
-        return;
-    }
-
-    int r = 0;
-    while (q.next()) {
-        const int assignmentId = q.value(0).toInt();
-        const QString title = q.value(1).toString();
-        const QVariant dueVar = q.value(2);
-
-        QString deadlineText;
-        if (dueVar.canConvert<QDateTime>()) {
-            deadlineText = dueVar.toDateTime().toLocalTime().toString("dd.MM.yyyy HH:mm");
-        } else {
-            deadlineText = dueVar.toString();
-        }
-
-        tblAssignments->insertRow(r);
+    m_assignments->reload();
+}
 
-        auto *titleItem = new QTableWidgetItem(title);
-        titleItem->setData(Qt::UserRole, assignmentId);
-        tblAssignments->setItem(r, 0, titleItem);
+void StudentWindow::loadMySubmissions() {
+    m_submissions->reload();
+}
 
-        tblAssignments->setItem(r, 1, new QTableWidgetItem(deadlineText));
+void StudentWindow::onSubmissionsPageLoaded(bool first) {
+    if (first) tblMySubmissions->resizeColumnsToContents();
+    focusSubmission();
+}
 
-        ++r;
+// Выделяет отправление, выбранное в поиске; если его страница ещё не загружена — догружает
+void StudentWindow::focusSubmission() {
+    if (m_focusSubmissionId <= 0) return;
+
+    const int row = m_submissions->findRow(m_focusSubmissionId);
+    if (row >= 0) {
+        // Скрытое фильтром отправление показываем, сбросив фильтр; если перестановка
+        // считается в фоне, повторим по её layoutChanged
+        if (m_submissionsProxy->proxyRow(row) < 0) edSubmissionsFilter->clear();
+        const int viewRow = m_submissionsProxy->proxyRow(row);
+        if (viewRow < 0) return;
+
+        m_focusSubmissionId = 0;
+        tblMySubmissions->selectRow(viewRow);
+        tblMySubmissions->scrollTo(m_submissionsProxy->index(viewRow, 0));
+    } else if (m_submissions->hasMore()) {
+        m_submissions->fetchMore(QModelIndex());
+    } else {
+        m_focusSubmissionId = 0;
     }
-
-    tblAssignments->resizeColumnsToContents();
 }
 
-void StudentWindow::loadMySubmissions() {
-    tblMySubmissions->setRowCount(0);
-
-    QSqlQuery q(Database::instance().get());
-    q.prepare("SELECT * FROM sp_get_my_submissions(?)");
-    q.addBindValue(m_studentId);
+void StudentWindow::onSearch() {
+    auto *dlg = new SearchDialog(QStringLiteral("SELECT * FROM sp_search_for_student(?, ?, ?, ?, ?, ?)"),
+                                 m_studentId, edSearch->text(), this);
+    dlg->setAttribute(Qt::WA_DeleteOnClose);
+    connect(dlg, &SearchDialog::assignmentActivated, this, [this](int assignmentId) {
+        AssignmentDetailDialog details(assignmentId, this);
+        details.exec();
+    });
+    connect(dlg, &SearchDialog::feedbackActivated, this, [this](int submissionId, int) {
+        m_focusSubmissionId = submissionId;
+        focusSubmission();
+    });
+    dlg->show();
+}
 
-    if (!q.exec()) {
-        qWarning() << "sp_get_my_submissions failed:" << q.lastError().text();
+void StudentWindow::onAssignmentChanged(int assignmentId, int, const QString &op) {
+    if (op == QLatin1String("DELETE")) {
+        m_assignments->removeId(assignmentId);
         return;
     }
+    refreshAssignmentRow(assignmentId);
+}
 
-    int r = 0;
-    while (q.next()) {
-        const int subId = q.value(0).toInt();
-        const int assignmentId = q.value(1).toInt();
-        const QString assignmentTitle = q.value(2).toString();
-        const QString origName = q.value(3).toString();
-        const QVariant uploadedVar = q.value(4);
-
-        QString uploadedText;
-        if (uploadedVar.canConvert<QDateTime>()) {
-            uploadedText = uploadedVar.toDateTime().toLocalTime().toString("dd.MM.yyyy HH:mm");
-        } else {
-            uploadedText = uploadedVar.toString();
-        }
-
-        const QString grade = q.value(5).isNull() ? QString() : q.value(5).toString();
-        const QString fb = q.value(6).isNull() ? QString() : q.value(6).toString();
-
-        QString gf = grade;
-        if (!fb.isEmpty()) {
-            if (!gf.isEmpty()) gf += " / ";
-            gf += fb;
-        }
-
-        const QString filePath = q.value(7).toString();
-
-        tblMySubmissions->insertRow(r);
-
-        auto *asItem = new QTableWidgetItem(assignmentTitle);
-        asItem->setData(Qt::UserRole, assignmentId);
-        tblMySubmissions->setItem(r, 0, asItem);
-
-        auto *fileItem = new QTableWidgetItem(origName);
-        fileItem->setData(Qt::UserRole, subId);
-        fileItem->setData(Qt::UserRole + 1, filePath);
-        tblMySubmissions->setItem(r, 1, fileItem);
+void StudentWindow::onAudienceChanged(int assignmentId, int studentId, const QString &) {
+    if (studentId != m_studentId) return;
+    refreshAssignmentRow(assignmentId);
+}
 
-        tblMySubmissions->setItem(r, 2, new QTableWidgetItem(uploadedText));
-        tblMySubmissions->setItem(r, 3, new QTableWidgetItem(gf));
+void StudentWindow::onSubmissionChanged(int submissionId, int, int studentId, const QString &op) {
+    if (studentId != m_studentId) return;
 
-        ++r;
+    if (op == QLatin1String("DELETE")) {
+        m_submissions->removeId(submissionId);
+        return;
     }
+    refreshSubmissionRow(submissionId, op == QLatin1String("INSERT"));
+}
+
+void StudentWindow::refreshAssignmentRow(int assignmentId) {
+    DbExecutor::instance().submitLatest(
+        "assignment:" + QString::number(assignmentId), "SELECT * FROM sp_get_assignment_for_student(?, ?)", {m_studentId, assignmentId}, this,
+        [this, assignmentId](const DbResult &res) {
+            if (!res.ok) return;
+
+            if (res.rows.isEmpty()) {
+                m_assignments->removeId(assignmentId);
+                return;
+            }
+            // Новое задание встаёт по дедлайну, как в выдаче sp_get_assignments_for_student
+            m_assignments->upsert(res.rows.first());
+        }, DbExecutor::ReadFrom::Primary);
+}
 
-    tblMySubmissions->resizeColumnsToContents();
+void StudentWindow::refreshSubmissionRow(int submissionId, bool inserted) {
+    DbExecutor::instance().submitLatest(
+        "submission:" + QString::number(submissionId), "SELECT * FROM sp_get_my_submission(?, ?)", {m_studentId, submissionId}, this,
+        [this, submissionId, inserted](const DbResult &res) {
+            if (!res.ok) return;
+
+            if (res.rows.isEmpty()) {
+                m_submissions->removeId(submissionId);
+                return;
+            }
+            // Новое отправление встаёт на своё место (uploaded_at DESC), изменённое —
+            // только если его страница уже загружена
+            if (inserted) m_submissions->upsert(res.rows.first());
+            else m_submissions->update(res.rows.first());
+        }, DbExecutor::ReadFrom::Primary);
 }
 
 static QString findCreateSubmissionExe() {
@@ -204,19 +253,13 @@ static QString findCreateSubmissionExe() {
 }
 
 void StudentWindow::onUpload() {
-    const int row = tblAssignments->currentRow();
-    if (row < 0) {
+    const QModelIndex current = tblAssignments->currentIndex();
+    if (!current.isValid()) {
         QMessageBox::warning(this, QStringLiteral("Ошибка"), QStringLiteral("Выберите задание"));
         return;
     }
 
-    auto *titleItem = tblAssignments->item(row, 0);
-    if (!titleItem) {
-        QMessageBox::warning(this, QStringLiteral("Ошибка"), QStringLiteral("Выберите задание"));
-        return;
-    }
-
-    const int assignmentId = titleItem->data(Qt::UserRole).toInt();
+    const int assignmentId = m_assignments->rowAt(current.row()).id;
     if (assignmentId <= 0) {
         QMessageBox::warning(this, QStringLiteral("Ошибка"), QStringLiteral("Некорректное задание"));
         return;
@@ -246,19 +289,21 @@ void StudentWindow::onUpload() {
         return;
     }
 
+    // Запись сделал дочерний процесс — ближайшие чтения только с основного сервера
+    Database::instance().noteWrite();
+
     QMessageBox::information(this, QStringLiteral("OK"), QStringLiteral("Файл успешно отправлен"));
     Logger::log(m_studentId, "upload_submission",
                 QString("assignment=%1 file=%2").arg(assignmentId).arg(QFileInfo(file).fileName()));
-    loadMySubmissions();
-}
 
-void StudentWindow::onAssignmentDoubleClicked(int row, int) {
-    if (row < 0) return;
+    // Новая строка придёт через NOTIFY (onSubmissionChanged); без слушателя — перечитываем
+    if (!ChangeListener::instance().isActive()) loadMySubmissions();
+}
 
-    auto *titleItem = tblAssignments->item(row, 0);
-    if (!titleItem) return;
+void StudentWindow::onAssignmentDoubleClicked(const QModelIndex &index) {
+    if (!index.isValid()) return;
 
-    const int assignmentId = titleItem->data(Qt::UserRole).toInt();
+    const int assignmentId = m_assignments->rowAt(index.row()).id;
     if (assignmentId <= 0) return;
 
     AssignmentDetailDialog dlg(assignmentId, this);
@@ -266,46 +311,47 @@ void StudentWindow::onAssignmentDoubleClicked(int row, int) {
 }
 
 void StudentWindow::onDownloadMySubmission() {
-    const int row = tblMySubmissions->currentRow();
-    if (row < 0) {
+    const QModelIndex current = tblMySubmissions->currentIndex();
+    if (!current.isValid()) {
         QMessageBox::warning(this, QStringLiteral("Ошибка"), QStringLiteral("Выберите отправление"));
         return;
     }
 
-    auto *fileItem = tblMySubmissions->item(row, 1);
-    if (!fileItem) {
-        QMessageBox::warning(this, QStringLiteral("Ошибка"), QStringLiteral("Выберите отправление"));
-        return;
-    }
-
-    const QString filePath = fileItem->data(Qt::UserRole + 1).toString();
-    const QString originalName = fileItem->text();
+    const SubmissionRow sub = m_submissions->rowAt(m_submissionsProxy->sourceRow(current.row()));
+    const QString filePath = sub.filePath;
+    const QString originalName = sub.originalName;
     if (filePath.isEmpty()) {
         QMessageBox::warning(this, QStringLiteral("Ошибка"), QStringLiteral("Путь к файлу отсутствует"));
         return;
     }
 
     const QString encFilePath = storageAbs(QStringLiteral("files/%1").arg(filePath));
+    const QString uuid = QFileInfo(filePath).baseName();
+
+    QString safeName = QFileInfo(originalName).fileName();
+    safeName.replace("/", "_");
+    safeName.replace("\\", "_");
+
+    QString tmpPath = QDir::temp().filePath(QStringLiteral("%1_%2").arg(uuid, safeName));
+    QFile::remove(tmpPath);
+
+    // Отправления прошлых семестров лежат в архивных сегментах
     if (!QFileInfo::exists(encFilePath)) {
-        QMessageBox::warning(this, QStringLiteral("Ошибка"), QStringLiteral("Файл не найден: ") + encFilePath);
+        QString aerr;
+        if (!archive::extractSubmission(m_studentId, sub.id, tmpPath, &aerr)) {
+            QMessageBox::warning(this, QStringLiteral("Ошибка"), aerr);
+            return;
+        }
+        openDownloaded(tmpPath);
         return;
     }
 
-    const QString uuid = QFileInfo(filePath).baseName();
     const QString metaPath = storageAbs(QStringLiteral("metadata/%1.json").arg(uuid));
-
     if (!QFileInfo::exists(metaPath)) {
         QMessageBox::warning(this, QStringLiteral("Ошибка"), QStringLiteral("Metadata не найден"));
         return;
     }
 
-    QString safeName = QFileInfo(originalName).fileName();
-    safeName.replace("/", "_");
-    safeName.replace("\\", "_");
-
-    QString tmpPath = QDir::temp().filePath(QStringLiteral("%1_%2").arg(uuid, safeName));
-    QFile::remove(tmpPath);
-
     QFile mf(metaPath);
     if (!mf.open(QIODevice::ReadOnly)) {
         QMessageBox::warning(this, QStringLiteral("Ошибка"), QStringLiteral("Не удалось открыть metadata"));
@@ -350,6 +396,10 @@ void StudentWindow::onDownloadMySubmission() {
         return;
     }
 
+    openDownloaded(tmpPath);
+}
+
+void StudentWindow::openDownloaded(const QString &tmpPath) {
     QFile::Permissions perms = QFile::permissions(tmpPath);
     perms |= QFileDevice::ReadOwner | QFileDevice::WriteOwner
           | QFileDevice::ReadGroup | QFileDevice::ReadOther;
@@ -1,9 +1,16 @@
 #pragma once
 
 #include <QWidget>
+#include <QModelIndex>
 
-class QTableWidget;
+#include "../db/DbExecutor.hpp"
+
+class QTableView;
 class QPushButton;
+class QLineEdit;
+class AssignmentModel;
+class SubmissionModel;
+class SortFilterModel;
 
 class StudentWindow : public QWidget {
     Q_OBJECT
@@ -14,14 +21,33 @@ public:
 private slots:
     void loadAssignments();
     void loadMySubmissions();
+    void onSubmissionsPageLoaded(bool first);
     void onUpload();
-    void onAssignmentDoubleClicked(int row, int column);
+    void onAssignmentDoubleClicked(const QModelIndex &index);
     void onDownloadMySubmission();
+    void onAssignmentChanged(int assignmentId, int createdBy, const QString &op);
+    void onAudienceChanged(int assignmentId, int studentId, const QString &op);
+    void onSubmissionChanged(int submissionId, int assignmentId, int studentId, const QString &op);
+    void onSearch();
 
 private:
     int m_studentId;
 
-    QTableWidget *tblAssignments = nullptr;
-    QTableWidget *tblMySubmissions = nullptr;
+    QTableView *tblAssignments = nullptr;
+    QTableView *tblMySubmissions = nullptr;
+    AssignmentModel *m_assignments = nullptr;
+    SubmissionModel *m_submissions = nullptr;
+    SortFilterModel *m_submissionsProxy = nullptr;
     QPushButton *btnUpload = nullptr;
+    QLineEdit *edSearch = nullptr;
+    QLineEdit *edSubmissionsFilter = nullptr;
+
+    // Отправление из результатов поиска: выделяется, когда дойдёт его страница
+    int m_focusSubmissionId = 0;
+
+    void refreshAssignmentRow(int assignmentId);
+    void refreshSubmissionRow(int submissionId, bool inserted);
+    void focusSubmission();
+    /// Открывает расшифрованную копию во внешней программе.
+    void openDownloaded(const QString &tmpPath);
 };
@@ -0,0 +1,111 @@
+#include "SubmissionModel.hpp"
+
+QString SubmissionRow::gradeText() const {
+    QString gf = grade;
+    if (!feedback.isEmpty()) {
+        if (!gf.isEmpty()) gf += " / ";
+        gf += feedback;
+    }
+    return gf;
+}
+
+static QStringList headersFor(SubmissionModel::View view) {
+    return {view == SubmissionModel::View::Teacher ? QStringLiteral("Студент") : QStringLiteral("Задание"),
+            QStringLiteral("Файл"), QStringLiteral("Загружено"), QStringLiteral("Оценка / Комментарий")};
+}
+
+SubmissionModel::SubmissionModel(View view, int userId, QObject *parent)
+    : RowListModel<SubmissionRow>(headersFor(view), kPageSize, parent), m_view(view), m_userId(userId) {}
+
+// Первая страница и следующие — разные перегрузки процедуры: у следующих условие
+// по курсору без OR, и обобщённый план из кэша запросов остаётся диапазоном индекса
+QString SubmissionModel::pageSql(const QVariantList &after) const {
+    if (m_view == View::Teacher) {
+        return after.isEmpty() ? QStringLiteral("SELECT * FROM sp_get_submissions_for_assignment_page(?, ?, ?)")
+                               : QStringLiteral("SELECT * FROM sp_get_submissions_for_assignment_page(?, ?, ?, ?, ?)");
+    }
+    return after.isEmpty() ? QStringLiteral("SELECT * FROM sp_get_my_submissions_page(?, ?)")
+                           : QStringLiteral("SELECT * FROM sp_get_my_submissions_page(?, ?, ?, ?)");
+}
+
+// Курсор (uploaded_at, id): время — текстом cursor_uploaded_at, без потери микросекунд
+QVariantList SubmissionModel::pageBinds(const QVariantList &after) const {
+    QVariantList binds = {m_userId};
+    if (m_view == View::Teacher) binds << m_assignmentId;
+    if (!after.isEmpty()) binds << after.value(0) << after.value(1);
+    return binds << kPageSize;
+}
+
+QVariantList SubmissionModel::pageCursor(const DbRow &last) const {
+    const int cursorColumn = m_view == View::Teacher ? 7 : 8;
+    return {last.value(cursorColumn), last.value(0)};
+}
+
+// Колонки совпадают с sp_get_submission_for_teacher / sp_set_submission_grade(s)
+// и sp_get_my_submission, поэтому точечные обновления идут через тот же разбор
+SubmissionRow SubmissionModel::makeRow(const DbRow &r) const {
+    SubmissionRow row;
+    row.id = r.value(0).toInt();
+    if (m_view == View::Teacher) {
+        row.assignmentId = m_assignmentId;
+        row.studentLogin = r.value(1).toString();
+        row.originalName = r.value(2).toString();
+        row.uploadedAt = epochMsFromDb(r.value(3));
+        row.grade = r.value(4).toString();
+        row.feedback = r.value(5).toString();
+        row.filePath = r.value(6).toString();
+    } else {
+        row.assignmentId = r.value(1).toInt();
+        row.assignmentTitle = r.value(2).toString();
+        row.originalName = r.value(3).toString();
+        row.uploadedAt = epochMsFromDb(r.value(4));
+        row.grade = r.value(5).toString();
+        row.feedback = r.value(6).toString();
+        row.filePath = r.value(7).toString();
+    }
+    return row;
+}
+
+// Порядок выдачи: uploaded_at DESC, id DESC
+int SubmissionModel::insertPosition(const SubmissionRow &row) const {
+    const auto it = std::lower_bound(m_rows.cbegin(), m_rows.cend(), row,
+                                     [](const SubmissionRow &r, const SubmissionRow &key) {
+                                         return r.uploadedAt != key.uploadedAt ? r.uploadedAt > key.uploadedAt
+                                                                               : r.id > key.id;
+                                     });
+    return static_cast<int>(it - m_rows.cbegin());
+}
+
+SubmissionModel::SortKeyFn SubmissionModel::sortKeyFn() const {
+    const View view = m_view;
+    return [view](const SubmissionRow &row, int column) {
+        switch (column) {
+        case 0: return SortKey::string(view == View::Teacher ? row.studentLogin : row.assignmentTitle);
+        case 1: return SortKey::string(row.originalName);
+        case 2: return SortKey::number(row.uploadedAt);
+        case 3: return SortKey::string(row.gradeText());
+        }
+        return SortKey();
+    };
+}
+
+// Фильтр ищет по первой колонке (логин студента или задание) и имени файла
+SubmissionModel::FilterTextFn SubmissionModel::filterTextFn() const {
+    const View view = m_view;
+    return [view](const SubmissionRow &row) -> QString {
+        return (view == View::Teacher ? row.studentLogin : row.assignmentTitle) + QLatin1Char('\n') + row.originalName;
+    };
+}
+
+QVariant SubmissionModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= m_rows.size() || role != Qt::DisplayRole) return QVariant();
+
+    const SubmissionRow &row = m_rows[index.row()];
+    switch (index.column()) {
+    case 0: return m_view == View::Teacher ? row.studentLogin : row.assignmentTitle;
+    case 1: return row.originalName;
+    case 2: return formatEpochMs(row.uploadedAt);
+    case 3: return row.gradeText();
+    }
+    return QVariant();
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "DbListModel.hpp"
+
+struct SubmissionRow {
+    int id = 0;
+    int assignmentId = 0;
+    QString assignmentTitle;   // только у студента
+    QString studentLogin;      // только у преподавателя
+    QString originalName;
+    QString filePath;
+    QString grade;
+    QString feedback;
+    qint64 uploadedAt = kNoTime;
+
+    /// "оценка / комментарий" для колонки таблицы.
+    QString gradeText() const;
+};
+
+/// Отправления, постранично: у преподавателя — по выбранному заданию
+/// (sp_get_submissions_for_assignment_page), у студента — свои
+/// (sp_get_my_submissions_page). Порядок — uploaded_at DESC, id DESC.
+class SubmissionModel : public RowListModel<SubmissionRow> {
+public:
+    enum class View { Teacher, Student };
+
+    static constexpr int kPageSize = 200;
+
+    SubmissionModel(View view, int userId, QObject *parent = nullptr);
+
+    /// Задание, отправления которого показывает модель преподавателя (0 — никакое).
+    void setAssignment(int assignmentId) { m_assignmentId = assignmentId; }
+    int assignment() const { return m_assignmentId; }
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+protected:
+    QString pageSql(const QVariantList &after) const override;
+    QVariantList pageBinds(const QVariantList &after) const override;
+    QVariantList pageCursor(const DbRow &last) const override;
+    SubmissionRow makeRow(const DbRow &r) const override;
+    int insertPosition(const SubmissionRow &row) const override;
+    SortKeyFn sortKeyFn() const override;
+    FilterTextFn filterTextFn() const override;
+
+private:
+    View m_view;
+    int m_userId;
+    int m_assignmentId = 0;
+};
@@ -1,9 +1,18 @@
 #include "TeacherWindow.hpp"
+#include "SearchDialog.hpp"
+#include "AssignmentModel.hpp"
+#include "SubmissionModel.hpp"
+#include "SortFilterModel.hpp"
 
 #include "../db/Database.hpp"
+#include "../db/DbExecutor.hpp"
+#include "../db/ChangeListener.hpp"
+#include "../db/PgConnection.hpp"
+#include "../db/GradebookExport.hpp"
 #include "../config/ConfigManager.hpp"
 #include "../crypto/KeyProtect.hpp"
 #include "../crypto/FileCrypto.hpp"
+#include "../storage/ArchiveReader.hpp"
 #include "../utils/Logger.hpp"
 
 #include <QVBoxLayout>
@@ -25,12 +34,92 @@
 #include <QDialog>
 #include <QPushButton>
 #include <QHeaderView>
+#include <QScrollBar>
+#include <QTableWidget>
 #include <QTableWidgetItem>
 #include <QProcess>
 #include <QDebug>
 #include <QCryptographicHash>
 #include <QLineEdit>
 #include <QFileDevice>
+#include <QItemSelectionModel>
+#include <QSaveFile>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QRunnable>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <functional>
+
+static const int kPrefetchRows = 20;
+
+namespace {
+
+struct GradebookExportResult {
+    bool ok = false;
+    QString error;
+    qint64 rows = 0;
+    qint64 ms = 0;
+};
+
+// COPY ведомости большого курса идёт секунды, поэтому выгрузка — в пуле потоков
+// со своим соединением libpq; итог передаётся в поток GUI
+class GradebookExportTask : public QRunnable {
+public:
+    using Done = std::function<void(const GradebookExportResult &)>;
+
+    GradebookExportTask(int teacherId, const QString &path, Done done)
+        : m_teacherId(teacherId), m_path(path), m_done(std::move(done)) {}
+
+    void run() override {
+        QElapsedTimer timer;
+        timer.start();
+        GradebookExportResult res = exportCsv();
+        res.ms = timer.elapsed();
+
+        const Done done = std::move(m_done);
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [done, res]() { done(res); }, Qt::QueuedConnection);
+    }
+
+private:
+    GradebookExportResult exportCsv() const {
+        GradebookExportResult res;
+
+        // COPY доступен только через libpq; отдельное соединение на время выгрузки
+        PgConnection conn;
+        if (!conn.open()) {
+            res.error = "Не удалось подключиться к базе: " + conn.lastError();
+            return res;
+        }
+
+        QSaveFile file(m_path);
+        if (!file.open(QIODevice::WriteOnly)) {
+            res.error = "Не удалось открыть файл: " + file.errorString();
+            return res;
+        }
+
+        // Excel в русской локали ожидает ';' и BOM
+        gradebook::CsvOptions options;
+        options.delimiter = QLatin1Char(';');
+        options.bom = true;
+
+        QString error;
+        res.ok = gradebook::exportCsv(conn, m_teacherId, file, options, &error, &res.rows) && file.commit();
+        if (!res.ok) {
+            file.cancelWriting();
+            res.error = "Не удалось выгрузить оценки: " + (error.isEmpty() ? file.errorString() : error);
+        }
+        return res;
+    }
+
+    int m_teacherId;
+    QString m_path;
+    Done m_done;
+};
+
+} // namespace
 
 static QString storageAbs(const QString &rel) {
     return QString::fromStdString(ConfigManager::instance().storagePath(rel.toStdString()));
@@ -42,37 +131,79 @@ TeacherWindow::TeacherWindow(int teacherId, QWidget *parent)
     resize(1000, 600);
 
     auto v = new QVBoxLayout(this);
+
+    edSearch = new QLineEdit();
+    edSearch->setPlaceholderText("Поиск по заданиям и комментариям (Enter)");
+    edSearch->setClearButtonEnabled(true);
+    connect(edSearch, &QLineEdit::returnPressed, this, &TeacherWindow::onSearch);
+    v->addWidget(edSearch);
+
     auto htop = new QHBoxLayout();
 
-    tblAssignments = new QTableWidget();
-    tblAssignments->setColumnCount(1);
-    tblAssignments->setHorizontalHeaderLabels({"Задание"});
+    m_assignments = new AssignmentModel(AssignmentModel::View::Teacher, m_teacherId, this);
+    connect(m_assignments, &DbListModel::pageLoaded, this, [this]() {
+        tblAssignments->resizeColumnsToContents();
+    });
+    connect(m_assignments, &DbListModel::loadFailed, this, [this](const QString &error) {
+        QMessageBox::warning(this, "Ошибка", "Не удалось загрузить задания: " + error);
+    });
+
+    tblAssignments = new QTableView();
+    tblAssignments->setModel(m_assignments);
     tblAssignments->setSelectionBehavior(QAbstractItemView::SelectRows);
     tblAssignments->setEditTriggers(QAbstractItemView::NoEditTriggers);
     tblAssignments->horizontalHeader()->setStretchLastSection(true);
-    connect(tblAssignments, &QTableWidget::cellClicked, this, &TeacherWindow::onAssignmentSelected);
+    connect(tblAssignments, &QTableView::clicked, this, &TeacherWindow::onAssignmentSelected);
+
+    m_submissions = new SubmissionModel(SubmissionModel::View::Teacher, m_teacherId, this);
+    connect(m_submissions, &DbListModel::pageLoaded, this, &TeacherWindow::onSubmissionsPageLoaded);
+    connect(m_submissions, &DbListModel::loadFailed, this, [this](const QString &error) {
+        QMessageBox::warning(this, "Ошибка", "Не удалось загрузить отправления: " + error);
+    });
+
+    // Сортировка по заголовку и фильтр считаются в фоне; до первого щелчка — порядок процедуры
+    m_submissionsProxy = new SortFilterModel(m_submissions, this);
+    connect(m_submissionsProxy, &QAbstractItemModel::layoutChanged, this, &TeacherWindow::focusSubmission);
 
-    tblSubmissions = new QTableWidget();
-    tblSubmissions->setColumnCount(4);
-    tblSubmissions->setHorizontalHeaderLabels({"Студент", "Файл", "Загружено", "Оценка / Комментарий"});
+    edSubmissionsFilter = new QLineEdit();
+    edSubmissionsFilter->setPlaceholderText("Фильтр по логину студента или файлу");
+    edSubmissionsFilter->setClearButtonEnabled(true);
+    connect(edSubmissionsFilter, &QLineEdit::textChanged, m_submissionsProxy, &SortFilterModel::setFilterText);
+
+    tblSubmissions = new QTableView();
+    tblSubmissions->setModel(m_submissionsProxy);
     tblSubmissions->setSelectionBehavior(QAbstractItemView::SelectRows);
+    tblSubmissions->setSelectionMode(QAbstractItemView::ExtendedSelection);
     tblSubmissions->setEditTriggers(QAbstractItemView::NoEditTriggers);
     tblSubmissions->horizontalHeader()->setStretchLastSection(true);
+    tblSubmissions->horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+    tblSubmissions->setSortingEnabled(true);
+    // Следующая страница — чуть раньше конца прокрутки, чтобы не ждать её на последней строке
+    connect(tblSubmissions->verticalScrollBar(), &QScrollBar::valueChanged, this, [this](int value) {
+        if (value >= tblSubmissions->verticalScrollBar()->maximum() - kPrefetchRows)
+            m_submissions->fetchMore(QModelIndex());
+    });
+
+    auto vsub = new QVBoxLayout();
+    vsub->addWidget(edSubmissionsFilter);
+    vsub->addWidget(tblSubmissions, 1);
 
     htop->addWidget(tblAssignments, 1);
-    htop->addWidget(tblSubmissions, 2);
+    htop->addLayout(vsub, 2);
 
     btnRefresh = new QPushButton("Обновить");
     btnDownload = new QPushButton("Скачать/Открыть");
     btnGrade = new QPushButton("Оценить / Комментарий");
     btnCreateAssignment = new QPushButton("Создать задание");
     btnDeleteAssignment = new QPushButton("Удалить задание");
+    btnExport = new QPushButton("Экспорт оценок");
 
     connect(btnRefresh, &QPushButton::clicked, this, &TeacherWindow::loadAssignments);
     connect(btnDownload, &QPushButton::clicked, this, &TeacherWindow::onDownloadSubmission);
     connect(btnGrade, &QPushButton::clicked, this, &TeacherWindow::onGradeSubmission);
     connect(btnCreateAssignment, &QPushButton::clicked, this, &TeacherWindow::onCreateAssignment);
     connect(btnDeleteAssignment, &QPushButton::clicked, this, &TeacherWindow::onDeleteAssignment);
+    connect(btnExport, &QPushButton::clicked, this, &TeacherWindow::onExportGradebook);
 
     auto hbot = new QHBoxLayout();
     hbot->addWidget(btnCreateAssignment);
@@ -80,150 +211,230 @@ TeacherWindow::TeacherWindow(int teacherId, QWidget *parent)
     hbot->addWidget(btnRefresh);
     hbot->addWidget(btnDownload);
     hbot->addWidget(btnGrade);
+    hbot->addWidget(btnExport);
     hbot->addStretch();
 
     v->addLayout(htop);
     v->addLayout(hbot);
 
+    m_changesTimer = new QTimer(this);
+    m_changesTimer->setSingleShot(true);
+    m_changesTimer->setInterval(0);
+    connect(m_changesTimer, &QTimer::timeout, this, &TeacherWindow::flushChanges);
+
+    auto &changes = ChangeListener::instance();
+    connect(&changes, &ChangeListener::assignmentChanged, this, &TeacherWindow::onAssignmentChanged);
+    connect(&changes, &ChangeListener::submissionChanged, this, &TeacherWindow::onSubmissionChanged);
+
     loadAssignments();
 }
 
 void TeacherWindow::loadAssignments() {
-    tblAssignments->setRowCount(0);
-
-    QSqlDatabase db = Database::instance().get();
-    QSqlQuery q(db);
-    q.prepare("SELECT * FROM sp_get_assignments_for_teacher(?)");
-    q.addBindValue(m_teacherId);
-
-    if (!q.exec()) {
-        QMessageBox::warning(this, "Ошибка", "Не удалось загрузить задания: " + q.lastError().text());
-        return;
-    }
-
-    int row = 0;
-    while (q.next()) {
-        tblAssignments->insertRow(row);
+    m_assignments->reload();
+}
 
-        const int assignmentId = q.value(0).toInt();
-        const QString title = q.value(1).toString();
+void TeacherWindow::onAssignmentSelected(const QModelIndex &index) {
+    if (!index.isValid()) return;
 
-        auto *titleItem = new QTableWidgetItem(title);
-        titleItem->setData(Qt::UserRole, assignmentId);
+    const int assignmentId = m_assignments->rowAt(index.row()).id;
+    if (assignmentId <= 0) return;
 
-        tblAssignments->setItem(row, 0, titleItem);
-        ++row;
-    }
+    loadSubmissions(assignmentId);
+}
 
-    tblAssignments->resizeColumnsToContents();
+void TeacherWindow::clearSubmissions() {
+    m_focusSubmissionId = 0;
+    m_changedSubmissions.clear();
+    m_insertedSubmissions.clear();
+    m_submissions->setAssignment(0);
+    m_submissions->clear();
 }
 
-void TeacherWindow::onAssignmentSelected(int row, int) {
+void TeacherWindow::showAssignment(int assignmentId, int focusSubmissionId) {
+    const int row = m_assignments->findRow(assignmentId);
     if (row < 0) return;
 
-    auto *item = tblAssignments->item(row, 0);
-    if (!item) return;
-
-    const int assignmentId = item->data(Qt::UserRole).toInt();
-    if (assignmentId <= 0) return;
-
-    currentAssignmentId = assignmentId;
+    tblAssignments->selectRow(row);
+    tblAssignments->scrollTo(m_assignments->index(row, 0));
     loadSubmissions(assignmentId);
+    m_focusSubmissionId = focusSubmissionId;
 }
 
-void TeacherWindow::clearSubmissions() {
-    tblSubmissions->setRowCount(0);
+void TeacherWindow::onSearch() {
+    auto *dlg = new SearchDialog("SELECT * FROM sp_search_for_teacher(?, ?, ?, ?, ?, ?)", m_teacherId,
+                                 edSearch->text(), this);
+    dlg->setAttribute(Qt::WA_DeleteOnClose);
+    connect(dlg, &SearchDialog::assignmentActivated, this, [this](int assignmentId) {
+        showAssignment(assignmentId);
+    });
+    connect(dlg, &SearchDialog::feedbackActivated, this, [this](int submissionId, int assignmentId) {
+        showAssignment(assignmentId, submissionId);
+    });
+    dlg->show();
 }
 
 void TeacherWindow::loadSubmissions(int assignmentId) {
     clearSubmissions();
 
-    QSqlDatabase db = Database::instance().get();
-    QSqlQuery q(db);
+    currentAssignmentId = assignmentId;
+    m_submissions->setAssignment(assignmentId);
+    m_submissions->reload();
+}
 
-    q.prepare("SELECT * FROM sp_get_submissions_for_assignment(?, ?)");
-    q.addBindValue(m_teacherId);
-    q.addBindValue(assignmentId);
+void TeacherWindow::onSubmissionsPageLoaded(bool first) {
+    if (first) tblSubmissions->resizeColumnsToContents();
+    focusSubmission();
+}
 
-    if (!q.exec()) {
-        QMessageBox::warning(this, "Ошибка", "Не удалось загрузить отправления: " + q.lastError().text());
+// Выделяет отправление, выбранное в поиске; если его страница ещё не загружена — догружает
+void TeacherWindow::focusSubmission() {
+    if (m_focusSubmissionId <= 0) return;
+
+    const int row = m_submissions->findRow(m_focusSubmissionId);
+    if (row >= 0) {
+        // Скрытое фильтром отправление показываем, сбросив фильтр; если перестановка
+        // считается в фоне, повторим по её layoutChanged
+        if (m_submissionsProxy->proxyRow(row) < 0) edSubmissionsFilter->clear();
+        const int viewRow = m_submissionsProxy->proxyRow(row);
+        if (viewRow < 0) return;
+
+        m_focusSubmissionId = 0;
+        tblSubmissions->selectRow(viewRow);
+        tblSubmissions->scrollTo(m_submissionsProxy->index(viewRow, 1));
+    } else if (m_submissions->hasMore()) {
+        m_submissions->fetchMore(QModelIndex());
+    } else {
+        m_focusSubmissionId = 0;
+    }
+}
+
+void TeacherWindow::onAssignmentChanged(int assignmentId, int createdBy, const QString &op) {
+    if (op == QLatin1String("DELETE")) {
+        m_changedAssignments.remove(assignmentId);
+        m_assignments->removeId(assignmentId);
+        if (assignmentId == currentAssignmentId) clearSubmissions();
         return;
     }
+    if (createdBy != m_teacherId) return;
 
-    int row = 0;
-    while (q.next()) {
-        tblSubmissions->insertRow(row);
+    m_changedAssignments.insert(assignmentId);
+    m_changesTimer->start();
+}
 
-        const int subId = q.value(0).toInt();
-        const QString login = q.value(1).toString();
-        const QString orig = q.value(2).toString();
-        const QVariant uploadedVar = q.value(3);
+void TeacherWindow::onSubmissionChanged(int submissionId, int assignmentId, int, const QString &op) {
+    // Счётчики в списке заданий меняются при любой сдаче или оценке
+    if (m_assignments->findRow(assignmentId) >= 0) {
+        m_changedAssignments.insert(assignmentId);
+        m_changesTimer->start();
+    }
 
-        QString uploadedText;
-        if (uploadedVar.canConvert<QDateTime>()) {
-            QDateTime dt = uploadedVar.toDateTime().toLocalTime();
-            uploadedText = dt.toString("dd.MM.yyyy HH:mm");
-        } else {
-            uploadedText = uploadedVar.toString();
-        }
+    if (assignmentId != currentAssignmentId) return;
 
-        const QString grade = q.value(4).isNull() ? QString() : q.value(4).toString();
-        const QString feedback = q.value(5).isNull() ? QString() : q.value(5).toString();
-        QString gf = grade;
-        if (!feedback.isEmpty()) {
-            if (!gf.isEmpty()) gf += " / ";
-            gf += feedback;
-        }
+    if (op == QLatin1String("DELETE")) {
+        m_changedSubmissions.remove(submissionId);
+        m_insertedSubmissions.remove(submissionId);
+        m_submissions->removeId(submissionId);
+        return;
+    }
 
-        tblSubmissions->setItem(row, 0, new QTableWidgetItem(login));
+    m_changedSubmissions.insert(submissionId);
+    if (op == QLatin1String("INSERT")) m_insertedSubmissions.insert(submissionId);
+    m_changesTimer->start();
+}
 
-        auto *fileItem = new QTableWidgetItem(orig);
-        fileItem->setData(Qt::UserRole, subId);
-        fileItem->setData(Qt::UserRole + 1, q.value(6).toString());
-        tblSubmissions->setItem(row, 1, fileItem);
+void TeacherWindow::flushChanges() {
+    const QSet<int> assignments = m_changedAssignments;
+    m_changedAssignments.clear();
+    for (int assignmentId : assignments) refreshAssignmentRow(assignmentId);
 
-        tblSubmissions->setItem(row, 2, new QTableWidgetItem(uploadedText));
-        tblSubmissions->setItem(row, 3, new QTableWidgetItem(gf));
+    if (m_changedSubmissions.isEmpty()) return;
+    refreshSubmissionRows(m_changedSubmissions, m_insertedSubmissions);
+    m_changedSubmissions.clear();
+    m_insertedSubmissions.clear();
+}
 
-        ++row;
-    }
+void TeacherWindow::refreshAssignmentRow(int assignmentId) {
+    DbExecutor::instance().submitLatest(
+        "assignment:" + QString::number(assignmentId), "SELECT * FROM sp_get_assignment_for_teacher(?, ?)", {m_teacherId, assignmentId}, this,
+        [this, assignmentId](const DbResult &res) {
+            if (!res.ok) return;
 
-    tblSubmissions->resizeColumnsToContents();
+            if (res.rows.isEmpty()) {
+                m_assignments->removeId(assignmentId);
+                return;
+            }
+            // Новые задания — в начало, как в sp_get_assignments_for_teacher (id DESC)
+            m_assignments->upsert(res.rows.first());
+        }, DbExecutor::ReadFrom::Primary);
 }
 
-void TeacherWindow::onDownloadSubmission() {
-    auto sel = tblSubmissions->selectedItems();
-    if (sel.isEmpty()) {
-        QMessageBox::warning(this, "Ошибка", "Выберите отправление");
-        return;
-    }
-
-    int row = tblSubmissions->currentRow();
-    if (row < 0) {
-        QMessageBox::warning(this, "Ошибка", "Выберите отправление");
-        return;
-    }
+// Пачки не вытесняют друг друга (submit, а не submitLatest): у каждой свои id
+void TeacherWindow::refreshSubmissionRows(const QSet<int> &ids, const QSet<int> &inserted) {
+    const int assignmentId = currentAssignmentId;
+
+    DbExecutor::instance().submit(
+        "SELECT * FROM sp_get_submissions_for_teacher(?, ?::integer[])",
+        {m_teacherId, Database::intArrayLiteral(ids.values())}, this,
+        [this, ids, inserted, assignmentId](const DbResult &res) {
+            if (!res.ok || assignmentId != currentAssignmentId) return;
+
+            QSet<int> found;
+            for (const DbRow &r : res.rows) {
+                const int id = r.value(0).toInt();
+                found.insert(id);
+                // Новое отправление встаёт на своё место (uploaded_at DESC), если его
+                // страница уже загружена; изменение незагруженной строки не нужно
+                if (inserted.contains(id)) m_submissions->upsert(r);
+                else m_submissions->update(r);
+            }
+            for (int id : ids) {
+                if (!found.contains(id)) m_submissions->removeId(id);
+            }
+        }, DbExecutor::ReadFrom::Primary);
+}
 
-    auto *fileItem = tblSubmissions->item(row, 1);
-    if (!fileItem) {
+void TeacherWindow::onDownloadSubmission() {
+    const QModelIndex current = tblSubmissions->currentIndex();
+    if (!tblSubmissions->selectionModel()->hasSelection() || !current.isValid()) {
         QMessageBox::warning(this, "Ошибка", "Выберите отправление");
         return;
     }
 
-    int subId = fileItem->data(Qt::UserRole).toInt();
+    const SubmissionRow sub = m_submissions->rowAt(m_submissionsProxy->sourceRow(current.row()));
+    const int subId = sub.id;
     if (subId <= 0) {
         QMessageBox::warning(this, "Ошибка", "Некорректная запись");
         return;
     }
 
-    QString filePath = fileItem->data(Qt::UserRole + 1).toString();
-    QString originalName = fileItem->text();
+    const QString filePath = sub.filePath;
+    const QString originalName = sub.originalName;
 
     if (filePath.trimmed().isEmpty()) {
         QMessageBox::warning(this, "Ошибка", "Запись не найдена");
         return;
     }
 
+    const QString encFilePath = storageAbs(QString("files/%1").arg(filePath));
+
+    QString safeName = QFileInfo(originalName).fileName();
+    safeName.replace("/", "_");
+    safeName.replace("\\", "_");
+
+    QString tmpPath = QDir::temp().filePath(QString("edudesk_sub_%1_%2").arg(subId).arg(safeName));
+    QFile::remove(tmpPath);
+
+    // Отправления прошлых семестров лежат в архивных сегментах
+    if (!QFileInfo::exists(encFilePath)) {
+        QString aerr;
+        if (!archive::extractSubmission(m_teacherId, subId, tmpPath, &aerr)) {
+            QMessageBox::warning(this, "Ошибка", aerr);
+            return;
+        }
+        openDownloaded(subId, tmpPath);
+        return;
+    }
+
     QString uuid = QFileInfo(filePath).baseName();
     const QString metaPath = storageAbs(QString("metadata/%1.json").arg(uuid));
 
@@ -266,25 +477,16 @@ void TeacherWindow::onDownloadSubmission() {
         return;
     }
 
-    const QString encFilePath = storageAbs(QString("files/%1").arg(filePath));
-    if (!QFileInfo::exists(encFilePath)) {
-        QMessageBox::warning(this, "Ошибка", "Зашифрованный файл не найден");
-        return;
-    }
-
-    QString safeName = QFileInfo(originalName).fileName();
-    safeName.replace("/", "_");
-    safeName.replace("\\", "_");
-
-    QString tmpPath = QDir::temp().filePath(QString("edudesk_sub_%1_%2").arg(subId).arg(safeName));
-    QFile::remove(tmpPath);
-
     std::string serr;
     if (!crypto::aes256_cbc_decrypt(fileKey, fileIv, encFilePath.toStdString(), tmpPath.toStdString(), serr)) {
         QMessageBox::critical(this, "Ошибка расшифровки файла", QString::fromStdString(serr));
         return;
     }
 
+    openDownloaded(subId, tmpPath);
+}
+
+void TeacherWindow::openDownloaded(int subId, const QString &tmpPath) {
     const QString absTmp = QFileInfo(tmpPath).absoluteFilePath();
 
     QFile::Permissions perms = QFile::permissions(absTmp);
@@ -314,54 +516,103 @@ void TeacherWindow::onDownloadSubmission() {
 }
 
 void TeacherWindow::onGradeSubmission() {
-    auto sel = tblSubmissions->selectedItems();
-    if (sel.isEmpty()) {
+    QList<int> rows;
+    for (const QModelIndex &idx : tblSubmissions->selectionModel()->selectedRows(1)) rows.append(idx.row());
+    // В диалоге — в порядке таблицы, дальше работаем со строками модели
+    std::sort(rows.begin(), rows.end());
+    for (int &row : rows) row = m_submissionsProxy->sourceRow(row);
+    if (rows.isEmpty()) {
         QMessageBox::warning(this, "Ошибка", "Выберите отправление");
         return;
     }
 
-    int row = tblSubmissions->currentRow();
-    if (row < 0) {
-        QMessageBox::warning(this, "Ошибка", "Выберите отправление");
-        return;
-    }
+    QDialog dlg(this);
+    dlg.setWindowTitle(rows.size() == 1 ? QString("Оценка") : QString("Оценка: %1 работ").arg(rows.size()));
+    dlg.resize(700, 400);
+    QVBoxLayout *vl = new QVBoxLayout(&dlg);
 
-    auto *fileItem = tblSubmissions->item(row, 1);
-    if (!fileItem) {
-        QMessageBox::warning(this, "Ошибка", "Выберите отправление");
-        return;
-    }
+    // Оценка и комментарий редактируются в таблице, остальные колонки — только для чтения
+    QTableWidget *tbl = new QTableWidget(rows.size(), 4, &dlg);
+    tbl->setHorizontalHeaderLabels({"Студент", "Файл", "Оценка", "Комментарий"});
+    tbl->horizontalHeader()->setStretchLastSection(true);
+    tbl->setEditTriggers(QAbstractItemView::AllEditTriggers);
+    vl->addWidget(tbl);
+
+    for (int i = 0; i < rows.size(); ++i) {
+        const SubmissionRow &src = m_submissions->rowAt(rows[i]);
+        if (src.id <= 0) {
+            QMessageBox::warning(this, "Ошибка", "Некорректная запись");
+            return;
+        }
 
-    int subId = fileItem->data(Qt::UserRole).toInt();
-    if (subId <= 0) {
-        QMessageBox::warning(this, "Ошибка", "Некорректная запись");
-        return;
+        auto *loginItem = new QTableWidgetItem(src.studentLogin);
+        loginItem->setFlags(loginItem->flags() & ~Qt::ItemIsEditable);
+        auto *fileItem = new QTableWidgetItem(src.originalName);
+        fileItem->setFlags(fileItem->flags() & ~Qt::ItemIsEditable);
+        fileItem->setData(Qt::UserRole, src.id);
+
+        tbl->setItem(i, 0, loginItem);
+        tbl->setItem(i, 1, fileItem);
+        tbl->setItem(i, 2, new QTableWidgetItem(src.grade));
+        tbl->setItem(i, 3, new QTableWidgetItem(src.feedback));
     }
 
-    bool ok;
-    QString grade = QInputDialog::getText(this, "Оценка", "Введите оценку:", QLineEdit::Normal, "", &ok);
-    if (!ok) return;
+    QHBoxLayout *hAll = new QHBoxLayout();
+    QLineEdit *allGrade = new QLineEdit(&dlg);
+    allGrade->setPlaceholderText("Оценка для всех");
+    QPushButton *btnAll = new QPushButton("Применить ко всем", &dlg);
+    hAll->addWidget(allGrade);
+    hAll->addWidget(btnAll);
+    hAll->addStretch();
+    vl->addLayout(hAll);
 
-    QString feedback = QInputDialog::getMultiLineText(this, "Комментарий", "Комментарий к работе:", QString(), &ok);
-    if (!ok) return;
+    connect(btnAll, &QPushButton::clicked, &dlg, [tbl, allGrade]() {
+        for (int i = 0; i < tbl->rowCount(); ++i) tbl->item(i, 2)->setText(allGrade->text());
+    });
 
-    QSqlDatabase db = Database::instance().get();
-    QSqlQuery q(db);
-    q.prepare("SELECT sp_set_submission_grade(?, ?, ?, ?)");
+    QHBoxLayout *h = new QHBoxLayout();
+    QPushButton *btnOk = new QPushButton("OK", &dlg);
+    QPushButton *btnCancel = new QPushButton("Отмена", &dlg);
+    h->addStretch();
+    h->addWidget(btnOk);
+    h->addWidget(btnCancel);
+    vl->addLayout(h);
+
+    connect(btnOk, &QPushButton::clicked, &dlg, &QDialog::accept);
+    connect(btnCancel, &QPushButton::clicked, &dlg, &QDialog::reject);
+
+    if (dlg.exec() != QDialog::Accepted) return;
+
+    QList<int> subIds;
+    QStringList grades;
+    QStringList feedbacks;
+    for (int i = 0; i < tbl->rowCount(); ++i) {
+        subIds.append(tbl->item(i, 1)->data(Qt::UserRole).toInt());
+        grades.append(tbl->item(i, 2)->text().trimmed());
+        feedbacks.append(tbl->item(i, 3)->text());
+    }
+
+    // Все оценки сохраняются одним вызовом; процедура возвращает обновлённые строки
+    QSqlQuery q = Database::instance().prepared(
+        "SELECT * FROM sp_set_submission_grades(?, ?::integer[], ?::text[], ?::text[])");
     q.addBindValue(m_teacherId);
-    q.addBindValue(subId);
-    q.addBindValue(grade);
-    q.addBindValue(feedback);
+    q.addBindValue(Database::intArrayLiteral(subIds));
+    q.addBindValue(Database::textArrayLiteral(grades));
+    q.addBindValue(Database::textArrayLiteral(feedbacks));
 
-    if (!q.exec()) {
-        QMessageBox::warning(this, "Ошибка", "Не удалось сохранить оценку: " + q.lastError().text());
+    if (!Database::exec(q)) {
+        QMessageBox::warning(this, "Ошибка", "Не удалось сохранить оценки: " + q.lastError().text());
         return;
     }
 
-    q.next();
+    Database::instance().noteWrite();
+    while (q.next()) m_submissions->update(dbRowFromQuery(q));
+    // NOTIFY о своих записях не приходят — счётчики задания перечитываем сами
+    if (currentAssignmentId > 0) refreshAssignmentRow(currentAssignmentId);
 
-    Logger::log(m_teacherId, "grade_submission", QString("submission_id=%1 grade=%2").arg(subId).arg(grade));
-    loadSubmissions(currentAssignmentId);
+    Logger::log(m_teacherId, "grade_submissions",
+                QString("count=%1 submission_ids=%2").arg(subIds.size()).arg(Database::intArrayLiteral(subIds)),
+                Logger::FileOnly);
 }
 
 void TeacherWindow::onCreateAssignment() {
@@ -378,25 +629,10 @@ void TeacherWindow::onCreateAssignment() {
 
     QDateTime due = QDateTime::currentDateTime().addDays(days);
 
-    QSqlDatabase db = Database::instance().get();
-    QSqlQuery q(db);
-    q.prepare("SELECT sp_create_assignment(?, ?, ?, ?)");
-    q.addBindValue(m_teacherId);
-    q.addBindValue(title);
-    q.addBindValue(desc);
-    q.addBindValue(due);
-
-    if (!q.exec() || !q.next()) {
-        QMessageBox::warning(this, "Ошибка", "Не удалось создать задание: " + q.lastError().text());
-        return;
-    }
-
-    int assignmentId = q.value(0).toInt();
-
-    QSqlQuery sq(db);
-    sq.prepare("SELECT * FROM sp_list_students(?)");
+    // Сначала собираем всё задание целиком; в базу оно попадает одним вызовом ниже
+    QSqlQuery sq = Database::instance().prepared("SELECT * FROM sp_list_students(?)");
     sq.addBindValue(m_teacherId);
-    if (!sq.exec()) {
+    if (!Database::exec(sq)) {
         QMessageBox::warning(this, "Ошибка", "Не удалось получить список студентов: " + sq.lastError().text());
         return;
     }
@@ -430,92 +666,87 @@ void TeacherWindow::onCreateAssignment() {
     connect(btnOk, &QPushButton::clicked, &dlg, &QDialog::accept);
     connect(btnCancel, &QPushButton::clicked, &dlg, &QDialog::reject);
 
+    if (dlg.exec() != QDialog::Accepted) return;
+
     QList<int> chosen;
-    if (dlg.exec() == QDialog::Accepted) {
-        for (int i = 0; i < lw->count(); ++i) {
-            QListWidgetItem *it = lw->item(i);
-            if (it->checkState() == Qt::Checked)
-                chosen.append(it->data(Qt::UserRole).toInt());
-        }
+    for (int i = 0; i < lw->count(); ++i) {
+        QListWidgetItem *it = lw->item(i);
+        if (it->checkState() == Qt::Checked)
+            chosen.append(it->data(Qt::UserRole).toInt());
     }
 
-    if (!chosen.isEmpty()) {
-        QSqlQuery insertq(db);
-        insertq.prepare("SELECT sp_assign_student_to_assignment(?, ?, ?)");
-        for (int sid : chosen) {
-            insertq.bindValue(0, m_teacherId);
-            insertq.bindValue(1, assignmentId);
-            insertq.bindValue(2, sid);
-            if (!insertq.exec()) {
-                QMessageBox::warning(this, "Ошибка", "Не удалось назначить студента: " + insertq.lastError().text());
-                return;
-            }
-            insertq.next();
-        }
-    }
+    const QStringList attached = QFileDialog::getOpenFileNames(this, "Прикрепить файлы к заданию (необязательно)");
 
-    QString attached = QFileDialog::getOpenFileName(this, "Прикрепить файл к заданию (необязательно)");
+    // Файлы копируются в хранилище до записи в БД; при ошибке вызова они удаляются
+    QStringList storedNames;
+    QStringList originalNames;
+    QStringList storedAbs;
     if (!attached.isEmpty()) {
         const QString assignmentsDir = storageAbs("assignments");
         QDir().mkpath(assignmentsDir);
 
-        QString uidSrc = title + QDateTime::currentDateTime().toString(Qt::ISODate) + QString::number(assignmentId);
-        QString uuid = QString::fromUtf8(QCryptographicHash::hash(uidSrc.toUtf8(), QCryptographicHash::Md5).toHex());
+        for (int i = 0; i < attached.size(); ++i) {
+            QString uidSrc = title + QDateTime::currentDateTime().toString(Qt::ISODate)
+                             + QString::number(m_teacherId) + QString::number(i);
+            QString uuid = QString::fromUtf8(QCryptographicHash::hash(uidSrc.toUtf8(), QCryptographicHash::Md5).toHex());
 
-        QString storedName = QString("%1_%2").arg(uuid, QFileInfo(attached).fileName());
-        const QString targetAbs = QDir(assignmentsDir).filePath(storedName);
+            QString storedName = QString("%1_%2").arg(uuid, QFileInfo(attached[i]).fileName());
+            const QString targetAbs = QDir(assignmentsDir).filePath(storedName);
 
-        QFile::remove(targetAbs);
-        if (!QFile::copy(attached, targetAbs)) {
-            QMessageBox::warning(this, "Ошибка", "Не удалось сохранить прикреплённый файл");
-        } else {
-            QSqlQuery fq(db);
-            fq.prepare("SELECT sp_add_assignment_file(?, ?, ?, ?)");
-            fq.addBindValue(m_teacherId);
-            fq.addBindValue(assignmentId);
-            fq.addBindValue(storedName);
-            fq.addBindValue(QFileInfo(attached).fileName());
-
-            if (!fq.exec()) {
-                QFile::remove(targetAbs);
-                QMessageBox::warning(this, "Ошибка", "Не удалось записать файл в БД: " + fq.lastError().text());
-            } else {
-                fq.next();
+            QFile::remove(targetAbs);
+            if (!QFile::copy(attached[i], targetAbs)) {
+                for (const QString &path : storedAbs) QFile::remove(path);
+                QMessageBox::warning(this, "Ошибка", "Не удалось сохранить прикреплённый файл: " + attached[i]);
+                return;
             }
+            storedNames.append(storedName);
+            originalNames.append(QFileInfo(attached[i]).fileName());
+            storedAbs.append(targetAbs);
         }
     }
 
+    QSqlQuery q = Database::instance().prepared(
+        "SELECT sp_create_assignment_full(?, ?, ?, ?, ?::integer[], ?::text[], ?::text[])");
+    q.addBindValue(m_teacherId);
+    q.addBindValue(title);
+    q.addBindValue(desc);
+    q.addBindValue(due);
+    q.addBindValue(Database::intArrayLiteral(chosen));
+    q.addBindValue(Database::textArrayLiteral(storedNames));
+    q.addBindValue(Database::textArrayLiteral(originalNames));
+
+    if (!Database::exec(q) || !q.next()) {
+        for (const QString &path : storedAbs) QFile::remove(path);
+        QMessageBox::warning(this, "Ошибка", "Не удалось создать задание: " + q.lastError().text());
+        return;
+    }
+
+    int assignmentId = q.value(0).toInt();
+    Database::instance().noteWrite();
+
     Logger::log(m_teacherId, "create_assignment",
-                QString("title=%1 assignment_id=%2 students=%3")
+                QString("title=%1 assignment_id=%2 students=%3 files=%4")
                     .arg(title)
                     .arg(assignmentId)
-                    .arg(QString::number(chosen.size())));
+                    .arg(chosen.size())
+                    .arg(storedNames.size()), Logger::FileOnly);
 
-    loadAssignments();
+    // Новое задание — в начало списка (id DESC), как при полной загрузке;
+    // остальные колонки дочитываются, NOTIFY о своей записи не приходит
+    if (m_assignments->findRow(assignmentId) < 0) m_assignments->upsert(DbRow{assignmentId, title});
+    refreshAssignmentRow(assignmentId);
     QMessageBox::information(this, "OK", "Задание создано");
 }
 
 void TeacherWindow::onDeleteAssignment() {
-    auto sel = tblAssignments->selectedItems();
-    if (sel.isEmpty()) {
+    const QModelIndex current = tblAssignments->currentIndex();
+    if (!tblAssignments->selectionModel()->hasSelection() || !current.isValid()) {
         QMessageBox::warning(this, "Ошибка", "Выберите задание");
         return;
     }
 
-    int row = tblAssignments->currentRow();
-    if (row < 0) {
-        QMessageBox::warning(this, "Ошибка", "Выберите задание");
-        return;
-    }
-
-    auto *item = tblAssignments->item(row, 0);
-    if (!item) {
-        QMessageBox::warning(this, "Ошибка", "Выберите задание");
-        return;
-    }
-
-    int assignmentId = item->data(Qt::UserRole).toInt();
-    QString title = item->text();
+    const int assignmentId = m_assignments->rowAt(current.row()).id;
+    const QString title = m_assignments->rowAt(current.row()).title;
 
     if (QMessageBox::question(
             this, "Удалить задание",
@@ -524,12 +755,11 @@ void TeacherWindow::onDeleteAssignment() {
         return;
     }
 
-    QSqlQuery q(Database::instance().get());
-    q.prepare("SELECT sp_delete_assignment(?, ?)");
+    QSqlQuery q = Database::instance().prepared("SELECT sp_delete_assignment(?, ?)");
     q.addBindValue(assignmentId);
     q.addBindValue(m_teacherId);
 
-    if (!q.exec()) {
+    if (!Database::exec(q)) {
         QString err = q.lastError().text();
         if (err.contains("forbidden")) {
             QMessageBox::warning(this, "Ошибка", "Вы можете удалять только свои задания");
@@ -541,8 +771,35 @@ void TeacherWindow::onDeleteAssignment() {
 
     q.next();
 
-    Logger::log(m_teacherId, "delete_assignment", QString("assignment_id=%1").arg(assignmentId));
-    loadAssignments();
+    Database::instance().noteWrite();
+    Logger::log(m_teacherId, "delete_assignment", QString("assignment_id=%1").arg(assignmentId), Logger::FileOnly);
+    m_assignments->removeId(assignmentId);
     clearSubmissions();
     QMessageBox::information(this, "OK", "Задание удалено");
 }
+
+void TeacherWindow::onExportGradebook() {
+    const QString path = QFileDialog::getSaveFileName(this, "Экспорт оценок", "gradebook.csv", "CSV (*.csv)");
+    if (path.isEmpty()) return;
+
+    btnExport->setEnabled(false);
+
+    const int teacherId = m_teacherId;
+    QPointer<TeacherWindow> self(this);
+    QThreadPool::globalInstance()->start(new GradebookExportTask(teacherId, path,
+        [self, teacherId, path](const GradebookExportResult &res) {
+            // Выгрузка всех оценок курса — в журнал, даже если окно уже закрыто
+            if (res.ok) {
+                Logger::log(teacherId, "export_gradebook",
+                            QString("students=%1 ms=%2 path=%3").arg(res.rows).arg(res.ms).arg(path));
+            }
+            if (!self) return;
+
+            self->btnExport->setEnabled(true);
+            if (!res.ok) {
+                QMessageBox::warning(self, "Ошибка", res.error);
+                return;
+            }
+            QMessageBox::information(self, "OK", QString("Выгружено студентов: %1").arg(res.rows));
+        }));
+}
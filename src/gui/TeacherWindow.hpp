@@ -1,8 +1,17 @@
 #pragma once
 
 #include <QWidget>
-#include <QTableWidget>
+#include <QTableView>
 #include <QPushButton>
+#include <QLineEdit>
+#include <QSet>
+#include <QTimer>
+
+#include "../db/DbExecutor.hpp"
+
+class AssignmentModel;
+class SubmissionModel;
+class SortFilterModel;
 
 class TeacherWindow : public QWidget {
     Q_OBJECT
@@ -12,26 +21,53 @@ public:
 
 private slots:
     void loadAssignments();
-    void onAssignmentSelected(int row, int col);
+    void onAssignmentSelected(const QModelIndex &index);
     void loadSubmissions(int assignmentId);
+    void onSubmissionsPageLoaded(bool first);
     void onDownloadSubmission();
     void onGradeSubmission();
     void onCreateAssignment();
     void onDeleteAssignment();
+    void onExportGradebook();
+    void onSearch();
+    void onAssignmentChanged(int assignmentId, int createdBy, const QString &op);
+    void onSubmissionChanged(int submissionId, int assignmentId, int studentId, const QString &op);
+    void flushChanges();
 
 private:
     int m_teacherId;
 
-    QTableWidget *tblAssignments = nullptr;
-    QTableWidget *tblSubmissions = nullptr;
+    QTableView *tblAssignments = nullptr;
+    QTableView *tblSubmissions = nullptr;
+    AssignmentModel *m_assignments = nullptr;
+    SubmissionModel *m_submissions = nullptr;
+    SortFilterModel *m_submissionsProxy = nullptr;
+    QLineEdit *edSearch = nullptr;
+    QLineEdit *edSubmissionsFilter = nullptr;
 
     QPushButton *btnRefresh = nullptr;
     QPushButton *btnDownload = nullptr;
     QPushButton *btnGrade = nullptr;
     QPushButton *btnCreateAssignment = nullptr;
     QPushButton *btnDeleteAssignment = nullptr;
+    QPushButton *btnExport = nullptr;
 
     int currentAssignmentId = -1;
 
+    // Отправление из результатов поиска: выделяется, когда дойдёт его страница
+    int m_focusSubmissionId = 0;
+
+    // NOTIFY копятся до ближайшего прохода цикла событий и перечитываются разом
+    QTimer *m_changesTimer = nullptr;
+    QSet<int> m_changedAssignments;
+    QSet<int> m_changedSubmissions;
+    QSet<int> m_insertedSubmissions;
+
     void clearSubmissions();
+    void focusSubmission();
+    void refreshAssignmentRow(int assignmentId);
+    void refreshSubmissionRows(const QSet<int> &ids, const QSet<int> &inserted);
+    void showAssignment(int assignmentId, int focusSubmissionId = 0);
+    /// Открывает расшифрованную копию во внешней программе и пишет в журнал.
+    void openDownloaded(int subId, const QString &tmpPath);
 };
@@ -0,0 +1,55 @@
+#include "UserModel.hpp"
+
+UserModel::UserModel(int adminId, QObject *parent)
+    : RowListModel<UserRow>({"Login", "Full name", "Role"}, kPageSize, parent), m_adminId(adminId) {}
+
+QString UserModel::pageSql(const QVariantList &) const {
+    return QStringLiteral("SELECT * FROM sp_admin_list_users_page(?, ?, ?)");
+}
+
+QVariantList UserModel::pageBinds(const QVariantList &after) const {
+    return {m_adminId, after.value(0, QVariant(QVariant::Int)), kPageSize};
+}
+
+UserRow UserModel::makeRow(const DbRow &r) const {
+    UserRow row;
+    row.id = r.value(0).toInt();
+    row.login = r.value(1).toString();
+    row.fullName = r.value(2).toString();
+    row.role = r.value(3).toString();
+    return row;
+}
+
+// Список упорядочен по id
+int UserModel::insertPosition(const UserRow &row) const {
+    const auto it = std::lower_bound(m_rows.cbegin(), m_rows.cend(), row.id,
+                                     [](const UserRow &r, int id) { return r.id < id; });
+    return static_cast<int>(it - m_rows.cbegin());
+}
+
+UserModel::SortKeyFn UserModel::sortKeyFn() const {
+    return [](const UserRow &row, int column) {
+        switch (column) {
+        case 0: return SortKey::string(row.login);
+        case 1: return SortKey::string(row.fullName);
+        case 2: return SortKey::string(row.role);
+        }
+        return SortKey();
+    };
+}
+
+UserModel::FilterTextFn UserModel::filterTextFn() const {
+    return [](const UserRow &row) -> QString { return row.login + QLatin1Char('\n') + row.fullName; };
+}
+
+QVariant UserModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= m_rows.size() || role != Qt::DisplayRole) return QVariant();
+
+    const UserRow &row = m_rows[index.row()];
+    switch (index.column()) {
+    case 0: return row.login;
+    case 1: return row.fullName;
+    case 2: return row.role;
+    }
+    return QVariant();
+}
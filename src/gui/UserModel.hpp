@@ -0,0 +1,31 @@
+#pragma once
+
+#include "DbListModel.hpp"
+
+struct UserRow {
+    int id = 0;
+    QString login;
+    QString fullName;
+    QString role;
+};
+
+/// Пользователи для администратора, постранично по id (sp_admin_list_users_page).
+class UserModel : public RowListModel<UserRow> {
+public:
+    static constexpr int kPageSize = 200;
+
+    explicit UserModel(int adminId, QObject *parent = nullptr);
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+protected:
+    QString pageSql(const QVariantList &after) const override;
+    QVariantList pageBinds(const QVariantList &after) const override;
+    UserRow makeRow(const DbRow &r) const override;
+    int insertPosition(const UserRow &row) const override;
+    SortKeyFn sortKeyFn() const override;
+    FilterTextFn filterTextFn() const override;
+
+private:
+    int m_adminId;
+};
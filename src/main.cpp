@@ -1,34 +1,17 @@
 #include <QApplication>
 #include <QDebug>
-#include <QCoreApplication>
-#include <QDir>
-#include <QFileInfo>
 
 #include <sodium.h>
 
 #include "db/Database.hpp"
+#include "db/DbExecutor.hpp"
+#include "db/ChangeListener.hpp"
+#include "db/QueryStats.hpp"
+#include "utils/Logger.hpp"
 #include "config/ConfigManager.hpp"
 #include "gui/LoginWindow.hpp"
 #include "gui/MainWindow.hpp"
 
-static QString findConfigPath() {
-    const QString appDir = QCoreApplication::applicationDirPath();
-
-    const QString p1 = QDir(appDir).filePath("config/config.json");
-    if (QFileInfo(p1).exists()) return p1;
-
-    const QString p2 = QDir(appDir).filePath("config.json");
-    if (QFileInfo(p2).exists()) return p2;
-
-    const QString p3 = QDir::current().filePath("config/config.json");
-    if (QFileInfo(p3).exists()) return p3;
-
-    const QString p4 = QDir::current().filePath("config.json");
-    if (QFileInfo(p4).exists()) return p4;
-
-    return QString();
-}
-
 int main(int argc, char *argv[]) {
     QApplication a(argc, argv);
 
@@ -37,7 +20,7 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
-    const QString cfg = findConfigPath();
+    const QString cfg = QString::fromStdString(ConfigManager::findConfigPath());
     if (cfg.isEmpty()) {
         qCritical() << "Ошибка: не найден config.json";
         return 1;
@@ -53,6 +36,10 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
+    if (!ChangeListener::instance().start()) {
+        qWarning() << "LISTEN/NOTIFY недоступен: окна будут обновляться только вручную";
+    }
+
     LoginWindow *login = new LoginWindow();
     login->show();
 
@@ -64,6 +51,10 @@ int main(int argc, char *argv[]) {
     });
 
     const int res = a.exec();
+    Logger::shutdown();
+    ChangeListener::instance().stop();
+    DbExecutor::instance().shutdown();
     Database::instance().close();
+    QueryStats::instance().writeReport(QStringLiteral("logs/query_stats.log"));
     return res;
 }
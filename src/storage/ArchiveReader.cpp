@@ -0,0 +1,39 @@
+#include "ArchiveReader.hpp"
+#include "ArchiveSegment.hpp"
+#include "../config/ConfigManager.hpp"
+#include "../db/Database.hpp"
+
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVariant>
+
+namespace archive {
+
+bool extractSubmission(int userId, int submissionId, const QString &outPath, QString *error) {
+    QSqlQuery q = Database::instance().prepared("SELECT * FROM sp_get_archived_submission(?, ?)");
+    q.addBindValue(userId);
+    q.addBindValue(submissionId);
+    if (!Database::exec(q)) {
+        if (error) *error = q.lastError().text();
+        return false;
+    }
+    if (!q.next()) {
+        if (error) *error = QStringLiteral("Файл не найден ни в хранилище, ни в архиве");
+        return false;
+    }
+
+    const QString segment = q.value(0).toString();
+    const qint64 offset = q.value(1).toLongLong();
+
+    const auto master = ConfigManager::instance().masterKey();
+    if (master.empty()) {
+        if (error) *error = QStringLiteral("Мастер-ключ не загружен");
+        return false;
+    }
+
+    Entry entry;
+    if (!readEntry(segmentPath(segment), offset, entry, error)) return false;
+    return extractEntry(entry, master, outPath, error);
+}
+
+} // namespace archive
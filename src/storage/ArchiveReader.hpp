@@ -0,0 +1,13 @@
+#pragma once
+
+#include <QString>
+
+/// Скачивание отправлений, перенесённых в архивные сегменты (см. ArchiveSegment.hpp).
+namespace archive {
+
+/// Находит архивное отправление через sp_get_archived_submission (с проверкой прав
+/// userId) и расшифровывает его в outPath. false и текст в error, если отправления
+/// нет в архиве, нет доступа или сегмент повреждён.
+bool extractSubmission(int userId, int submissionId, const QString &outPath, QString *error = nullptr);
+
+} // namespace archive
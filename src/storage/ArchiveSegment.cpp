@@ -0,0 +1,130 @@
+#include "ArchiveSegment.hpp"
+#include "../config/ConfigManager.hpp"
+#include "../crypto/FileCrypto.hpp"
+#include "../crypto/KeyProtect.hpp"
+
+#include <QDataStream>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+#include <string>
+
+namespace archive {
+
+static const char kMagic[4] = {'E', 'D', 'A', '1'};
+// magic + flags + длина metadata + длина данных
+static constexpr int kHeaderSize = 4 + 1 + 4 + 8;
+// Защита от мусорного смещения: metadata — небольшой JSON
+static constexpr quint32 kMaxMetaSize = 64 * 1024;
+
+static bool fail(QString *error, const QString &msg) {
+    if (error) *error = msg;
+    return false;
+}
+
+static std::vector<unsigned char> fromBase64(const QJsonObject &o, const char *key) {
+    const QByteArray raw = QByteArray::fromBase64(o.value(QLatin1String(key)).toString().toUtf8());
+    return std::vector<unsigned char>(raw.constData(), raw.constData() + raw.size());
+}
+
+QString segmentPath(const QString &segment) {
+    // Имя приходит из БД — только имя файла, без каталогов
+    const QString name = QFileInfo(segment).fileName();
+    return QString::fromStdString(ConfigManager::instance().storagePath("archive/" + name.toStdString()));
+}
+
+bool appendEntry(QFile &segment, const Entry &entry, qint64 *offset, QString *error) {
+    const qint64 start = segment.size();
+    if (!segment.seek(start)) return fail(error, segment.errorString());
+
+    QByteArray header;
+    {
+        QDataStream ds(&header, QIODevice::WriteOnly);
+        ds.setByteOrder(QDataStream::BigEndian);
+        ds.writeRawData(kMagic, sizeof(kMagic));
+        ds << entry.flags << static_cast<quint32>(entry.meta.size()) << static_cast<quint64>(entry.data.size());
+    }
+
+    if (segment.write(header) != header.size()
+        || segment.write(entry.meta) != entry.meta.size()
+        || segment.write(entry.data) != entry.data.size()) {
+        // Недописанная запись не должна остаться в хвосте сегмента
+        const QString msg = segment.errorString();
+        segment.resize(start);
+        return fail(error, msg);
+    }
+
+    if (offset) *offset = start;
+    return true;
+}
+
+bool readEntry(const QString &path, qint64 offset, Entry &entry, QString *error) {
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) return fail(error, QStringLiteral("cannot open segment: ") + path);
+    if (offset < 0 || !f.seek(offset)) return fail(error, QStringLiteral("invalid segment offset"));
+
+    const QByteArray header = f.read(kHeaderSize);
+    if (header.size() != kHeaderSize || !header.startsWith(QByteArray(kMagic, sizeof(kMagic))))
+        return fail(error, QStringLiteral("bad segment entry header"));
+
+    QDataStream ds(header.mid(sizeof(kMagic)));
+    ds.setByteOrder(QDataStream::BigEndian);
+    quint8 flags = 0;
+    quint32 metaLen = 0;
+    quint64 dataLen = 0;
+    ds >> flags >> metaLen >> dataLen;
+
+    if (metaLen > kMaxMetaSize || dataLen > static_cast<quint64>(f.size() - f.pos()))
+        return fail(error, QStringLiteral("bad segment entry length"));
+
+    entry.flags = flags;
+    entry.meta = f.read(metaLen);
+    entry.data = f.read(static_cast<qint64>(dataLen));
+    if (entry.meta.size() != static_cast<int>(metaLen) || static_cast<quint64>(entry.data.size()) != dataLen)
+        return fail(error, QStringLiteral("truncated segment entry"));
+    return true;
+}
+
+bool unwrapFileKey(const QByteArray &meta, const std::vector<unsigned char> &master,
+                   std::vector<unsigned char> &fileKey, QString *error) {
+    const QJsonDocument jd = QJsonDocument::fromJson(meta);
+    if (!jd.isObject()) return fail(error, QStringLiteral("invalid metadata"));
+    const QJsonObject mo = jd.object();
+
+    std::string err;
+    if (!keyprotect::decryptWithAesGcm(master, fromBase64(mo, "key_encrypted"), fromBase64(mo, "key_iv"),
+                                       fromBase64(mo, "key_tag"), fileKey, err)) {
+        return fail(error, QString::fromStdString(err));
+    }
+    return true;
+}
+
+bool extractEntry(const Entry &entry, const std::vector<unsigned char> &master,
+                  const QString &outPath, QString *error) {
+    std::vector<unsigned char> fileKey;
+    if (!unwrapFileKey(entry.meta, master, fileKey, error)) return false;
+
+    std::string err;
+    std::vector<unsigned char> plain;
+    if (!crypto::decryptBuffer(fileKey, reinterpret_cast<const unsigned char *>(entry.data.constData()),
+                               static_cast<std::size_t>(entry.data.size()), plain, err)) {
+        return fail(error, QString::fromStdString(err));
+    }
+
+    QByteArray content(reinterpret_cast<const char *>(plain.data()), static_cast<int>(plain.size()));
+    if (entry.flags & kCompressed) {
+        content = qUncompress(content);
+        if (content.isEmpty() && !plain.empty()) return fail(error, QStringLiteral("qUncompress failed"));
+    }
+
+    QSaveFile out(outPath);
+    if (!out.open(QIODevice::WriteOnly)) return fail(error, QStringLiteral("cannot open output file"));
+    if (out.write(content) != content.size() || !out.commit())
+        return fail(error, QStringLiteral("failed to write output file"));
+    return true;
+}
+
+} // namespace archive
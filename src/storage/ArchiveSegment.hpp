@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+#include <vector>
+
+class QFile;
+
+/// Архивные сегменты: отправления прошлых семестров упакованы подряд в файлы
+/// storage/archive/<segment> вместо пары files/<uuid>.dat + metadata/<uuid>.json.
+/// Запись сегмента: заголовок (magic "EDA1", флаги, длины, big-endian), JSON
+/// metadata как был и зашифрованные данные. Данные либо скопированы из files/
+/// без изменений, либо сжаты qCompress и зашифрованы тем же ключом файла
+/// с новым nonce (флаг kCompressed) — выбирает упаковщик по выигрышу.
+namespace archive {
+
+enum EntryFlag : quint8 {
+    kCompressed = 0x01,
+};
+
+struct Entry {
+    QByteArray meta;
+    QByteArray data;
+    quint8 flags = 0;
+};
+
+/// Абсолютный путь сегмента в хранилище.
+QString segmentPath(const QString &segment);
+
+/// Дописывает запись в конец открытого на запись сегмента; offset — смещение её заголовка.
+bool appendEntry(QFile &segment, const Entry &entry, qint64 *offset, QString *error = nullptr);
+
+/// Читает одну запись по смещению, не загружая остальной сегмент.
+bool readEntry(const QString &path, qint64 offset, Entry &entry, QString *error = nullptr);
+
+/// Ключ файла из metadata (key_encrypted/key_iv/key_tag), расшифрованный мастер-ключом.
+bool unwrapFileKey(const QByteArray &meta, const std::vector<unsigned char> &master,
+                   std::vector<unsigned char> &fileKey, QString *error = nullptr);
+
+/// Расшифровывает (и при kCompressed распаковывает) запись в исходный файл outPath.
+bool extractEntry(const Entry &entry, const std::vector<unsigned char> &master,
+                  const QString &outPath, QString *error = nullptr);
+
+} // namespace archive
@@ -0,0 +1,268 @@
+// Перенос отправлений старше даты отсечки в архивный уровень: зашифрованные файлы
+// и metadata упаковываются в сегменты storage/archive/<segment>, строки переезжают
+// из submissions в archive.submissions (sp_archive_submissions). Скачивание из окон
+// продолжает работать: если files/<path> нет, файл читается из сегмента.
+//
+//   archive_submissions --before 2025-09-01 [--batch 200] [--segment-mb 256] [--dry-run]
+//
+// Порядок для каждой пачки: записи дописываются в сегмент и сбрасываются на диск,
+// затем одна транзакция переносит строки, и только после неё удаляются горячие файлы.
+// Сбой посередине оставляет лишь неиспользуемый хвост сегмента, но не теряет данных.
+
+#include <iostream>
+#include <string>
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDate>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QStringList>
+
+#include <sodium.h>
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+#include "db/PgConnection.hpp"
+#include "config/ConfigManager.hpp"
+#include "crypto/FileCrypto.hpp"
+#include "storage/ArchiveSegment.hpp"
+
+static QString storageAbs(const QString &rel) {
+    return QString::fromStdString(ConfigManager::instance().storagePath(rel.toStdString()));
+}
+
+static bool readFile(const QString &path, QByteArray &out) {
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) return false;
+    out = f.readAll();
+    return true;
+}
+
+template <typename T>
+static QString arrayLiteral(const QList<T> &values) {
+    QStringList parts;
+    parts.reserve(values.size());
+    for (const T &v : values) parts << QString::number(v);
+    return QLatin1Char('{') + parts.join(QLatin1Char(',')) + QLatin1Char('}');
+}
+
+// Сжимает открытый текст и шифрует заново тем же ключом файла, если это даёт хотя бы 10%.
+// Иначе запись остаётся с исходным шифротекстом (уже сжатые форматы: pdf, zip, jpeg).
+static void tryCompress(archive::Entry &entry, const std::vector<unsigned char> &master) {
+    std::vector<unsigned char> fileKey;
+    QString error;
+    if (!archive::unwrapFileKey(entry.meta, master, fileKey, &error)) return;
+
+    std::string err;
+    std::vector<unsigned char> plain;
+    if (!crypto::decryptBuffer(fileKey, reinterpret_cast<const unsigned char *>(entry.data.constData()),
+                               static_cast<std::size_t>(entry.data.size()), plain, err)) {
+        return;
+    }
+
+    const QByteArray packed = qCompress(plain.data(), static_cast<int>(plain.size()), 9);
+    if (static_cast<std::size_t>(packed.size()) >= plain.size() / 10 * 9) return;
+
+    std::vector<unsigned char> cipher;
+    if (!crypto::encryptBuffer(fileKey, crypto::genRandomBytes(crypto_secretbox_NONCEBYTES),
+                               reinterpret_cast<const unsigned char *>(packed.constData()),
+                               static_cast<std::size_t>(packed.size()), cipher, err)) {
+        return;
+    }
+
+    entry.data = QByteArray(reinterpret_cast<const char *>(cipher.data()), static_cast<int>(cipher.size()));
+    entry.flags |= archive::kCompressed;
+}
+
+static QString newSegmentName(int seq) {
+    return QStringLiteral("%1-%2.eda")
+        .arg(QDateTime::currentDateTimeUtc().toString("yyyyMMdd-HHmmss"))
+        .arg(seq, 3, 10, QLatin1Char('0'));
+}
+
+// Данные сегмента должны быть на диске до коммита переноса строк
+static bool syncSegment(QFile &segment) {
+    if (!segment.flush()) return false;
+#ifdef Q_OS_UNIX
+    return ::fsync(segment.handle()) == 0;
+#else
+    return true;
+#endif
+}
+
+int main(int argc, char **argv) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser p;
+    p.setApplicationDescription("Move old submissions into packed archive segments");
+    p.addHelpOption();
+
+    const QCommandLineOption before("before", "Archive submissions uploaded before this date (YYYY-MM-DD).", "date");
+    const QCommandLineOption batch("batch", "Submissions per transaction.", "n", "200");
+    const QCommandLineOption segmentMb("segment-mb", "Start a new segment after this size, MiB.", "n", "256");
+    const QCommandLineOption dryRun("dry-run", "Only report what would be archived.");
+    p.addOptions({before, batch, segmentMb, dryRun});
+    p.process(app);
+
+    const QDate cutoff = QDate::fromString(p.value(before), Qt::ISODate);
+    if (!cutoff.isValid()) {
+        std::cerr << "Ошибка: укажите --before в формате YYYY-MM-DD\n";
+        return 1;
+    }
+    const int batchSize = p.value(batch).toInt();
+    const qint64 segmentLimit = p.value(segmentMb).toLongLong() * 1024 * 1024;
+    if (batchSize <= 0 || segmentLimit <= 0) {
+        std::cerr << "Ошибка: --batch и --segment-mb должны быть положительными\n";
+        return 1;
+    }
+    const bool dry = p.isSet(dryRun);
+
+    if (sodium_init() == -1) {
+        std::cerr << "Ошибка: sodium_init() failed\n";
+        return 1;
+    }
+
+    const QString cfg = QString::fromStdString(ConfigManager::findConfigPath());
+    if (cfg.isEmpty() || !ConfigManager::instance().load(cfg.toStdString())) {
+        std::cerr << "Ошибка: не удалось загрузить config.json\n";
+        return 1;
+    }
+    if (!ConfigManager::instance().ensureStorageLayout()) {
+        std::cerr << "Ошибка: не удалось подготовить директории хранилища\n";
+        return 1;
+    }
+    const auto master = ConfigManager::instance().masterKey();
+    if (master.empty()) {
+        std::cerr << "Ошибка: мастер-ключ пустой в config.json\n";
+        return 1;
+    }
+
+    PgConnection conn;
+    if (!conn.open()) {
+        std::cerr << "Ошибка: не удалось подключиться к PostgreSQL\n";
+        return 1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    int segmentSeq = 0;
+    QString segmentName;
+    QFile segment;
+    auto openSegment = [&]() {
+        segmentName = newSegmentName(++segmentSeq);
+        segment.setFileName(archive::segmentPath(segmentName));
+        return segment.open(QIODevice::ReadWrite | QIODevice::Append);
+    };
+    if (!dry && !openSegment()) {
+        std::cerr << "Ошибка: не удалось создать сегмент " << segment.fileName().toStdString() << "\n";
+        return 1;
+    }
+
+    int afterId = 0;
+    qint64 archived = 0, skipped = 0, sourceBytes = 0, storedBytes = 0;
+
+    for (;;) {
+        PgResult cand = conn.exec("SELECT * FROM sp_archive_candidates($1, $2, $3)",
+                                  {cutoff, afterId, batchSize});
+        if (!cand.ok()) {
+            std::cerr << "Ошибка: sp_archive_candidates: " << cand.error().toStdString() << "\n";
+            return 1;
+        }
+        if (cand.rows() == 0) break;
+
+        const qint64 batchStart = dry ? 0 : segment.size();
+        QList<int> ids;
+        QList<qint64> offsets;
+        QHash<int, QString> filePaths;
+
+        for (int i = 0; i < cand.rows(); ++i) {
+            const int id = cand.value(i, 0).toInt();
+            const QString filePath = cand.value(i, 1);
+            afterId = id;
+
+            const QString uuid = QFileInfo(filePath).baseName();
+            archive::Entry entry;
+            if (!readFile(storageAbs(QStringLiteral("files/%1").arg(filePath)), entry.data)
+                || !readFile(storageAbs(QStringLiteral("metadata/%1.json").arg(uuid)), entry.meta)) {
+                std::cerr << "Пропуск " << id << ": нет файла или metadata для " << filePath.toStdString() << "\n";
+                ++skipped;
+                continue;
+            }
+
+            sourceBytes += entry.data.size() + entry.meta.size();
+            tryCompress(entry, master);
+            storedBytes += entry.data.size() + entry.meta.size();
+
+            if (!dry) {
+                qint64 offset = 0;
+                QString error;
+                if (!archive::appendEntry(segment, entry, &offset, &error)) {
+                    std::cerr << "Ошибка: запись в сегмент: " << error.toStdString() << "\n";
+                    segment.resize(batchStart);
+                    return 1;
+                }
+                offsets << offset;
+            }
+            ids << id;
+            filePaths.insert(id, filePath);
+        }
+
+        if (dry || ids.isEmpty()) {
+            archived += ids.size();
+            continue;
+        }
+
+        if (!syncSegment(segment)) {
+            std::cerr << "Ошибка: не удалось сбросить сегмент на диск\n";
+            segment.resize(batchStart);
+            return 1;
+        }
+
+        PgResult moved = conn.exec("SELECT sp_archive_submissions($1::integer[], $2, $3::bigint[])",
+                                   {arrayLiteral(ids), segmentName, arrayLiteral(offsets)});
+        if (!moved.ok()) {
+            std::cerr << "Ошибка: sp_archive_submissions: " << moved.error().toStdString() << "\n";
+            segment.resize(batchStart);
+            return 1;
+        }
+
+        // Горячие копии удаляются только для строк, которые действительно переехали;
+        // записи удалённых тем временем отправлений остаются мёртвым хвостом сегмента
+        QString list = moved.value(0, 0);
+        list.remove(QLatin1Char('{')).remove(QLatin1Char('}'));
+        for (const QString &s : list.split(QLatin1Char(','))) {
+            const int id = s.toInt();
+            if (id <= 0) continue;
+            const QString filePath = filePaths.value(id);
+            QFile::remove(storageAbs(QStringLiteral("files/%1").arg(filePath)));
+            QFile::remove(storageAbs(QStringLiteral("metadata/%1.json").arg(QFileInfo(filePath).baseName())));
+            ++archived;
+        }
+
+        if (segment.size() >= segmentLimit) {
+            segment.close();
+            if (!openSegment()) {
+                std::cerr << "Ошибка: не удалось создать сегмент " << segment.fileName().toStdString() << "\n";
+                return 1;
+            }
+        }
+    }
+
+    if (!dry) {
+        segment.close();
+        if (segment.size() == 0) segment.remove();
+    }
+
+    std::cerr << (dry ? "Будет перенесено: " : "Перенесено: ") << archived
+              << ", пропущено: " << skipped
+              << ", байт: " << sourceBytes << " -> " << storedBytes
+              << " за " << timer.elapsed() << " мс\n";
+    return 0;
+}
@@ -0,0 +1,532 @@
+// Нагрузочный тест хранимых процедур: N соединений в параллельных потоках вызывают
+// процедуры из sql/002_sp.sql в пропорциях, близких к работе клиентов, и печатают
+// в stdout JSON с пропускной способностью и p50/p95/p99 задержки по каждой процедуре.
+//
+//   bench_db [--connections 16] [--duration 60] [--warmup 10] [--seed 1]
+//            [--read-only] [--only sp_a,sp_b] [--out result.json]
+//
+// Запускать на базе, заполненной seed_data. Аргументы берутся из реальных строк базы
+// со смещённым распределением (активные пользователи и свежие задания встречаются
+// чаще). Изменяющие процедуры выполняются в транзакции с ROLLBACK, поэтому данные
+// между прогонами не меняются и результаты сравнимы. Служебные процедуры
+// (sp_audit_log_maintain, sp_assignment_stats_rebuild) и триггеры не вызываются.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+
+#include "db/PgConnection.hpp"
+#include "config/ConfigManager.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static const int kPoolLimit = 200000;
+static const int kSubmissionSample = 50000;
+
+struct Options {
+    int connections = 16;
+    int durationSec = 60;
+    int warmupSec = 10;
+    quint64 seed = 1;
+    bool readOnly = false;
+    QStringList only;
+    QString out;
+};
+
+struct SubmissionRef {
+    int id;
+    int assignmentId;
+    int studentId;
+    int teacherId;
+    QString uploadedAt;   // текстом, как cursor_uploaded_at процедур страниц
+};
+
+struct AssignmentRef {
+    int id;
+    int teacherId;
+};
+
+// Идентификаторы из базы; перемешаны с seed, чтобы «горячие» строки не совпадали
+// с диапазоном младших id
+struct Pools {
+    int admin = 0;
+    std::vector<int> students;
+    std::vector<QString> logins;
+    std::vector<int> teachers;
+    std::vector<AssignmentRef> assignments;
+    std::vector<SubmissionRef> submissions;
+    std::unordered_map<int, std::vector<int>> submissionsByTeacher;
+};
+
+// Генератор аргументов одного потока
+class Gen {
+public:
+    Gen(const Pools &pools, quint64 seed, int thread)
+        : m_p(pools), m_rng(seed * 1000003ULL + static_cast<quint64>(thread)), m_thread(thread) {}
+
+    // Степенное распределение: половина выборок приходится на первые 12.5% пула
+    std::size_t skewed(std::size_t n) {
+        const double u = std::uniform_real_distribution<double>(0.0, 1.0)(m_rng);
+        return std::min(n - 1, static_cast<std::size_t>(static_cast<double>(n) * u * u * u));
+    }
+    std::size_t uniform(std::size_t n) { return std::uniform_int_distribution<std::size_t>(0, n - 1)(m_rng); }
+    bool chance(int pct) { return static_cast<int>(uniform(100)) < pct; }
+
+    int admin() const { return m_p.admin; }
+    int student() { return m_p.students[skewed(m_p.students.size())]; }
+    // Цель административных действий — любой студент, без перекоса
+    int anyStudent() { return m_p.students[uniform(m_p.students.size())]; }
+    const QString &login() { return m_p.logins[skewed(m_p.logins.size())]; }
+    int teacher() { return m_p.teachers[skewed(m_p.teachers.size())]; }
+    const AssignmentRef &assignment() { return m_p.assignments[skewed(m_p.assignments.size())]; }
+    const SubmissionRef &submission() { return m_p.submissions[skewed(m_p.submissions.size())]; }
+
+    QString uniqueLogin() { return QStringLiteral("bench_%1_%2").arg(m_thread).arg(++m_counter); }
+    QString grade() { return QString::number(2 + uniform(4)); }
+
+    // Несколько разных отправлений преподавателя из выборки для пакетной оценки
+    std::vector<int> teacherSubmissions(int teacherId, int count) {
+        const std::vector<int> &all = m_p.submissionsByTeacher.at(teacherId);
+        const std::size_t n = std::min(all.size(), static_cast<std::size_t>(count));
+        const std::size_t from = uniform(all.size() - n + 1);
+        return std::vector<int>(all.begin() + from, all.begin() + from + n);
+    }
+
+    // Номер задания (редкое слово) или частое слово из комментариев seed_data
+    QString searchQuery() {
+        if (chance(20)) return QStringLiteral("комментарий");
+        return QString::number(assignment().id);
+    }
+
+    QString studentIds(int count) {
+        QStringList ids;
+        for (int i = 0; i < count; ++i) ids << QString::number(anyStudent());
+        return QLatin1Char('{') + ids.join(QLatin1Char(',')) + QLatin1Char('}');
+    }
+
+private:
+    const Pools &m_p;
+    std::mt19937_64 m_rng;
+    int m_thread;
+    quint64 m_counter = 0;
+};
+
+struct Proc {
+    const char *name;
+    const char *sql;
+    int weight;
+    bool writes;
+    std::function<QVariantList(Gen &)> args;
+};
+
+// Веса — относительная частота вызовов у работающих клиентов: студенты открывают
+// списки и загружают работы, преподаватели листают отправления и ставят оценки,
+// администраторы заходят редко.
+static std::vector<Proc> procedures() {
+    return {
+        {"sp_get_user_auth_data", "SELECT * FROM sp_get_user_auth_data($1)", 30, false,
+         [](Gen &g) { return QVariantList{g.login()}; }},
+
+        {"sp_get_assignments_for_student", "SELECT * FROM sp_get_assignments_for_student($1)", 120, false,
+         [](Gen &g) { return QVariantList{g.student()}; }},
+        {"sp_get_assignment_for_student", "SELECT * FROM sp_get_assignment_for_student($1, $2)", 60, false,
+         [](Gen &g) { const auto &s = g.submission(); return QVariantList{s.studentId, s.assignmentId}; }},
+        // Около трети запросов страниц — следующие страницы списка
+        {"sp_get_my_submissions_page", "SELECT * FROM sp_get_my_submissions_page($1, $2)", 84, false,
+         [](Gen &g) { return QVariantList{g.submission().studentId, 200}; }},
+        {"sp_get_my_submissions_page (cursor)", "SELECT * FROM sp_get_my_submissions_page($1, $2, $3, $4)", 36, false,
+         [](Gen &g) { const auto &s = g.submission(); return QVariantList{s.studentId, s.uploadedAt, s.id, 200}; }},
+        {"sp_get_my_submissions", "SELECT * FROM sp_get_my_submissions($1)", 5, false,
+         [](Gen &g) { return QVariantList{g.student()}; }},
+        {"sp_get_my_submission", "SELECT * FROM sp_get_my_submission($1, $2)", 60, false,
+         [](Gen &g) { const auto &s = g.submission(); return QVariantList{s.studentId, s.id}; }},
+        {"sp_get_assignment_details", "SELECT * FROM sp_get_assignment_details($1)", 60, false,
+         [](Gen &g) { return QVariantList{g.assignment().id}; }},
+        {"sp_get_assignment_files", "SELECT * FROM sp_get_assignment_files($1)", 60, false,
+         [](Gen &g) { return QVariantList{g.assignment().id}; }},
+        {"sp_create_submission", "SELECT sp_create_submission($1, $2, $3, $4)", 40, true,
+         [](Gen &g) {
+             const auto &s = g.submission();
+             return QVariantList{s.assignmentId, s.studentId, QStringLiteral("bench.dat"),
+                                 QStringLiteral("bench.pdf")};
+         }},
+        {"sp_log_action", "SELECT sp_log_action($1, $2, $3)", 40, true,
+         [](Gen &g) { return QVariantList{g.student(), QStringLiteral("download_assignment"), QStringLiteral("bench")}; }},
+        {"sp_log_actions", "SELECT sp_log_actions($1::integer[], $2::text[], $3::text[], $4::timestamp[])", 10, true,
+         [](Gen &g) {
+             const QString id = QString::number(g.student());
+             const QString ts = QDateTime::currentDateTime().toString(QStringLiteral("yyyy-MM-dd HH:mm:ss.zzz"));
+             return QVariantList{QStringLiteral("{%1,%1,%1}").arg(id),
+                                 QStringLiteral("{login,open,refresh}"), QStringLiteral("{a,b,c}"),
+                                 QStringLiteral("{\"%1\",\"%1\",\"%1\"}").arg(ts)};
+         }},
+
+        {"sp_search_for_student", "SELECT * FROM sp_search_for_student($1, $2, NULL, NULL, NULL, 50)", 10, false,
+         [](Gen &g) { return QVariantList{g.student(), g.searchQuery()}; }},
+
+        {"sp_get_assignments_for_teacher", "SELECT * FROM sp_get_assignments_for_teacher($1)", 60, false,
+         [](Gen &g) { return QVariantList{g.assignment().teacherId}; }},
+        {"sp_get_assignment_for_teacher", "SELECT * FROM sp_get_assignment_for_teacher($1, $2)", 40, false,
+         [](Gen &g) { const auto &a = g.assignment(); return QVariantList{a.teacherId, a.id}; }},
+        {"sp_get_submissions_for_assignment_page",
+         "SELECT * FROM sp_get_submissions_for_assignment_page($1, $2, $3)", 56, false,
+         [](Gen &g) { const auto &s = g.submission(); return QVariantList{s.teacherId, s.assignmentId, 200}; }},
+        {"sp_get_submissions_for_assignment_page (cursor)",
+         "SELECT * FROM sp_get_submissions_for_assignment_page($1, $2, $3, $4, $5)", 24, false,
+         [](Gen &g) {
+             const auto &s = g.submission();
+             return QVariantList{s.teacherId, s.assignmentId, s.uploadedAt, s.id, 200};
+         }},
+        {"sp_get_submissions_for_assignment", "SELECT * FROM sp_get_submissions_for_assignment($1, $2)", 5, false,
+         [](Gen &g) { const auto &a = g.assignment(); return QVariantList{a.teacherId, a.id}; }},
+        {"sp_get_submission_for_teacher", "SELECT * FROM sp_get_submission_for_teacher($1, $2)", 60, false,
+         [](Gen &g) { const auto &s = g.submission(); return QVariantList{s.teacherId, s.id}; }},
+        {"sp_set_submission_grade", "SELECT * FROM sp_set_submission_grade($1, $2, $3, $4)", 40, true,
+         [](Gen &g) {
+             const auto &s = g.submission();
+             return QVariantList{s.teacherId, s.id, g.grade(), QStringLiteral("bench")};
+         }},
+        {"sp_set_submission_grades",
+         "SELECT * FROM sp_set_submission_grades($1, $2::integer[], $3::text[], $4::text[])", 5, true,
+         [](Gen &g) {
+             const auto &first = g.submission();
+             const std::vector<int> ids = g.teacherSubmissions(first.teacherId, 10);
+             QStringList idList, grades, feedbacks;
+             for (int id : ids) {
+                 idList << QString::number(id);
+                 grades << g.grade();
+                 feedbacks << QStringLiteral("bench");
+             }
+             const auto literal = [](const QStringList &v) { return QLatin1Char('{') + v.join(QLatin1Char(',')) + QLatin1Char('}'); };
+             return QVariantList{first.teacherId, literal(idList), literal(grades), literal(feedbacks)};
+         }},
+        {"sp_create_assignment", "SELECT sp_create_assignment($1, $2, $3, $4)", 1, true,
+         [](Gen &g) {
+             const QString due = QDateTime::currentDateTimeUtc().addDays(14).toString(Qt::ISODate);
+             return QVariantList{g.teacher(), QStringLiteral("bench"), QString(), due};
+         }},
+        {"sp_create_assignment_full",
+         "SELECT sp_create_assignment_full($1, $2, $3, $4, $5::integer[], $6::text[], $7::text[])", 4, true,
+         [](Gen &g) {
+             const QString due = QDateTime::currentDateTimeUtc().addDays(14).toString(Qt::ISODate);
+             return QVariantList{g.teacher(), QStringLiteral("bench"), QString(), due, g.studentIds(25),
+                                 QStringLiteral("{bench.dat}"), QStringLiteral("{bench.pdf}")};
+         }},
+        {"sp_search_for_teacher", "SELECT * FROM sp_search_for_teacher($1, $2, NULL, NULL, NULL, 50)", 10, false,
+         [](Gen &g) { return QVariantList{g.teacher(), g.searchQuery()}; }},
+        {"sp_list_students", "SELECT * FROM sp_list_students($1)", 2, false,
+         [](Gen &g) { return QVariantList{g.teacher()}; }},
+        {"sp_assign_student_to_assignment", "SELECT sp_assign_student_to_assignment($1, $2, $3)", 4, true,
+         [](Gen &g) { const auto &a = g.assignment(); return QVariantList{a.teacherId, a.id, g.anyStudent()}; }},
+        {"sp_assign_students_to_assignment",
+         "SELECT sp_assign_students_to_assignment($1, $2, $3::integer[])", 4, true,
+         [](Gen &g) { const auto &a = g.assignment(); return QVariantList{a.teacherId, a.id, g.studentIds(25)}; }},
+        {"sp_add_assignment_file", "SELECT sp_add_assignment_file($1, $2, $3, $4)", 4, true,
+         [](Gen &g) {
+             const auto &a = g.assignment();
+             return QVariantList{a.teacherId, a.id, QStringLiteral("bench.dat"), QStringLiteral("bench.pdf")};
+         }},
+        {"sp_delete_assignment", "SELECT sp_delete_assignment($1, $2)", 1, true,
+         [](Gen &g) { const auto &a = g.assignment(); return QVariantList{a.id, a.teacherId}; }},
+
+        {"sp_register_user", "SELECT sp_register_user($1, $2, $3, $4)", 2, true,
+         [](Gen &g) { return QVariantList{g.uniqueLogin(), QStringLiteral("student"), QStringLiteral("x"), QStringLiteral("x")}; }},
+        {"sp_admin_list_users", "SELECT * FROM sp_admin_list_users($1)", 1, false,
+         [](Gen &g) { return QVariantList{g.admin()}; }},
+        {"sp_admin_list_users_page", "SELECT * FROM sp_admin_list_users_page($1, $2, $3)", 10, false,
+         [](Gen &g) { return QVariantList{g.admin(), g.chance(70) ? QVariant() : QVariant(g.anyStudent()), 200}; }},
+        {"sp_admin_get_user", "SELECT * FROM sp_admin_get_user($1, $2)", 5, false,
+         [](Gen &g) { return QVariantList{g.admin(), g.anyStudent()}; }},
+        {"sp_admin_create_user", "SELECT sp_admin_create_user($1, $2, $3, $4, $5, $6)", 2, true,
+         [](Gen &g) {
+             return QVariantList{g.admin(), g.uniqueLogin(), QStringLiteral("student"), QStringLiteral("Bench"),
+                                 QStringLiteral("x"), QStringLiteral("x")};
+         }},
+        {"sp_admin_toggle_user_active", "SELECT * FROM sp_admin_toggle_user_active($1, $2)", 2, true,
+         [](Gen &g) { return QVariantList{g.admin(), g.anyStudent()}; }},
+        {"sp_admin_update_user", "SELECT * FROM sp_admin_update_user($1, $2, $3, $4)", 2, true,
+         [](Gen &g) { return QVariantList{g.admin(), g.anyStudent(), QStringLiteral("Bench"), QStringLiteral("student")}; }},
+        {"sp_delete_user", "SELECT sp_delete_user($1, $2)", 1, true,
+         [](Gen &g) { return QVariantList{g.anyStudent(), g.admin()}; }},
+
+        // Проверка отставания реплики из DbExecutor
+        {"sp_replica_lag_ms", "SELECT sp_replica_lag_ms()", 5, false,
+         [](Gen &) { return QVariantList{}; }},
+    };
+}
+
+static bool loadPools(PgConnection &conn, quint64 seed, Pools &p) {
+    PgResult admin = conn.exec("SELECT id FROM users WHERE role = 'admin' AND active ORDER BY id LIMIT 1");
+    if (!admin.ok() || admin.rows() == 0) {
+        std::cerr << "Ошибка: в базе нет активного администратора\n";
+        return false;
+    }
+    p.admin = admin.value(0, 0).toInt();
+
+    PgResult students = conn.exec(
+        QStringLiteral("SELECT id, login FROM users WHERE role = 'student' AND active ORDER BY id LIMIT %1")
+            .arg(kPoolLimit));
+    for (int i = 0; i < students.rows(); ++i) {
+        p.students.push_back(students.value(i, 0).toInt());
+        p.logins.push_back(students.value(i, 1));
+    }
+
+    PgResult teachers = conn.exec(
+        QStringLiteral("SELECT id FROM users WHERE role = 'teacher' AND active ORDER BY id LIMIT %1").arg(kPoolLimit));
+    for (int i = 0; i < teachers.rows(); ++i) p.teachers.push_back(teachers.value(i, 0).toInt());
+
+    PgResult assignments = conn.exec(
+        QStringLiteral("SELECT id, created_by FROM assignments WHERE created_by IS NOT NULL ORDER BY id LIMIT %1")
+            .arg(kPoolLimit));
+    for (int i = 0; i < assignments.rows(); ++i)
+        p.assignments.push_back({assignments.value(i, 0).toInt(), assignments.value(i, 1).toInt()});
+
+    // Равномерная по id выборка отправлений без полного ORDER BY random()
+    PgResult subs = conn.exec(
+        QStringLiteral("SELECT s.id, s.assignment_id, s.student_id, a.created_by, s.uploaded_at::text "
+                       "FROM submissions s JOIN assignments a ON a.id = s.assignment_id "
+                       "WHERE s.student_id IS NOT NULL AND a.created_by IS NOT NULL "
+                       "  AND s.id % greatest((SELECT max(id) FROM submissions) / %1, 1) = 0 "
+                       "ORDER BY s.id LIMIT %1").arg(kSubmissionSample));
+    for (int i = 0; i < subs.rows(); ++i)
+        p.submissions.push_back({subs.value(i, 0).toInt(), subs.value(i, 1).toInt(),
+                                 subs.value(i, 2).toInt(), subs.value(i, 3).toInt(),
+                                 subs.value(i, 4)});
+
+    if (p.students.empty() || p.teachers.empty() || p.assignments.empty() || p.submissions.empty()) {
+        std::cerr << "Ошибка: база не заполнена (нужны студенты, преподаватели, задания и отправления; "
+                     "см. seed_data)\n";
+        return false;
+    }
+
+    std::mt19937_64 rng(seed);
+    std::shuffle(p.students.begin(), p.students.end(), rng);
+    std::shuffle(p.logins.begin(), p.logins.end(), rng);
+    std::shuffle(p.teachers.begin(), p.teachers.end(), rng);
+    std::shuffle(p.assignments.begin(), p.assignments.end(), rng);
+    std::shuffle(p.submissions.begin(), p.submissions.end(), rng);
+    for (const SubmissionRef &s : p.submissions) p.submissionsByTeacher[s.teacherId].push_back(s.id);
+    return true;
+}
+
+// Задержки одного потока по процедурам, в микросекундах
+struct ThreadStats {
+    std::vector<std::vector<quint32>> latencyUs;
+    std::vector<qint64> errors;
+    std::vector<QString> lastError;
+};
+
+static void runWorker(PgConnection &conn, const std::vector<Proc> &procs, const std::vector<int> &cumulative,
+                      Gen gen, Clock::time_point measureFrom, Clock::time_point until, ThreadStats &st) {
+    st.latencyUs.assign(procs.size(), {});
+    st.errors.assign(procs.size(), 0);
+    st.lastError.assign(procs.size(), QString());
+
+    const int total = cumulative.back();
+    while (true) {
+        const Clock::time_point now = Clock::now();
+        if (now >= until) break;
+
+        const int pick = static_cast<int>(gen.uniform(static_cast<std::size_t>(total)));
+        const std::size_t i = static_cast<std::size_t>(
+            std::upper_bound(cumulative.begin(), cumulative.end(), pick) - cumulative.begin());
+        const Proc &proc = procs[i];
+        const QVariantList args = proc.args(gen);
+
+        if (proc.writes) conn.exec("BEGIN");
+        const Clock::time_point t0 = Clock::now();
+        PgResult r = conn.execPrepared(proc.name, args);
+        const Clock::time_point t1 = Clock::now();
+        if (proc.writes) conn.exec("ROLLBACK");
+
+        if (t0 < measureFrom) continue;
+        if (!r.ok()) {
+            ++st.errors[i];
+            st.lastError[i] = r.error();
+            continue;
+        }
+        st.latencyUs[i].push_back(static_cast<quint32>(
+            std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count()));
+    }
+}
+
+// Ранговый процентиль по отсортированной выборке, в миллисекундах
+static double percentileMs(const std::vector<quint32> &sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    const std::size_t rank = static_cast<std::size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+    return sorted[std::max<std::size_t>(rank, 1) - 1] / 1000.0;
+}
+
+static double round3(double v) {
+    return std::round(v * 1000.0) / 1000.0;
+}
+
+static bool parseOptions(const QCoreApplication &app, Options &o) {
+    QCommandLineParser p;
+    p.setApplicationDescription("Stored procedure load benchmark");
+    p.addHelpOption();
+
+    const QCommandLineOption connections("connections", "Concurrent connections.", "n", "16");
+    const QCommandLineOption duration("duration", "Measured time, seconds.", "sec", "60");
+    const QCommandLineOption warmup("warmup", "Warm-up time before measuring, seconds.", "sec", "10");
+    const QCommandLineOption seed("seed", "PRNG seed for argument selection.", "n", "1");
+    const QCommandLineOption readOnly("read-only", "Skip procedures that modify data.");
+    const QCommandLineOption only("only", "Comma-separated procedure names.", "names");
+    const QCommandLineOption out("out", "Write JSON to file instead of stdout.", "file");
+    p.addOptions({connections, duration, warmup, seed, readOnly, only, out});
+    p.process(app);
+
+    o.connections = std::max(1, p.value(connections).toInt());
+    o.durationSec = std::max(1, p.value(duration).toInt());
+    o.warmupSec = std::max(0, p.value(warmup).toInt());
+    o.seed = p.value(seed).toULongLong();
+    o.readOnly = p.isSet(readOnly);
+    if (p.isSet(only)) {
+        o.only = p.value(only).split(QLatin1Char(','));
+        o.only.removeAll(QString());
+    }
+    o.out = p.value(out);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    QCoreApplication app(argc, argv);
+
+    Options o;
+    if (!parseOptions(app, o)) return 1;
+
+    const QString cfg = QString::fromStdString(ConfigManager::findConfigPath());
+    if (cfg.isEmpty() || !ConfigManager::instance().load(cfg.toStdString())) {
+        std::cerr << "Ошибка: не удалось загрузить config.json\n";
+        return 1;
+    }
+
+    std::vector<Proc> procs;
+    for (Proc &p : procedures()) {
+        if (o.readOnly && p.writes) continue;
+        if (!o.only.isEmpty() && !o.only.contains(QLatin1String(p.name))) continue;
+        procs.push_back(std::move(p));
+    }
+    if (procs.empty()) {
+        std::cerr << "Ошибка: не выбрано ни одной процедуры\n";
+        return 1;
+    }
+    std::vector<int> cumulative;
+    int sum = 0;
+    for (const Proc &p : procs) cumulative.push_back(sum += p.weight);
+
+    // Соединения открываются заранее, чтобы подключение не попадало в замеры
+    std::vector<std::unique_ptr<PgConnection>> conns;
+    for (int i = 0; i < o.connections; ++i) {
+        auto conn = std::make_unique<PgConnection>();
+        if (!conn->open()) {
+            std::cerr << "Ошибка: не удалось открыть соединение " << (i + 1) << " из " << o.connections << "\n";
+            return 1;
+        }
+        conn->exec("SET application_name = 'bench_db'");
+        for (const Proc &p : procs) {
+            if (!conn->prepare(p.name, QString::fromLatin1(p.sql))) {
+                std::cerr << "Ошибка: не удалось подготовить " << p.name << "\n";
+                return 1;
+            }
+        }
+        conns.push_back(std::move(conn));
+    }
+
+    Pools pools;
+    if (!loadPools(*conns.front(), o.seed, pools)) return 1;
+    std::cerr << "Пул: " << pools.students.size() << " студентов, " << pools.teachers.size()
+              << " преподавателей, " << pools.assignments.size() << " заданий, " << pools.submissions.size()
+              << " отправлений; " << o.connections << " соединений, " << o.warmupSec << " + " << o.durationSec
+              << " с\n";
+
+    const Clock::time_point start = Clock::now();
+    const Clock::time_point measureFrom = start + std::chrono::seconds(o.warmupSec);
+    const Clock::time_point until = measureFrom + std::chrono::seconds(o.durationSec);
+
+    std::vector<ThreadStats> stats(conns.size());
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < conns.size(); ++t) {
+        threads.emplace_back(runWorker, std::ref(*conns[t]), std::cref(procs), std::cref(cumulative),
+                             Gen(pools, o.seed, static_cast<int>(t)), measureFrom, until, std::ref(stats[t]));
+    }
+    for (std::thread &t : threads) t.join();
+
+    const double seconds = o.durationSec;
+    qint64 totalCalls = 0;
+    qint64 totalErrors = 0;
+    QJsonArray perProc;
+    for (std::size_t i = 0; i < procs.size(); ++i) {
+        std::vector<quint32> all;
+        qint64 errors = 0;
+        QString lastError;
+        for (const ThreadStats &st : stats) {
+            all.insert(all.end(), st.latencyUs[i].begin(), st.latencyUs[i].end());
+            errors += st.errors[i];
+            if (!st.lastError[i].isEmpty()) lastError = st.lastError[i];
+        }
+        std::sort(all.begin(), all.end());
+
+        double sumMs = 0.0;
+        for (quint32 us : all) sumMs += us / 1000.0;
+        const qint64 calls = static_cast<qint64>(all.size());
+        totalCalls += calls;
+        totalErrors += errors;
+
+        QJsonObject entry;
+        entry["name"] = QLatin1String(procs[i].name);
+        entry["writes"] = procs[i].writes;
+        entry["calls"] = calls;
+        entry["errors"] = errors;
+        entry["throughput"] = round3(calls / seconds);
+        entry["mean_ms"] = round3(calls ? sumMs / calls : 0.0);
+        entry["p50_ms"] = round3(percentileMs(all, 0.50));
+        entry["p95_ms"] = round3(percentileMs(all, 0.95));
+        entry["p99_ms"] = round3(percentileMs(all, 0.99));
+        entry["max_ms"] = round3(all.empty() ? 0.0 : all.back() / 1000.0);
+        if (!lastError.isEmpty()) o["last_error"] = lastError;
+        perProc.append(entry);
+    }
+
+    QJsonObject root;
+    root["connections"] = o.connections;
+    root["duration_s"] = o.durationSec;
+    root["warmup_s"] = o.warmupSec;
+    root["seed"] = QString::number(o.seed);
+    root["read_only"] = o.readOnly;
+    root["calls"] = totalCalls;
+    root["errors"] = totalErrors;
+    root["throughput"] = round3(totalCalls / seconds);
+    root["procedures"] = perProc;
+
+    const QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Indented);
+    if (o.out.isEmpty()) {
+        std::cout << json.constData();
+        return 0;
+    }
+
+    QFile f(o.out);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate) || f.write(json) != json.size()) {
+        std::cerr << "Ошибка: не удалось записать " << o.out.toStdString() << "\n";
+        return 1;
+    }
+    std::cerr << "Результат записан в " << o.out.toStdString() << "\n";
+    return 0;
+}
@@ -0,0 +1,152 @@
+// Сравнение пакета мелких вызовов: цикл QSqlQuery (QPSQL, ожидание ответа на каждый
+// вызов), цикл PQexecPrepared и конвейер libpq через Database::pipeline().
+//
+//   bench_pipeline [--calls 10000] [--batch 1000]
+//
+// Вызов — sp_get_assignments_for_student по студентам из базы (только чтение).
+// Разница растёт с сетевой задержкой: на localhost она меньше, чем до удалённого сервера.
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QSqlError>
+#include <QSqlQuery>
+
+#include "db/Database.hpp"
+#include "db/PgConnection.hpp"
+#include "db/PgPipeline.hpp"
+#include "config/ConfigManager.hpp"
+
+static const char *kQtSql = "SELECT * FROM sp_get_assignments_for_student(?)";
+static const char *kPqSql = "SELECT * FROM sp_get_assignments_for_student($1)";
+
+static bool runQSqlQuery(const QList<int> &students, int calls, qint64 &nsOut) {
+    QElapsedTimer t;
+    t.start();
+    for (int i = 0; i < calls; ++i) {
+        QSqlQuery q = Database::instance().prepared(kQtSql);
+        q.addBindValue(students[i % students.size()]);
+        if (!q.exec()) {
+            std::cerr << "Ошибка: " << q.lastError().text().toStdString() << "\n";
+            return false;
+        }
+        while (q.next()) {}
+    }
+    nsOut = t.nsecsElapsed();
+    return true;
+}
+
+static bool runExecPrepared(PgConnection &conn, const QList<int> &students, int calls, qint64 &nsOut) {
+    if (!conn.prepare("bench_pipeline_seq", kPqSql)) return false;
+
+    QElapsedTimer t;
+    t.start();
+    for (int i = 0; i < calls; ++i) {
+        PgResult r = conn.execPrepared("bench_pipeline_seq", {students[i % students.size()]});
+        if (!r.ok()) {
+            std::cerr << "Ошибка: " << r.error().toStdString() << "\n";
+            return false;
+        }
+    }
+    nsOut = t.nsecsElapsed();
+    return true;
+}
+
+static bool runPipeline(const QList<int> &students, int calls, int batch, qint64 &nsOut) {
+    PgPipeline *pipeline = Database::instance().pipeline();
+    if (!pipeline) {
+        std::cerr << "Ошибка: не удалось открыть соединение конвейера\n";
+        return false;
+    }
+
+    QElapsedTimer t;
+    t.start();
+    for (int i = 0; i < calls; ++i) {
+        pipeline->add(kPqSql, {students[i % students.size()]});
+        if (pipeline->pending() >= batch || i + 1 == calls) {
+            QString error;
+            if (!pipeline->run(nullptr, &error)) {
+                std::cerr << "Ошибка: " << error.toStdString() << "\n";
+                return false;
+            }
+        }
+    }
+    nsOut = t.nsecsElapsed();
+    return true;
+}
+
+int main(int argc, char **argv) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser p;
+    p.setApplicationDescription("Compare a QSqlQuery loop with the libpq pipeline for small calls");
+    p.addHelpOption();
+
+    const QCommandLineOption callsOpt("calls", "Number of calls per mode.", "n", "10000");
+    const QCommandLineOption batchOpt("batch", "Calls per pipeline sync.", "n", "1000");
+    p.addOptions({callsOpt, batchOpt});
+    p.process(app);
+
+    const int calls = p.value(callsOpt).toInt();
+    const int batch = p.value(batchOpt).toInt();
+    if (calls <= 0 || batch <= 0) {
+        std::cerr << "Ошибка: --calls и --batch должны быть положительными\n";
+        return 1;
+    }
+
+    const QString cfg = QString::fromStdString(ConfigManager::findConfigPath());
+    if (cfg.isEmpty() || !ConfigManager::instance().load(cfg.toStdString())) {
+        std::cerr << "Ошибка: не удалось загрузить config.json\n";
+        return 1;
+    }
+
+    if (!Database::instance().open()) {
+        std::cerr << "Ошибка: не удалось подключиться к PostgreSQL\n";
+        return 1;
+    }
+
+    QList<int> students;
+    QSqlQuery sq(Database::instance().get());
+    if (sq.exec("SELECT id FROM users WHERE role = 'student' ORDER BY id LIMIT 1000")) {
+        while (sq.next()) students << sq.value(0).toInt();
+    }
+    if (students.isEmpty()) {
+        std::cerr << "Ошибка: в базе нет студентов (заполните её seed_data)\n";
+        return 1;
+    }
+
+    PgConnection conn;
+    if (!conn.open()) {
+        std::cerr << "Ошибка: не удалось подключиться к PostgreSQL\n";
+        return 1;
+    }
+
+    // Прогрев: подготовка запросов и кэш планов на сервере
+    qint64 warmNs = 0;
+    if (!runQSqlQuery(students, 100, warmNs) || !runPipeline(students, 100, batch, warmNs)) return 1;
+
+    qint64 qsqlNs = 0, seqNs = 0, pipeNs = 0;
+    if (!runQSqlQuery(students, calls, qsqlNs)) return 1;
+    if (!runExecPrepared(conn, students, calls, seqNs)) return 1;
+    if (!runPipeline(students, calls, batch, pipeNs)) return 1;
+
+    const double qsqlUs = qsqlNs / 1000.0 / calls;
+    const double seqUs = seqNs / 1000.0 / calls;
+    const double pipeUs = pipeNs / 1000.0 / calls;
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "calls:             " << calls << " (pipeline batch " << batch << ")\n"
+              << "QSqlQuery loop:    " << qsqlUs << " us/call, " << qsqlNs / 1000000 << " ms total\n"
+              << "PQexecPrepared:    " << seqUs << " us/call, " << seqNs / 1000000 << " ms total\n"
+              << "libpq pipeline:    " << pipeUs << " us/call, " << pipeNs / 1000000 << " ms total\n"
+              << std::setprecision(2)
+              << "speedup vs QSql:   " << (pipeUs > 0 ? qsqlUs / pipeUs : 0.0) << "x\n";
+
+    conn.close();
+    Database::instance().close();
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QSqlQuery>
+#include <QSqlError>
+
+#include "db/Database.hpp"
+#include "db/StatementCache.hpp"
+#include "config/ConfigManager.hpp"
+
+static const char *kSql = "SELECT * FROM sp_get_assignments_for_teacher(?)";
+
+// Каждый вызов: новый QSqlQuery, PREPARE, EXECUTE, DEALLOCATE
+static bool runUncached(QSqlDatabase db, int iterations, int teacherId, qint64 &nsOut) {
+    QElapsedTimer t;
+    t.start();
+    for (int i = 0; i < iterations; ++i) {
+        QSqlQuery q(db);
+        q.setForwardOnly(true);
+        q.prepare(kSql);
+        q.addBindValue(teacherId);
+        if (!q.exec()) {
+            std::cerr << "Ошибка: " << q.lastError().text().toStdString() << "\n";
+            return false;
+        }
+        while (q.next()) {}
+    }
+    nsOut = t.nsecsElapsed();
+    return true;
+}
+
+// Каждый вызов: только EXECUTE на закэшированном подготовленном запросе
+static bool runCached(StatementCache &cache, int iterations, int teacherId, qint64 &nsOut) {
+    QElapsedTimer t;
+    t.start();
+    for (int i = 0; i < iterations; ++i) {
+        QSqlQuery q = cache.prepare(kSql);
+        q.addBindValue(teacherId);
+        if (!q.exec()) {
+            std::cerr << "Ошибка: " << q.lastError().text().toStdString() << "\n";
+            return false;
+        }
+        while (q.next()) {}
+    }
+    nsOut = t.nsecsElapsed();
+    return true;
+}
+
+int main(int argc, char **argv) {
+    QCoreApplication app(argc, argv);
+
+    const int iterations = argc >= 2 ? std::max(1, std::atoi(argv[1])) : 2000;
+    const int teacherId = argc >= 3 ? std::atoi(argv[2]) : 1;
+
+    const QString cfg = QString::fromStdString(ConfigManager::findConfigPath());
+    if (cfg.isEmpty() || !ConfigManager::instance().load(cfg.toStdString())) {
+        std::cerr << "Ошибка: не удалось загрузить config.json\n";
+        return 1;
+    }
+
+    QSqlDatabase db = Database::openConnection("EduDeskBench");
+    if (!db.isOpen()) {
+        std::cerr << "Ошибка: не удалось подключиться к PostgreSQL\n";
+        return 1;
+    }
+
+    StatementCache cache(db);
+
+    qint64 uncachedNs = 0;
+    qint64 cachedNs = 0;
+    if (!runUncached(db, iterations, teacherId, uncachedNs)) return 1;
+    if (!runCached(cache, iterations, teacherId, cachedNs)) return 1;
+
+    const double uncachedUs = uncachedNs / 1000.0 / iterations;
+    const double cachedUs = cachedNs / 1000.0 / iterations;
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "iterations:        " << iterations << "\n"
+              << "prepare per call:  " << uncachedUs << " us/call\n"
+              << "cached statement:  " << cachedUs << " us/call\n"
+              << "saved per call:    " << (uncachedUs - cachedUs) << " us\n"
+              << std::setprecision(4)
+              << "cache hit rate:    " << cache.hitRate()
+              << " (hits " << cache.hits() << ", misses " << cache.misses() << ")\n";
+
+    cache.clear();
+    db.close();
+    return 0;
+}
@@ -6,8 +6,6 @@
 #include <sodium.h>
 
 #include <QCoreApplication>
-#include <QDir>
-#include <QFileInfo>
 
 #include "db/Database.hpp"
 #include "config/ConfigManager.hpp"
@@ -32,24 +30,6 @@ static std::string readPassword(const char *prompt) {
     return password;
 }
 
-static QString findConfigPath() {
-    const QString appDir = QCoreApplication::applicationDirPath();
-
-    const QString p1 = QDir(appDir).filePath("config/config.json");
-    if (QFileInfo(p1).exists()) return p1;
-
-    const QString p2 = QDir(appDir).filePath("config.json");
-    if (QFileInfo(p2).exists()) return p2;
-
-    const QString p3 = QDir::current().filePath("config/config.json");
-    if (QFileInfo(p3).exists()) return p3;
-
-    const QString p4 = QDir::current().filePath("config.json");
-    if (QFileInfo(p4).exists()) return p4;
-
-    return QString();
-}
-
 int main(int argc, char** argv) {
     QCoreApplication app(argc, argv);
 
@@ -58,7 +38,7 @@ int main(int argc, char** argv) {
         return 1;
     }
 
-    const QString cfg = findConfigPath();
+    const QString cfg = QString::fromStdString(ConfigManager::findConfigPath());
     if (cfg.isEmpty()) {
         std::cerr << "Ошибка: не найден config.json\n";
         return 1;
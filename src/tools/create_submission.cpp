@@ -7,7 +7,6 @@
 #include <QCoreApplication>
 #include <QFile>
 #include <QFileInfo>
-#include <QDir>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QByteArray>
@@ -67,8 +66,9 @@ int main(int argc, char** argv) {
         originalName = fi.fileName().toStdString();
     }
 
-    if (!ConfigManager::instance().load("config/config.json")) {
-        std::cerr << "Ошибка: не удалось загрузить config/config.json\n";
+    const std::string cfg = ConfigManager::findConfigPath();
+    if (cfg.empty() || !ConfigManager::instance().load(cfg)) {
+        std::cerr << "Ошибка: не удалось загрузить config.json\n";
         return 1;
     }
 
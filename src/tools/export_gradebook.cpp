@@ -0,0 +1,108 @@
+// Выгрузка ведомости преподавателя (студенты × задания) в CSV через COPY TO STDOUT.
+//
+//   export_gradebook (--teacher login | --teacher-id N) [--out gradebook.csv]
+//                    [--delimiter ';'] [--bom]
+//
+// Без --out CSV пишется в stdout. Память не зависит от размера курса: строки
+// COPY сразу уходят в файл.
+
+#include <iostream>
+#include <string>
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSaveFile>
+
+#include "db/PgConnection.hpp"
+#include "db/GradebookExport.hpp"
+#include "config/ConfigManager.hpp"
+
+int main(int argc, char **argv) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser p;
+    p.setApplicationDescription("Export a teacher's gradebook as CSV");
+    p.addHelpOption();
+
+    const QCommandLineOption teacher("teacher", "Teacher login.", "login");
+    const QCommandLineOption teacherId("teacher-id", "Teacher user id.", "n");
+    const QCommandLineOption out("out", "Output file (default: stdout).", "file");
+    const QCommandLineOption delimiter("delimiter", "Field delimiter.", "char", ",");
+    const QCommandLineOption bom("bom", "Prepend UTF-8 BOM (for Excel).");
+    p.addOptions({teacher, teacherId, out, delimiter, bom});
+    p.process(app);
+
+    if (p.isSet(teacher) == p.isSet(teacherId)) {
+        std::cerr << "Ошибка: укажите ровно один из --teacher или --teacher-id\n";
+        return 1;
+    }
+    const QString delim = p.value(delimiter);
+    if (delim.size() != 1) {
+        std::cerr << "Ошибка: --delimiter должен быть одним символом\n";
+        return 1;
+    }
+
+    const QString cfg = QString::fromStdString(ConfigManager::findConfigPath());
+    if (cfg.isEmpty() || !ConfigManager::instance().load(cfg.toStdString())) {
+        std::cerr << "Ошибка: не удалось загрузить config.json\n";
+        return 1;
+    }
+
+    PgConnection conn;
+    if (!conn.open()) {
+        std::cerr << "Ошибка: не удалось подключиться к PostgreSQL\n";
+        return 1;
+    }
+
+    int id = p.value(teacherId).toInt();
+    if (p.isSet(teacher)) {
+        PgResult r = conn.exec("SELECT id FROM users WHERE login = $1 AND role = 'teacher'", {p.value(teacher)});
+        if (!r.ok() || r.rows() == 0) {
+            std::cerr << "Ошибка: преподаватель " << p.value(teacher).toStdString() << " не найден\n";
+            return 1;
+        }
+        id = r.value(0, 0).toInt();
+    }
+
+    gradebook::CsvOptions options;
+    options.delimiter = delim.at(0);
+    options.bom = p.isSet(bom);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QString error;
+    qint64 rows = 0;
+    if (!p.isSet(out)) {
+        QFile stdoutFile;
+        if (!stdoutFile.open(stdout, QIODevice::WriteOnly)) {
+            std::cerr << "Ошибка: не удалось открыть stdout\n";
+            return 1;
+        }
+        if (!gradebook::exportCsv(conn, id, stdoutFile, options, &error, &rows)) {
+            std::cerr << "Ошибка: " << error.toStdString() << "\n";
+            return 1;
+        }
+    } else {
+        // QSaveFile: при ошибке на диске не остаётся обрезанной ведомости
+        QSaveFile file(p.value(out));
+        if (!file.open(QIODevice::WriteOnly)) {
+            std::cerr << "Ошибка: не удалось открыть " << p.value(out).toStdString() << "\n";
+            return 1;
+        }
+        if (!gradebook::exportCsv(conn, id, file, options, &error, &rows)) {
+            file.cancelWriting();
+            std::cerr << "Ошибка: " << error.toStdString() << "\n";
+            return 1;
+        }
+        if (!file.commit()) {
+            std::cerr << "Ошибка: не удалось записать " << p.value(out).toStdString() << "\n";
+            return 1;
+        }
+    }
+
+    std::cerr << "Выгружено студентов: " << rows << " за " << timer.elapsed() << " мс\n";
+    return 0;
+}
@@ -0,0 +1,245 @@
+// Проверка планов хранимых процедур: для каждого вызова из checks.json собирает
+// планы всех операторов (включая вложенные в plpgsql и триггеры) через auto_explain
+// и проверяет отсутствие Seq Scan по большим таблицам и число прочитанных буферов.
+//
+//   plan_check [--dataset sql/plan/dataset.sql] [--generic] [sql/plan/checks.json]
+//
+// Запускать на отдельной базе со схемой 001/002: --dataset загружает синтетические
+// данные (один раз), сами вызовы выполняются в транзакциях с ROLLBACK.
+// Проверка с "params" передаёт значения параметрами $1..$n расширенного протокола,
+// как клиент; "generic": true — её план всегда обобщённый, как у кэшированного
+// подготовленного запроса при plan_cache_mode = auto после пяти вызовов.
+// Нужен суперпользователь или auto_explain в session_preload_libraries.
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSet>
+#include <QStringList>
+
+#include "db/PgConnection.hpp"
+#include "config/ConfigManager.hpp"
+
+static bool readFile(const QString &path, QByteArray &out) {
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) return false;
+    out = f.readAll();
+    return true;
+}
+
+// :name -> значение переменной; "::type" не трогаем
+static QString substitute(const QString &sql, const QHash<QString, QString> &vars) {
+    static const QRegularExpression re(QStringLiteral("(?<!:):([A-Za-z_][A-Za-z0-9_]*)"));
+    QString out;
+    int pos = 0;
+    auto it = re.globalMatch(sql);
+    while (it.hasNext()) {
+        const auto m = it.next();
+        out += sql.mid(pos, m.capturedStart() - pos);
+        const auto v = vars.constFind(m.captured(1));
+        out += v != vars.constEnd() ? v.value() : m.captured(0);
+        pos = m.capturedEnd();
+    }
+    out += sql.mid(pos);
+    return out;
+}
+
+static QSet<QString> toSet(const QJsonValue &v) {
+    QSet<QString> out;
+    for (const QJsonValue &x : v.toArray()) out.insert(x.toString());
+    return out;
+}
+
+static qint64 nodeBuffers(const QJsonObject &node) {
+    return node.value("Shared Hit Blocks").toVariant().toLongLong()
+         + node.value("Shared Read Blocks").toVariant().toLongLong();
+}
+
+// Обходит дерево плана и собирает запрещённые Seq Scan
+static void findSeqScans(const QJsonObject &node, const QSet<QString> &forbidden, QStringList &violations) {
+    const QString type = node.value("Node Type").toString();
+    const QString rel = node.value("Relation Name").toString();
+    if (type == QLatin1String("Seq Scan") && forbidden.contains(rel)) {
+        QString v = QStringLiteral("Seq Scan on %1").arg(rel);
+        const QString filter = node.value("Filter").toString();
+        if (!filter.isEmpty()) v += QStringLiteral(" (Filter: %1)").arg(filter);
+        violations << v;
+    }
+    for (const QJsonValue &child : node.value("Plans").toArray())
+        findSeqScans(child.toObject(), forbidden, violations);
+}
+
+static bool execOk(PgConnection &conn, const QString &sql) {
+    PgResult r = conn.exec(sql);
+    if (!r.ok()) {
+        std::cerr << "Ошибка: " << sql.toStdString() << ": " << r.error().toStdString() << "\n";
+        return false;
+    }
+    return true;
+}
+
+static bool loadDataset(PgConnection &conn, const QString &path) {
+    PgResult present = conn.exec("SELECT 1 FROM users WHERE login = 'plan_admin'");
+    if (present.ok() && present.rows() > 0) {
+        std::cout << "Набор данных уже загружен, пропускаем\n";
+        return true;
+    }
+
+    QByteArray sql;
+    if (!readFile(path, sql)) {
+        std::cerr << "Ошибка: не удалось прочитать " << path.toStdString() << "\n";
+        return false;
+    }
+
+    std::cout << "Загрузка " << path.toStdString() << "...\n";
+    // Несколько команд простым протоколом выполняются одной неявной транзакцией
+    if (!execOk(conn, QString::fromUtf8(sql))) return false;
+    return execOk(conn, "VACUUM ANALYZE");
+}
+
+int main(int argc, char **argv) {
+    QCoreApplication app(argc, argv);
+
+    QString checksPath = QStringLiteral("sql/plan/checks.json");
+    QString datasetPath;
+    bool generic = false;
+
+    const QStringList args = app.arguments().mid(1);
+    for (int i = 0; i < args.size(); ++i) {
+        if (args[i] == QLatin1String("--dataset") && i + 1 < args.size()) {
+            datasetPath = args[++i];
+        } else if (args[i] == QLatin1String("--generic")) {
+            generic = true;
+        } else {
+            checksPath = args[i];
+        }
+    }
+
+    const QString cfg = QString::fromStdString(ConfigManager::findConfigPath());
+    if (cfg.isEmpty() || !ConfigManager::instance().load(cfg.toStdString())) {
+        std::cerr << "Ошибка: не удалось загрузить config.json\n";
+        return 1;
+    }
+
+    QByteArray checksJson;
+    if (!readFile(checksPath, checksJson)) {
+        std::cerr << "Ошибка: не удалось прочитать " << checksPath.toStdString() << "\n";
+        return 1;
+    }
+    const QJsonObject spec = QJsonDocument::fromJson(checksJson).object();
+    if (spec.isEmpty()) {
+        std::cerr << "Ошибка: " << checksPath.toStdString() << " не является JSON-объектом\n";
+        return 1;
+    }
+
+    PgConnection conn;
+    if (!conn.open()) {
+        std::cerr << "Ошибка: не удалось подключиться к PostgreSQL\n";
+        return 1;
+    }
+
+    if (!datasetPath.isEmpty() && !loadDataset(conn, datasetPath)) return 1;
+
+    // Переменные вычисляются по порядку и могут ссылаться на предыдущие
+    QHash<QString, QString> vars;
+    for (const QJsonValue &v : spec.value("vars").toArray()) {
+        const QJsonObject o = v.toObject();
+        const QString name = o.value("name").toString();
+        PgResult r = conn.exec(substitute(o.value("sql").toString(), vars));
+        if (!r.ok() || r.rows() == 0 || r.isNull(0, 0)) {
+            std::cerr << "Ошибка: переменная " << name.toStdString() << " не найдена"
+                      << (r.ok() ? "" : ": " + r.error().toStdString()) << "\n";
+            return 1;
+        }
+        vars.insert(name, r.value(0, 0));
+    }
+
+    QList<QJsonObject> plans;
+    conn.setNoticeHandler([&plans](const QString &msg) {
+        // "duration: 0.123 ms  plan:\n{ ... }"
+        const int brace = msg.indexOf(QLatin1Char('{'));
+        if (brace < 0) return;
+        const QJsonDocument doc = QJsonDocument::fromJson(msg.mid(brace).toUtf8());
+        if (doc.isObject()) plans << doc.object();
+    });
+
+    const QStringList setup = {
+        "LOAD 'auto_explain'",
+        "SET auto_explain.log_min_duration = 0",
+        "SET auto_explain.log_analyze = on",
+        "SET auto_explain.log_buffers = on",
+        "SET auto_explain.log_timing = off",
+        "SET auto_explain.log_nested_statements = on",
+        "SET auto_explain.log_format = 'json'",
+        "SET auto_explain.log_level = 'notice'",
+        "SET client_min_messages = notice",
+    };
+    for (const QString &s : setup)
+        if (!execOk(conn, s)) return 1;
+    if (generic && !execOk(conn, "SET plan_cache_mode = force_generic_plan")) return 1;
+
+    const QSet<QString> forbiddenDefault = toSet(spec.value("forbid_seq_scan"));
+
+    int failed = 0;
+    const QJsonArray checks = spec.value("checks").toArray();
+    for (const QJsonValue &cv : checks) {
+        const QJsonObject c = cv.toObject();
+        const QString name = c.value("name").toString();
+        const QString sql = substitute(c.value("sql").toString(), vars);
+        const bool parameterized = c.contains("params");
+        QVariantList params;
+        for (const QJsonValue &p : c.value("params").toArray()) params << substitute(p.toString(), vars);
+        const qint64 maxBuffers = c.value("max_buffers").toVariant().toLongLong();
+
+        QSet<QString> forbidden = forbiddenDefault;
+        forbidden.subtract(toSet(c.value("allow_seq_scan")));
+
+        // Первый прогон прогревает кэш и компилирует функцию, меряем второй
+        QString error;
+        for (int pass = 0; pass < 2 && error.isEmpty(); ++pass) {
+            plans.clear();
+            if (!execOk(conn, "BEGIN")) return 1;
+            if (c.value("generic").toBool() && !execOk(conn, "SET LOCAL plan_cache_mode = force_generic_plan"))
+                return 1;
+            PgResult r = parameterized ? conn.exec(sql, params) : conn.exec(sql);
+            if (!r.ok()) error = r.error();
+            if (!execOk(conn, "ROLLBACK")) return 1;
+        }
+
+        QStringList violations;
+        qint64 buffers = 0;
+        if (!error.isEmpty()) {
+            violations << QStringLiteral("ошибка выполнения: %1").arg(error);
+        } else if (plans.isEmpty()) {
+            violations << QStringLiteral("auto_explain не вернул планов");
+        }
+
+        for (const QJsonObject &p : plans) {
+            const QJsonObject root = p.value("Plan").toObject();
+            // Буферы верхнего узла включают вложенные операторы, поэтому берём максимум
+            buffers = std::max(buffers, nodeBuffers(root));
+            findSeqScans(root, forbidden, violations);
+        }
+        if (maxBuffers > 0 && buffers > maxBuffers)
+            violations << QStringLiteral("буферов %1 > порога %2").arg(buffers).arg(maxBuffers);
+
+        const bool ok = violations.isEmpty();
+        if (!ok) ++failed;
+
+        std::cout << (ok ? "OK   " : "FAIL ") << std::left << std::setw(44) << name.toStdString()
+                  << std::right << std::setw(8) << buffers << " / " << maxBuffers << " buffers\n";
+        for (const QString &v : violations) std::cout << "       " << v.toStdString() << "\n";
+    }
+
+    std::cout << "\n" << (checks.size() - failed) << " of " << checks.size() << " checks passed\n";
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,632 @@
+// Генератор синтетических данных для нагрузочного тестирования.
+//
+//   seed_data [--seed 42] [--students 50000] [--teachers 500] [--assignments 5000]
+//             [--submissions 2000000] [--audit 1000000] [--audience 25]
+//             [--restricted-pct 80] [--blob-kb 8] [--no-blobs] [--jobs N]
+//             [--base-date 2026-09-01]
+//
+// Таблицы заполняются через COPY одной транзакцией, зашифрованные файлы отправлений
+// (в формате create_submission) пишутся параллельно в storage.root. Каждое значение —
+// чистая функция (seed, номер строки), поэтому повторный запуск с тем же seed на пустой
+// базе и пустом хранилище даёт те же данные и те же байты файлов.
+//
+// Запускать на пустой базе со схемой 001/002. Пароль всех пользователей — kSeedPassword.
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QByteArray>
+
+#include <sodium.h>
+
+#include "config/ConfigManager.hpp"
+#include "db/PgConnection.hpp"
+#include "crypto/FileCrypto.hpp"
+#include "crypto/KeyProtect.hpp"
+#include "auth/PasswordUtils.hpp"
+
+static const char *kSeedPassword = "Seed_password1";
+static const int kCopyChunk = 1 << 20;
+
+struct Scale {
+    int students = 50000;
+    int teachers = 500;
+    int assignments = 5000;
+    qint64 submissions = 2000000;
+    qint64 audit = 1000000;
+    int audience = 25;
+    int restrictedPct = 80;
+};
+
+struct Options {
+    Scale scale;
+    quint64 seed = 42;
+    int blobKb = 8;
+    bool blobs = true;
+    int jobs = 4;
+    QDateTime base;
+};
+
+// Независимые потоки псевдослучайных чисел для разных полей
+enum Stream : quint64 {
+    StTeacher = 1,
+    StAssignmentDate,
+    StDueDays,
+    StRestricted,
+    StSubAssignment,
+    StSubStudent,
+    StSubUpload,
+    StSubGrade,
+    StSubName,
+    StAuditUser,
+    StAuditAction,
+    StAuditTs,
+    StBlobSize,
+};
+
+static quint64 mix64(quint64 x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+static quint64 rnd(quint64 seed, quint64 stream, quint64 i) {
+    return mix64(seed ^ mix64(stream * 0x9E3779B97F4A7C15ULL + i));
+}
+
+// Байты из randombytes_buf_deterministic с ключом BLAKE2b(seed, purpose, i)
+static void detBytes(unsigned char *out, std::size_t len, quint64 seed, const char *purpose, quint64 i) {
+    unsigned char key[randombytes_SEEDBYTES];
+    crypto_generichash_state st;
+    crypto_generichash_init(&st, nullptr, 0, sizeof(key));
+    crypto_generichash_update(&st, reinterpret_cast<const unsigned char *>(&seed), sizeof(seed));
+    crypto_generichash_update(&st, reinterpret_cast<const unsigned char *>(purpose), std::strlen(purpose));
+    crypto_generichash_update(&st, reinterpret_cast<const unsigned char *>(&i), sizeof(i));
+    crypto_generichash_final(&st, key, sizeof(key));
+    randombytes_buf_deterministic(out, len, key);
+}
+
+static std::vector<unsigned char> detBytes(std::size_t len, quint64 seed, const char *purpose, quint64 i) {
+    std::vector<unsigned char> out(len);
+    detBytes(out.data(), len, seed, purpose, i);
+    return out;
+}
+
+static QString toBase64(const std::vector<unsigned char> &v) {
+    QByteArray ba(reinterpret_cast<const char *>(v.data()), static_cast<int>(v.size()));
+    return QString::fromLatin1(ba.toBase64());
+}
+
+// ---- Модель данных: всё выводится из (seed, номер) ----
+
+class Model {
+public:
+    explicit Model(const Options &o) : m_o(o), m_s(o.scale) {
+        m_audience = std::min(m_s.audience, m_s.students);
+        // Шаг, взаимно простой с числом студентов: первые audience студентов
+        // задания различны, и COPY в assignment_students не нарушит ключ
+        m_stride = 2503 % m_s.students;
+        if (m_stride == 0) m_stride = 1;
+        while (std::gcd(m_stride, m_s.students) != 1) ++m_stride;
+    }
+
+    int adminId() const { return 1; }
+    int teacherId(int n) const { return 2 + n; }
+    int studentId(int n) const { return 2 + m_s.teachers + n; }
+    int userCount() const { return 1 + m_s.teachers + m_s.students; }
+
+    int assignmentTeacher(int a) const {
+        return teacherId(static_cast<int>(rnd(m_o.seed, StTeacher, a) % m_s.teachers));
+    }
+    // Задания создаются равномерно за 300 дней до base
+    qint64 assignmentCreatedSec(int a) const {
+        const qint64 span = 300LL * 86400;
+        return -span + span * (a - 1) / std::max(1, m_s.assignments)
+               + static_cast<qint64>(rnd(m_o.seed, StAssignmentDate, a) % 86400);
+    }
+    qint64 assignmentDueSec(int a) const {
+        return assignmentCreatedSec(a) + (7 + static_cast<qint64>(rnd(m_o.seed, StDueDays, a) % 15)) * 86400;
+    }
+    bool assignmentRestricted(int a) const {
+        return static_cast<int>(rnd(m_o.seed, StRestricted, a) % 100) < m_s.restrictedPct;
+    }
+    int audienceSize() const { return m_audience; }
+    int audienceStudent(int a, int k) const {
+        const qint64 idx = (static_cast<qint64>(a) * 7919 + static_cast<qint64>(k) * m_stride) % m_s.students;
+        return studentId(static_cast<int>(idx));
+    }
+
+    struct Submission {
+        qint64 id;
+        int assignmentId;
+        int studentId;
+        qint64 uploadedSec;
+        int grade;          // 0 — не оценено
+        bool feedback;
+        QString originalName;
+        QString uuid;
+    };
+
+    Submission submission(qint64 i) const {
+        Submission s;
+        s.id = i + 1;
+
+        // 70% — равномерно, 30% — свежие 10% заданий (сдача перед дедлайном)
+        const quint64 ra = rnd(m_o.seed, StSubAssignment, i);
+        const int recent = std::max(1, m_s.assignments / 10);
+        s.assignmentId = (ra % 10) < 7
+            ? 1 + static_cast<int>((ra >> 8) % m_s.assignments)
+            : m_s.assignments - static_cast<int>((ra >> 8) % recent);
+
+        const quint64 rs = rnd(m_o.seed, StSubStudent, i);
+        s.studentId = assignmentRestricted(s.assignmentId)
+            ? audienceStudent(s.assignmentId, static_cast<int>(rs % m_audience))
+            : studentId(static_cast<int>(rs % m_s.students));
+
+        // Неделя до дедлайна плюс сутки после: ~1/8 сдач с опозданием
+        s.uploadedSec = assignmentDueSec(s.assignmentId) - 7 * 86400
+                        + static_cast<qint64>(rnd(m_o.seed, StSubUpload, i) % (8 * 86400));
+
+        const quint64 rg = rnd(m_o.seed, StSubGrade, i);
+        s.grade = (rg % 100) < 60 ? static_cast<int>(2 + (rg >> 8) % 4) : 0;
+        s.feedback = s.grade != 0 && ((rg >> 16) % 3) == 0;
+
+        static const char *ext[] = {"pdf", "docx", "zip", "py", "cpp"};
+        const quint64 rn = rnd(m_o.seed, StSubName, i);
+        s.originalName = QStringLiteral("work_%1.%2").arg(s.id).arg(ext[rn % 5]);
+
+        unsigned char u[16];
+        detBytes(u, sizeof(u), m_o.seed, "uuid", static_cast<quint64>(i));
+        s.uuid = QString::fromLatin1(QByteArray(reinterpret_cast<const char *>(u), 16).toHex());
+        return s;
+    }
+
+    int blobSize(qint64 i) const {
+        // От 1/4 до 7/4 среднего размера
+        const qint64 avg = static_cast<qint64>(m_o.blobKb) * 1024;
+        return static_cast<int>(avg / 4 + rnd(m_o.seed, StBlobSize, i) % (avg * 3 / 2 + 1));
+    }
+
+    QString timestamp(qint64 sec) const {
+        return m_o.base.addSecs(sec).toString(QStringLiteral("yyyy-MM-dd HH:mm:ss"));
+    }
+
+private:
+    const Options &m_o;
+    const Scale &m_s;
+    int m_audience = 0;
+    int m_stride = 1;
+};
+
+// ---- COPY ----
+
+class CopyWriter {
+public:
+    explicit CopyWriter(PgConnection &conn) : m_conn(conn) {}
+
+    bool begin(const QString &sql) {
+        m_buf.clear();
+        m_buf.reserve(kCopyChunk + 4096);
+        m_rows = 0;
+        if (!m_conn.copyInBegin(sql)) {
+            std::cerr << "Ошибка: " << sql.toStdString() << ": " << m_conn.lastError().toStdString() << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    CopyWriter &field(qint64 v) {
+        sep();
+        m_buf += QByteArray::number(v);
+        return *this;
+    }
+    CopyWriter &field(const QString &v) {
+        sep();
+        // Текстовый формат COPY: экранируем \, табуляцию и переводы строк
+        for (const char c : v.toUtf8()) {
+            switch (c) {
+            case '\\': m_buf += "\\\\"; break;
+            case '\t': m_buf += "\\t"; break;
+            case '\n': m_buf += "\\n"; break;
+            case '\r': m_buf += "\\r"; break;
+            default: m_buf += c;
+            }
+        }
+        return *this;
+    }
+    CopyWriter &null() {
+        sep();
+        m_buf += "\\N";
+        return *this;
+    }
+
+    bool endRow() {
+        m_buf += '\n';
+        m_first = true;
+        ++m_rows;
+        if (m_buf.size() < kCopyChunk) return true;
+        const bool ok = m_conn.copyInPut(m_buf);
+        m_buf.clear();
+        return ok;
+    }
+
+    bool finish(const char *table) {
+        QString err;
+        const bool ok = m_conn.copyInPut(m_buf) && m_conn.copyInEnd(&err);
+        m_buf.clear();
+        if (!ok) {
+            std::cerr << "Ошибка COPY " << table << ": " << err.toStdString() << "\n";
+            return false;
+        }
+        std::cout << "  " << table << ": " << m_rows << " rows\n";
+        return true;
+    }
+
+private:
+    void sep() {
+        if (!m_first) m_buf += '\t';
+        m_first = false;
+    }
+
+    PgConnection &m_conn;
+    QByteArray m_buf;
+    bool m_first = true;
+    qint64 m_rows = 0;
+};
+
+static bool copyUsers(CopyWriter &w, const Options &o, const Model &m,
+                      const QString &hashHex, const QString &saltHex) {
+    if (!w.begin("COPY users (id, login, full_name, role, password_hash, salt, created_at, active) FROM STDIN"))
+        return false;
+
+    const QString created = m.timestamp(-400LL * 86400);
+    w.field(m.adminId()).field(QStringLiteral("seed_admin")).field(QStringLiteral("Seed Admin"))
+        .field(QStringLiteral("admin")).field(hashHex).field(saltHex).field(created).field(QStringLiteral("t"));
+    if (!w.endRow()) return false;
+
+    for (int t = 0; t < o.scale.teachers; ++t) {
+        w.field(m.teacherId(t)).field(QStringLiteral("seed_teacher_%1").arg(t + 1))
+            .field(QStringLiteral("Преподаватель %1").arg(t + 1)).field(QStringLiteral("teacher"))
+            .field(hashHex).field(saltHex).field(created).field(QStringLiteral("t"));
+        if (!w.endRow()) return false;
+    }
+    for (int s = 0; s < o.scale.students; ++s) {
+        w.field(m.studentId(s)).field(QStringLiteral("seed_student_%1").arg(s + 1))
+            .field(QStringLiteral("Студент %1").arg(s + 1)).field(QStringLiteral("student"))
+            .field(hashHex).field(saltHex).field(created).field(QStringLiteral("t"));
+        if (!w.endRow()) return false;
+    }
+    return w.finish("users");
+}
+
+static bool copyAssignments(CopyWriter &w, const Options &o, const Model &m) {
+    if (!w.begin("COPY assignments (id, title, description, created_by, created_at, due_date, restricted) FROM STDIN"))
+        return false;
+    for (int a = 1; a <= o.scale.assignments; ++a) {
+        w.field(a).field(QStringLiteral("Задание %1").arg(a))
+            .field(QStringLiteral("Описание задания %1").arg(a))
+            .field(m.assignmentTeacher(a))
+            .field(m.timestamp(m.assignmentCreatedSec(a)))
+            .field(m.timestamp(m.assignmentDueSec(a)))
+            .field(QString::fromLatin1(m.assignmentRestricted(a) ? "t" : "f"));
+        if (!w.endRow()) return false;
+    }
+    return w.finish("assignments");
+}
+
+static bool copyAudience(CopyWriter &w, const Options &o, const Model &m) {
+    if (!w.begin("COPY assignment_students (assignment_id, student_id) FROM STDIN")) return false;
+    for (int a = 1; a <= o.scale.assignments; ++a) {
+        if (!m.assignmentRestricted(a)) continue;
+        for (int k = 0; k < m.audienceSize(); ++k) {
+            w.field(a).field(m.audienceStudent(a, k));
+            if (!w.endRow()) return false;
+        }
+    }
+    return w.finish("assignment_students");
+}
+
+static bool copyAssignmentFiles(CopyWriter &w, const Options &o, const Model &m) {
+    if (!w.begin("COPY assignment_files (id, assignment_id, file_path, original_name, uploaded_at) FROM STDIN"))
+        return false;
+    int id = 0;
+    for (int a = 3; a <= o.scale.assignments; a += 3) {
+        w.field(++id).field(a).field(QStringLiteral("seed_%1_task.txt").arg(a))
+            .field(QStringLiteral("task.txt")).field(m.timestamp(m.assignmentCreatedSec(a)));
+        if (!w.endRow()) return false;
+    }
+    return w.finish("assignment_files");
+}
+
+static bool copySubmissions(CopyWriter &w, const Options &o, const Model &m) {
+    if (!w.begin("COPY submissions (id, assignment_id, student_id, file_path, original_name, uploaded_at, grade, feedback) FROM STDIN"))
+        return false;
+    for (qint64 i = 0; i < o.scale.submissions; ++i) {
+        const Model::Submission s = m.submission(i);
+        w.field(s.id).field(s.assignmentId).field(s.studentId)
+            .field(s.uuid + QStringLiteral(".dat")).field(s.originalName)
+            .field(m.timestamp(s.uploadedSec));
+        if (s.grade) w.field(QString::number(s.grade)); else w.null();
+        if (s.feedback) w.field(QStringLiteral("Комментарий к работе %1").arg(s.id)); else w.null();
+        if (!w.endRow()) return false;
+    }
+    return w.finish("submissions");
+}
+
+static bool copyAudit(CopyWriter &w, const Options &o, const Model &m) {
+    static const char *actions[] = {"login", "upload_submission", "download_submission",
+                                    "grade_submission", "create_assignment"};
+    if (!w.begin("COPY audit_log (id, user_id, action, details, ts) FROM STDIN")) return false;
+    for (qint64 i = 0; i < o.scale.audit; ++i) {
+        const int user = 1 + static_cast<int>(rnd(o.seed, StAuditUser, i) % m.userCount());
+        const char *action = actions[rnd(o.seed, StAuditAction, i) % 5];
+        const qint64 ts = -180LL * 86400 + static_cast<qint64>(rnd(o.seed, StAuditTs, i) % (180ULL * 86400));
+        w.field(i + 1).field(user).field(QString::fromLatin1(action))
+            .field(QStringLiteral("seed %1").arg(i + 1)).field(m.timestamp(ts));
+        if (!w.endRow()) return false;
+    }
+    return w.finish("audit_log");
+}
+
+// ---- Файлы хранилища ----
+
+static bool writeFile(const QString &path, const char *data, qint64 size) {
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    return f.write(data, size) == size;
+}
+
+// Файл отправления и его метаданные в формате create_submission
+static bool writeSubmissionBlob(const Options &o, const Model &m, const std::vector<unsigned char> &master,
+                                qint64 i, std::vector<unsigned char> &plain, std::string &err) {
+    const Model::Submission s = m.submission(i);
+
+    plain.resize(static_cast<std::size_t>(m.blobSize(i)));
+    detBytes(plain.data(), plain.size(), o.seed, "plain", static_cast<quint64>(i));
+
+    const auto fileKey = detBytes(32, o.seed, "file_key", static_cast<quint64>(i));
+    const auto nonce = detBytes(crypto_secretbox_NONCEBYTES, o.seed, "file_nonce", static_cast<quint64>(i));
+    const auto fileIv = detBytes(16, o.seed, "file_iv", static_cast<quint64>(i));
+    const auto keyIv = detBytes(crypto_secretbox_NONCEBYTES, o.seed, "key_iv", static_cast<quint64>(i));
+
+    std::vector<unsigned char> cipher;
+    if (!crypto::encryptBuffer(fileKey, nonce, plain.data(), plain.size(), cipher, err)) return false;
+
+    std::vector<unsigned char> encKey;
+    if (!keyprotect::encryptWithNonce(master, fileKey, keyIv, encKey, err)) return false;
+
+    const auto &cfg = ConfigManager::instance();
+    const QString outPath = QString::fromStdString(cfg.storagePath("files/" + s.uuid.toStdString() + ".dat"));
+    const QString metaPath = QString::fromStdString(cfg.storagePath("metadata/" + s.uuid.toStdString() + ".json"));
+
+    if (!writeFile(outPath, reinterpret_cast<const char *>(cipher.data()), static_cast<qint64>(cipher.size()))) {
+        err = "cannot write " + outPath.toStdString();
+        return false;
+    }
+
+    QJsonObject meta;
+    meta["owner_id"]      = s.studentId;
+    meta["original_name"] = s.originalName;
+    meta["iv"]            = toBase64(fileIv);
+    meta["key_encrypted"] = toBase64(encKey);
+    meta["key_iv"]        = toBase64(keyIv);
+    meta["key_tag"]       = QString();
+
+    const QByteArray json = QJsonDocument(meta).toJson(QJsonDocument::Indented);
+    if (!writeFile(metaPath, json.constData(), json.size())) {
+        err = "cannot write " + metaPath.toStdString();
+        return false;
+    }
+    return true;
+}
+
+// Пишет файлы отправлений в jobs потоков, пока основной поток грузит таблицы
+class BlobWriter {
+public:
+    BlobWriter(const Options &o, const Model &m) : m_o(o), m_m(m) {}
+
+    void start() {
+        m_master = ConfigManager::instance().masterKey();
+        for (int t = 0; t < m_o.jobs; ++t) m_threads.emplace_back([this]() { run(); });
+    }
+
+    bool join() {
+        for (auto &t : m_threads) t.join();
+        m_threads.clear();
+        return !m_failed.load();
+    }
+
+    qint64 done() const { return m_done.load(); }
+
+private:
+    void run() {
+        std::vector<unsigned char> plain;
+        std::string err;
+        for (;;) {
+            const qint64 i = m_next.fetch_add(1);
+            if (i >= m_o.scale.submissions || m_failed.load()) return;
+            if (!writeSubmissionBlob(m_o, m_m, m_master, i, plain, err)) {
+                std::cerr << "Ошибка: файл отправления " << (i + 1) << ": " << err << "\n";
+                m_failed.store(true);
+                return;
+            }
+            m_done.fetch_add(1);
+        }
+    }
+
+    const Options &m_o;
+    const Model &m_m;
+    std::vector<unsigned char> m_master;
+    std::vector<std::thread> m_threads;
+    std::atomic<qint64> m_next{0};
+    std::atomic<qint64> m_done{0};
+    std::atomic<bool> m_failed{false};
+};
+
+static bool writeAssignmentFiles(const Options &o) {
+    const QString dir = QString::fromStdString(ConfigManager::instance().storagePath("assignments"));
+    for (int a = 3; a <= o.scale.assignments; a += 3) {
+        const QByteArray text = QStringLiteral("Условие задания %1\n").arg(a).toUtf8();
+        if (!writeFile(QDir(dir).filePath(QStringLiteral("seed_%1_task.txt").arg(a)), text.constData(), text.size()))
+            return false;
+    }
+    return true;
+}
+
+// ---- main ----
+
+static bool execOk(PgConnection &conn, const QString &sql) {
+    PgResult r = conn.exec(sql);
+    if (!r.ok()) {
+        std::cerr << "Ошибка: " << sql.toStdString() << ": " << r.error().toStdString() << "\n";
+        return false;
+    }
+    return true;
+}
+
+static bool parseOptions(const QCoreApplication &app, Options &o) {
+    QCommandLineParser p;
+    p.setApplicationDescription("Synthetic EduDesk data generator");
+    p.addHelpOption();
+
+    const QCommandLineOption seed("seed", "PRNG seed.", "n", "42");
+    const QCommandLineOption students("students", "Students.", "n", "50000");
+    const QCommandLineOption teachers("teachers", "Teachers.", "n", "500");
+    const QCommandLineOption assignments("assignments", "Assignments.", "n", "5000");
+    const QCommandLineOption submissions("submissions", "Submissions.", "n", "2000000");
+    const QCommandLineOption audit("audit", "audit_log rows.", "n", "1000000");
+    const QCommandLineOption audience("audience", "Students per restricted assignment.", "n", "25");
+    const QCommandLineOption restricted("restricted-pct", "Share of restricted assignments, %.", "n", "80");
+    const QCommandLineOption blobKb("blob-kb", "Average submission size, KiB.", "n", "8");
+    const QCommandLineOption noBlobs("no-blobs", "Do not write submission files.");
+    const QCommandLineOption jobs("jobs", "File writer threads.", "n",
+                                  QString::number(std::max(1u, std::thread::hardware_concurrency())));
+    const QCommandLineOption baseDate("base-date", "Reference date for timestamps (ISO).", "date", "2026-09-01");
+    p.addOptions({seed, students, teachers, assignments, submissions, audit, audience,
+                  restricted, blobKb, noBlobs, jobs, baseDate});
+    p.process(app);
+
+    o.seed = p.value(seed).toULongLong();
+    o.scale.students = std::max(1, p.value(students).toInt());
+    o.scale.teachers = std::max(1, p.value(teachers).toInt());
+    o.scale.assignments = std::max(1, p.value(assignments).toInt());
+    o.scale.submissions = std::max<qint64>(0, p.value(submissions).toLongLong());
+    o.scale.audit = std::max<qint64>(0, p.value(audit).toLongLong());
+    o.scale.audience = std::max(1, p.value(audience).toInt());
+    o.scale.restrictedPct = std::clamp(p.value(restricted).toInt(), 0, 100);
+    o.blobKb = std::max(1, p.value(blobKb).toInt());
+    o.blobs = !p.isSet(noBlobs);
+    o.jobs = std::max(1, p.value(jobs).toInt());
+
+    const QDate d = QDate::fromString(p.value(baseDate), Qt::ISODate);
+    if (!d.isValid()) {
+        std::cerr << "Ошибка: неверная --base-date\n";
+        return false;
+    }
+    o.base = QDateTime(d, QTime(0, 0), Qt::UTC);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    QCoreApplication app(argc, argv);
+
+    if (sodium_init() == -1) {
+        std::cerr << "Ошибка: sodium_init() failed\n";
+        return 1;
+    }
+
+    Options o;
+    if (!parseOptions(app, o)) return 1;
+
+    const std::string cfg = ConfigManager::findConfigPath();
+    if (cfg.empty() || !ConfigManager::instance().load(cfg)) {
+        std::cerr << "Ошибка: не удалось загрузить config.json\n";
+        return 1;
+    }
+
+    PgConnection conn;
+    if (!conn.open()) {
+        std::cerr << "Ошибка: не удалось подключиться к PostgreSQL\n";
+        return 1;
+    }
+
+    PgResult existing = conn.exec("SELECT EXISTS (SELECT 1 FROM users)");
+    if (!existing.ok() || existing.value(0, 0) != QLatin1String("f")) {
+        std::cerr << "Ошибка: таблица users не пуста, seed_data запускается только на пустой базе\n";
+        return 1;
+    }
+
+    const Model model(o);
+
+    // Одинаковый пароль у всех пользователей, соль из seed
+    const auto salt = detBytes(16, o.seed, "password_salt", 0);
+    const auto pw = auth::createPasswordHash(kSeedPassword, ConfigManager::instance().pbkdf2Iterations(), salt);
+    if (pw.hash.empty()) {
+        std::cerr << "Ошибка: не удалось вычислить хэш пароля\n";
+        return 1;
+    }
+    const QString hashHex = QString::fromStdString(auth::toHex(pw.hash));
+    const QString saltHex = QString::fromStdString(auth::toHex(pw.salt));
+
+    BlobWriter blobs(o, model);
+    if (o.blobs) {
+        if (!ConfigManager::instance().ensureStorageLayout() || !writeAssignmentFiles(o)) {
+            std::cerr << "Ошибка: не удалось подготовить хранилище\n";
+            return 1;
+        }
+        blobs.start();
+    }
+
+    // Без триггеров (NOTIFY и счётчики на каждую строку) и проверок FK: данные
+    // согласованы по построению, restricted и assignment_stats заполняются явно
+    if (!conn.exec("SET session_replication_role = replica").ok())
+        std::cerr << "Предупреждение: нет прав отключить триггеры, загрузка будет медленнее\n";
+
+    std::cout << "Загрузка таблиц (seed " << o.seed << ")\n";
+    CopyWriter w(conn);
+    bool ok = execOk(conn, "BEGIN")
+        && copyUsers(w, o, model, hashHex, saltHex)
+        && copyAssignments(w, o, model)
+        && copyAudience(w, o, model)
+        && copyAssignmentFiles(w, o, model)
+        && copySubmissions(w, o, model)
+        && copyAudit(w, o, model);
+
+    // Явные id: сдвигаем identity-последовательности за максимум
+    const char *tables[] = {"users", "assignments", "assignment_files", "submissions", "audit_log"};
+    for (const char *t : tables) {
+        if (!ok) break;
+        ok = execOk(conn, QStringLiteral("SELECT setval(pg_get_serial_sequence('public.%1', 'id'), "
+                                         "GREATEST((SELECT max(id) FROM %1), 1))").arg(t));
+    }
+    ok = ok && execOk(conn, "SELECT sp_assignment_stats_rebuild()") && execOk(conn, "COMMIT");
+    if (!ok) conn.exec("ROLLBACK");
+
+    conn.exec("RESET session_replication_role");
+
+    if (o.blobs) {
+        std::cout << "Ожидание записи файлов (" << blobs.done() << " / " << o.scale.submissions << ")\n";
+        if (!blobs.join()) ok = false;
+    }
+    if (!ok) return 1;
+
+    execOk(conn, "VACUUM ANALYZE");
+
+    std::cout << "Готово. Пароль пользователей seed_*: " << kSeedPassword << "\n";
+    return 0;
+}
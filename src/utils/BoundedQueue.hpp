@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+/// Ограниченная lock-free очередь MPMC (схема Вьюкова: номер последовательности в каждой ячейке).
+/// Ёмкость округляется вверх до степени двойки.
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(std::size_t capacity) {
+        std::size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        m_mask = cap - 1;
+        m_cells.reset(new Cell[cap]);
+        for (std::size_t i = 0; i < cap; ++i) {
+            m_cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue &) = delete;
+    BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+    /// Перемещает value в очередь. При переполнении возвращает false и не трогает value.
+    bool tryPush(T &value) {
+        std::size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell &cell = m_cells[pos & m_mask];
+            const std::size_t seq = cell.seq.load(std::memory_order_acquire);
+            const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool tryPop(T &out) {
+        std::size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell &cell = m_cells[pos & m_mask];
+            const std::size_t seq = cell.seq.load(std::memory_order_acquire);
+            const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    out = std::move(cell.value);
+                    cell.seq.store(pos + m_mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Приблизительный размер (точен, только когда нет конкурентных операций).
+    std::size_t sizeApprox() const {
+        const std::size_t enq = m_enqueuePos.load(std::memory_order_relaxed);
+        const std::size_t deq = m_dequeuePos.load(std::memory_order_relaxed);
+        return enq > deq ? enq - deq : 0;
+    }
+
+    std::size_t capacity() const { return m_mask + 1; }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> seq;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> m_cells;
+    std::size_t m_mask = 0;
+    alignas(64) std::atomic<std::size_t> m_enqueuePos{0};
+    alignas(64) std::atomic<std::size_t> m_dequeuePos{0};
+};
@@ -1,28 +1,211 @@
 #include "Logger.hpp"
+#include "BoundedQueue.hpp"
 #include <QFile>
 #include <QTextStream>
 #include <QDateTime>
+#include <QStringList>
 #include "db/Database.hpp"
+#include "db/StatementCache.hpp"
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QDebug>
 
-void Logger::log(int userId, const QString &action, const QString &details) {
-    QFile f("logs/actions.log");
-    if (f.open(QIODevice::Append | QIODevice::Text)) {
-        QTextStream out(&f);
-        out << QDateTime::currentDateTime().toString(Qt::ISODate) << " | user:" << userId << " | " << action << " | " << details << "\n";
-        f.close();
-    }
-    QSqlDatabase db = Database::instance().get();
-    QSqlQuery q(db);
-    q.prepare("SELECT sp_log_action(?, ?, ?)");
-    q.addBindValue(userId);
-    q.addBindValue(action);
-    q.addBindValue(details);
-    if (!q.exec()) {
-        qWarning() << "sp_log_action failed:" << q.lastError().text();
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct AuditEvent {
+    int userId = 0;
+    QString action;
+    QString details;
+    QDateTime ts;
+    bool persist = true;
+};
+
+const std::size_t kQueueCapacity = 4096;
+const std::size_t kBatchSize = 256;
+const std::chrono::milliseconds kFlushInterval(200);
+const char *kAuditConnection = "EduDeskAudit";
+
+// Фоновый писатель: копит события и сбрасывает их пакетом —
+// одна запись в файл и один вызов sp_log_actions на пакет.
+class AuditWriter {
+public:
+    AuditWriter() : m_queue(kQueueCapacity) {
+        m_thread = std::thread([this]() { run(); });
+    }
+
+    ~AuditWriter() { stop(); }
+
+    void push(AuditEvent &ev) {
+        while (!m_stopping.load(std::memory_order_acquire)) {
+            if (m_queue.tryPush(ev)) {
+                if (m_queue.sizeApprox() >= kBatchSize) m_wake.notify_one();
+                return;
+            }
+
+            // Очередь заполнена: будим писателя и ждём, пока он её разгрузит.
+            // wait_for — на случай уведомления, пришедшего до начала ожидания
+            m_wake.notify_one();
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_drained.wait_for(lock, kFlushInterval, [this]() {
+                return m_stopping.load(std::memory_order_acquire) || m_queue.sizeApprox() < m_queue.capacity();
+            });
+        }
+        // Остановленный писатель очередь уже не разберёт
+        qWarning() << "Audit writer is stopped, event dropped:" << ev.action;
+    }
+
+    void stop() {
+        if (m_stopping.exchange(true)) return;
+        m_wake.notify_one();
+        m_drained.notify_all();
+        if (m_thread.joinable()) m_thread.join();
+    }
+
+private:
+    void run() {
+        std::vector<AuditEvent> batch;
+        batch.reserve(kBatchSize);
+
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(m_wakeMutex);
+                m_wake.wait_for(lock, kFlushInterval, [this]() {
+                    return m_stopping.load(std::memory_order_acquire) || m_queue.sizeApprox() >= kBatchSize;
+                });
+            }
+
+            AuditEvent ev;
+            while (m_queue.tryPop(ev)) {
+                batch.push_back(std::move(ev));
+                if (batch.size() >= kBatchSize) {
+                    m_drained.notify_all();
+                    flush(batch);
+                }
+            }
+            m_drained.notify_all();
+            if (!batch.empty()) flush(batch);
+
+            if (m_stopping.load(std::memory_order_acquire) && m_queue.sizeApprox() == 0) break;
+        }
+
+        m_statements.clear();
+        if (m_db.isValid()) {
+            m_db.close();
+            m_db = QSqlDatabase();
+            QSqlDatabase::removeDatabase(kAuditConnection);
+        }
+        if (m_file.isOpen()) m_file.close();
+    }
+
+    void flush(std::vector<AuditEvent> &batch) {
+        if (!m_file.isOpen()) {
+            m_file.setFileName("logs/actions.log");
+            m_file.open(QIODevice::Append | QIODevice::Text);
+        }
+        if (m_file.isOpen()) {
+            QTextStream out(&m_file);
+            for (const AuditEvent &ev : batch) {
+                out << ev.ts.toString(Qt::ISODate) << " | user:" << ev.userId << " | " << ev.action << " | " << ev.details << "\n";
+            }
+            out.flush();
+            m_file.flush();
+        }
+
+        QList<int> userIds;
+        QStringList actions;
+        QStringList details;
+        QStringList stamps;
+        for (const AuditEvent &ev : batch) {
+            if (!ev.persist) continue;
+            userIds.append(ev.userId);
+            actions.append(ev.action);
+            details.append(ev.details);
+            stamps.append(ev.ts.toString(QStringLiteral("yyyy-MM-dd HH:mm:ss.zzz")));
+        }
+        batch.clear();
+
+        if (userIds.isEmpty()) return;
+
+        if (!m_db.isValid() || !m_db.isOpen()) {
+            m_db = Database::openConnection(kAuditConnection);
+            m_statements.setDatabase(m_db);
+        }
+
+        QSqlQuery q = m_statements.prepare("SELECT sp_log_actions(?::integer[], ?::text[], ?::text[], ?::timestamp[])");
+        q.addBindValue(Database::intArrayLiteral(userIds));
+        q.addBindValue(Database::textArrayLiteral(actions));
+        q.addBindValue(Database::textArrayLiteral(details));
+        q.addBindValue(Database::textArrayLiteral(stamps));
+        if (!Database::exec(q)) {
+            qWarning() << "sp_log_actions failed:" << q.lastError().text();
+            return;
+        }
+        q.next();
+    }
+
+    BoundedQueue<AuditEvent> m_queue;
+    std::thread m_thread;
+    std::atomic<bool> m_stopping{false};
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    // Место в очереди освободилось (или писатель остановлен)
+    std::condition_variable m_drained;
+
+    // Используются только из потока писателя
+    QFile m_file;
+    QSqlDatabase m_db;
+    StatementCache m_statements;
+};
+
+std::mutex g_writerMutex;
+std::atomic<AuditWriter *> g_writer{nullptr};
+bool g_shutdown = false;
+
+// nullptr после Logger::shutdown(): новый поток писателя уже не создаётся
+AuditWriter *writer() {
+    AuditWriter *w = g_writer.load(std::memory_order_acquire);
+    if (w) return w;
+
+    std::lock_guard<std::mutex> lock(g_writerMutex);
+    w = g_writer.load(std::memory_order_relaxed);
+    if (!w && !g_shutdown) {
+        w = new AuditWriter();
+        g_writer.store(w, std::memory_order_release);
+    }
+    return w;
+}
+
+} // namespace
+
+void Logger::log(int userId, const QString &action, const QString &details, Mode mode) {
+    AuditEvent ev;
+    ev.userId = userId;
+    ev.action = action;
+    ev.details = details;
+    ev.ts = QDateTime::currentDateTime();
+    ev.persist = (mode == Full);
+
+    AuditWriter *w = writer();
+    if (!w) {
+        qWarning() << "Audit writer is stopped, event dropped:" << action;
         return;
     }
-    q.next();
+    w->push(ev);
+}
+
+void Logger::shutdown() {
+    AuditWriter *w;
+    {
+        std::lock_guard<std::mutex> lock(g_writerMutex);
+        g_shutdown = true;
+        w = g_writer.load(std::memory_order_relaxed);
+    }
+    if (w) w->stop();
 }
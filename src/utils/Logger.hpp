@@ -3,5 +3,15 @@
 
 class Logger {
 public:
-    static void log(int userId, const QString &action, const QString &details);
+    enum Mode {
+        Full,       // файл logs/actions.log + строка в audit_log
+        FileOnly    // только файл: процедура уже записала свою строку в audit_log
+    };
+
+    /// Ставит событие в очередь фонового писателя; запись идёт пакетами.
+    /// При заполненной очереди вызывающий ждёт, пока писатель её разгрузит.
+    static void log(int userId, const QString &action, const QString &details, Mode mode = Full);
+
+    /// Дописывает оставшиеся события и останавливает фоновый поток.
+    static void shutdown();
 };